@@ -98,6 +98,16 @@ void GameTimer::Stop()
 	}
 }
 
+// Moves the clock forward by exactly the given amount instead of reading the
+// performance counter, so simulation steps see a constant DeltaTime.
+void GameTimer::Advance(double seconds)
+{
+	mCurrTime = mPrevTime + (__int64)(seconds / mSecondsPerCount);
+	mDeltaTime = seconds;
+
+	mPrevTime = mCurrTime;
+}
+
 void GameTimer::Tick()
 {
 	if( mStopped )
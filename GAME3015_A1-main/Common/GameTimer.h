@@ -17,6 +17,7 @@ public:
 	void Start(); // Call when unpaused.
 	void Stop();  // Call when paused.
 	void Tick();  // Call every frame.
+	void Advance(double seconds); // Call every simulation step of a fixed-step timer.
 
 private:
 	double mSecondsPerCount;
@@ -6,9 +6,19 @@
 
 #pragma once
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <cstdlib>
+
+// The Win32 integer types the render and simulation code uses, for builds without Windows.h
+typedef unsigned char UINT8;
+typedef unsigned int UINT;
+typedef unsigned long long UINT64;
+#endif
 #include <DirectXMath.h>
 #include <cstdint>
+#include <cmath>
 
 class MathHelper
 {
@@ -50,11 +50,30 @@ public:
         return mUploadBuffer.Get();
     }
 
+    BYTE* MappedData()const
+    {
+        return mMappedData;
+    }
+
     void CopyData(int elementIndex, const T& data)
     {
         memcpy(&mMappedData[elementIndex*mElementByteSize], &data, sizeof(T));
     }
 
+    // Copies count consecutive elements, with a single memcpy when T already
+    // has the element stride.
+    void CopyData(int firstIndex, const T* data, int count)
+    {
+        if(mElementByteSize == sizeof(T))
+        {
+            memcpy(&mMappedData[firstIndex*mElementByteSize], data, sizeof(T)*count);
+            return;
+        }
+
+        for(int i = 0; i < count; ++i)
+            memcpy(&mMappedData[(firstIndex + i)*mElementByteSize], &data[i], sizeof(T));
+    }
+
 private:
     Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
     BYTE* mMappedData = nullptr;
@@ -4,6 +4,7 @@
 
 #include "d3dApp.h"
 #include <WindowsX.h>
+#include <cmath>
 
 using Microsoft::WRL::ComPtr;
 using namespace std;
@@ -74,6 +75,10 @@ int D3DApp::Run()
 	MSG msg = {0};
  
 	mTimer.Reset();
+	mSimulationTimer.Reset();
+
+	// Start with one step due, so the first frame draws a simulated state
+	mAccumulatedTime = mFixedTimeStep;
 
 	while(msg.message != WM_QUIT)
 	{
@@ -91,6 +96,22 @@ int D3DApp::Run()
 			if( !mAppPaused )
 			{
 				CalculateFrameStats();
+
+				// Run as many fixed steps as the elapsed time covers, up to the catch-up limit
+				mAccumulatedTime += mTimer.DeltaTime();
+				int steps = 0;
+				while (mAccumulatedTime >= mFixedTimeStep && steps < mMaxSimulationSteps)
+				{
+					mSimulationTimer.Advance(mFixedTimeStep);
+					FixedUpdate(mSimulationTimer);
+					mAccumulatedTime -= mFixedTimeStep;
+					++steps;
+				}
+
+				// Drop the time we could not catch up with instead of falling further behind
+				if (mAccumulatedTime >= mFixedTimeStep)
+					mAccumulatedTime = fmod(mAccumulatedTime, mFixedTimeStep);
+
 				Update(mTimer);	
                 Draw(mTimer);
 			}
@@ -104,6 +125,24 @@ int D3DApp::Run()
 	return (int)msg.wParam;
 }
 
+void D3DApp::SetTickRate(float ticksPerSecond)
+{
+	assert(ticksPerSecond > 0.0f);
+	mFixedTimeStep = 1.0 / ticksPerSecond;
+}
+
+void D3DApp::SetMaxSimulationSteps(int steps)
+{
+	assert(steps > 0);
+	mMaxSimulationSteps = steps;
+}
+
+// Fraction of a simulation step the real time is ahead of the last FixedUpdate.
+float D3DApp::InterpolationAlpha()const
+{
+	return (float)(mAccumulatedTime / mFixedTimeStep);
+}
+
 bool D3DApp::Initialize()
 {
 	if(!InitMainWindow())
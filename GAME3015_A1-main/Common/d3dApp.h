@@ -34,6 +34,10 @@ public:
     void Set4xMsaaState(bool value);
 
 	int Run();
+
+    // Simulation steps per second and the most steps run to catch up in one frame.
+    void SetTickRate(float ticksPerSecond);
+    void SetMaxSimulationSteps(int steps);
  
     virtual bool Initialize();
     virtual LRESULT MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -41,6 +45,7 @@ public:
 protected:
     virtual void CreateRtvAndDsvDescriptorHeaps();
 	virtual void OnResize(); 
+	virtual void FixedUpdate(const GameTimer& gt) { }
 	virtual void Update(const GameTimer& gt)=0;
     virtual void Draw(const GameTimer& gt)=0;
 
@@ -65,6 +70,7 @@ protected:
 	D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView()const;
 
 	void CalculateFrameStats();
+	float InterpolationAlpha()const;
 
     void LogAdapters();
     void LogAdapterOutputs(IDXGIAdapter* adapter);
@@ -88,6 +94,14 @@ protected:
 
 	// Used to keep track of the delta-time and game time (4.4).
 	GameTimer mTimer;
+
+	// FixedUpdate runs at a constant rate on mSimulationTimer; the real frame time
+	// is accumulated and consumed in whole steps. The remainder, as a fraction of
+	// a step, is how far rendering is between the last two simulated states.
+	GameTimer mSimulationTimer;
+	double    mFixedTimeStep = 1.0 / 60.0;
+	int       mMaxSimulationSteps = 5;
+	double    mAccumulatedTime = 0.0;
 	
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain> mSwapChain;
@@ -0,0 +1,57 @@
+//***************************************************************************************
+// AircraftKernelBenchmark.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Benchmark.hpp"
+#include "../Project1/AircraftKernel.hpp"
+
+#include <random>
+#include <string>
+
+using namespace DirectX;
+
+// The fixed simulation tick
+static const float StepTime = 1.0f / 60.0f;
+
+// Fills a kernel with aircraft of both responses at random positions and velocities, a third of
+// them outside the bounds; the same aircraft every run
+static void fill(AircraftKernel& kernel, std::size_t count)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> velocity(-50.0f, 50.0f);
+
+	kernel.clear();
+	kernel.setBounds(-15.0f, 15.0f, 5.0f, 15.0f);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const std::size_t lane = kernel.add(i % 2 == 0 ? AircraftKernel::Response::Clamp : AircraftKernel::Response::Reflect);
+		kernel.setState(lane, XMFLOAT3(position(random), position(random), position(random)),
+			XMFLOAT3(velocity(random), velocity(random), velocity(random)));
+	}
+}
+
+// The four-lane step the world runs against the one-lane reference, sixty ticks at a time
+BENCHMARK(AircraftKernelStep)
+{
+	for (std::size_t count : { 1000, 10000, 100000 })
+	{
+		AircraftKernel kernel;
+		const std::string size = std::to_string(count / 1000) + "k";
+
+		fill(kernel, count);
+		report("scalar, " + size, measure([&]()
+		{
+			for (int tick = 0; tick < 60; ++tick)
+				kernel.stepScalar(StepTime);
+		}), count * 60);
+
+		fill(kernel, count);
+		report("vector, " + size, measure([&]()
+		{
+			for (int tick = 0; tick < 60; ++tick)
+				kernel.step(StepTime);
+		}), count * 60);
+		keep(kernel.size());
+	}
+}
@@ -0,0 +1,76 @@
+//***************************************************************************************
+// Benchmark.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Registered benchmarks; a function so it is constructed before the first registration uses it
+static std::vector<std::pair<std::string, BenchmarkFunction>>& getBenchmarks()
+{
+	static std::vector<std::pair<std::string, BenchmarkFunction>> benchmarks;
+	return benchmarks;
+}
+
+// Sink for keep(); volatile so the stores are not removed
+static volatile std::size_t gKept = 0;
+
+// Registers a benchmark
+BenchmarkRegistration::BenchmarkRegistration(const char* name, BenchmarkFunction function)
+{
+	getBenchmarks().push_back(std::make_pair(std::string(name), function));
+}
+
+// Runs work the given number of times and returns the fastest run in milliseconds
+double measure(const std::function<void()>& work, int repetitions)
+{
+	double best = 0.0;
+	for (int i = 0; i < repetitions; ++i)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		work();
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (i == 0 || ms < best)
+			best = ms;
+	}
+	return best;
+}
+
+// Prints one result: what was measured, the time it took and the rate over count items
+void report(const std::string& label, double milliseconds, std::size_t count)
+{
+	const double perSecond = milliseconds > 0.0 ? count / (milliseconds / 1000.0) : 0.0;
+	std::printf("  %-52s %10.3f ms %12.2f M/s\n", label.c_str(), milliseconds, perSecond / 1.0e6);
+}
+
+// Runs every registered benchmark whose name contains filter, in name order; returns how many ran
+int runBenchmarks(const char* filter)
+{
+	std::vector<std::pair<std::string, BenchmarkFunction>> benchmarks = getBenchmarks();
+	std::sort(benchmarks.begin(), benchmarks.end());
+
+	int run = 0;
+	for (const auto& benchmark : benchmarks)
+	{
+		if (filter != nullptr && std::strstr(benchmark.first.c_str(), filter) == nullptr)
+			continue;
+
+		std::printf("%s\n", benchmark.first.c_str());
+		benchmark.second();
+		run++;
+	}
+	return run;
+}
+
+// Keeps a value the compiler would otherwise prove unused
+void keep(std::size_t value)
+{
+	gKept = gKept + value;
+}
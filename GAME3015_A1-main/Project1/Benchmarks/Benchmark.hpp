@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+
+typedef void(*BenchmarkFunction)();
+
+// Adds a benchmark to the list runBenchmarks() goes through; used by BENCHMARK
+struct BenchmarkRegistration
+{
+	BenchmarkRegistration(const char* name, BenchmarkFunction function);
+};
+
+// Runs work the given number of times and returns the fastest run in milliseconds
+double measure(const std::function<void()>& work, int repetitions = 5);
+
+// Prints one result: what was measured, the time it took and the rate over count items
+void report(const std::string& label, double milliseconds, std::size_t count);
+
+// Runs every registered benchmark whose name contains filter, in name order; returns how many ran
+int runBenchmarks(const char* filter);
+
+// Keeps a value the compiler would otherwise prove unused
+void keep(std::size_t value);
+
+// Defines a benchmark function and registers it under its name
+#define BENCHMARK(name) \
+	static void name(); \
+	static BenchmarkRegistration name##Registration(#name, &name); \
+	static void name()
@@ -0,0 +1,107 @@
+//***************************************************************************************
+// CollisionGridBenchmark.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Benchmark.hpp"
+#include "../Project1/CollisionGrid.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+// Grid cell size the benchmarks use, the default one
+static const float CellSize = 4.0f;
+
+// Returns count unit-sized boxes with random yaw scattered over a square of the playfield plane,
+// sized so that on average density boxes share a grid cell; the same boxes every run
+static std::vector<BoundingOrientedBox> makeBoxes(std::size_t count, float density, unsigned int seed)
+{
+	const float side = CellSize * std::sqrt((float)count / density);
+
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(0.0f, side);
+	std::uniform_real_distribution<float> yaw(0.0f, XM_2PI);
+
+	std::vector<BoundingOrientedBox> boxes(count);
+	for (BoundingOrientedBox& box : boxes)
+	{
+		box.Center = XMFLOAT3(position(random), 0.0f, position(random));
+		box.Extents = XMFLOAT3(0.5f, 0.5f, 0.5f);
+		XMStoreFloat4(&box.Orientation, XMQuaternionRotationRollPitchYaw(0.0f, yaw(random), 0.0f));
+	}
+	return boxes;
+}
+
+// Fills the grid and finds the contacts of one step; every sweptEvery'th collider moved 8 units along z
+static void runStep(CollisionGrid& grid, const std::vector<BoundingOrientedBox>& boxes, std::size_t sweptEvery,
+	std::vector<CollisionContact>& contacts)
+{
+	grid.clear();
+	for (std::size_t i = 0; i < boxes.size(); ++i)
+	{
+		Collidable* collidable = reinterpret_cast<Collidable*>(i + 1);
+		if (sweptEvery != 0 && i % sweptEvery == 0)
+			grid.add(collidable, boxes[i], XMFLOAT3(0.0f, 0.0f, 8.0f));
+		else
+			grid.add(collidable, boxes[i]);
+	}
+	grid.findContacts(contacts);
+}
+
+// One collision step over count colliders at a density, without and with a tenth of them swept
+static void runDensity(std::size_t count, float density)
+{
+	const std::vector<BoundingOrientedBox> boxes = makeBoxes(count, density, 1);
+	char label[64];
+	std::snprintf(label, sizeof(label), "%uk, %.1f per cell", (unsigned int)(count / 1000), density);
+
+	CollisionGrid grid(CellSize);
+	std::vector<CollisionContact> contacts;
+
+	report(std::string("discrete, ") + label, measure([&]() { runStep(grid, boxes, 0, contacts); }), count);
+	const CollisionGrid::Stats discrete = grid.getStats();
+
+	report(std::string("10% swept, ") + label, measure([&]() { runStep(grid, boxes, 10, contacts); }), count);
+	const CollisionGrid::Stats swept = grid.getStats();
+
+	std::printf("    candidates %u, contacts %u; swept: candidates %u, swept pairs %u, contacts %u\n",
+		discrete.CandidatePairs, discrete.Contacts, swept.CandidatePairs, swept.SweptPairs, swept.Contacts);
+}
+
+// A full collision step at tens of thousands of colliders, from a sparse field to a crowd
+BENCHMARK(CollisionGridDensity)
+{
+	const std::size_t counts[] = { 20000, 50000, 100000 };
+	const float densities[] = { 0.1f, 0.5f, 2.0f };
+	for (std::size_t count : counts)
+	{
+		for (float density : densities)
+			runDensity(count, density);
+	}
+}
+
+// The all-pairs test the grid replaces, at a size it can still finish
+BENCHMARK(CollisionGridAllPairsReference)
+{
+	const std::size_t count = 5000;
+	const std::vector<BoundingOrientedBox> boxes = makeBoxes(count, 0.5f, 1);
+
+	report("all pairs, 5k, 0.5 per cell", measure([&]()
+	{
+		std::size_t contacts = 0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			for (std::size_t j = i + 1; j < count; ++j)
+				contacts += boxes[i].Intersects(boxes[j]) ? 1 : 0;
+		}
+		keep(contacts);
+	}, 1), count);
+
+	CollisionGrid grid(CellSize);
+	std::vector<CollisionContact> contacts;
+	report("grid, 5k, 0.5 per cell", measure([&]() { runStep(grid, boxes, 0, contacts); }), count);
+}
@@ -0,0 +1,95 @@
+//***************************************************************************************
+// CommandQueueBenchmark.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Benchmark.hpp"
+#include "../Project1/CommandQueue.hpp"
+
+#include <queue>
+
+// Commands pushed in one frame before they are all popped, and frames per run
+static const std::size_t CommandsPerFrame = 256;
+static const std::size_t FrameCount = 400;
+static const std::size_t CommandCount = CommandsPerFrame * FrameCount;
+
+// The command representation CommandQueue replaced, kept here as the reference
+struct FunctionCommand
+{
+	std::function<void(SceneNode&, const GameTimer&)>	action;
+	unsigned int										category;
+};
+
+// State captured by a command; 16 bytes is a mover's velocity, 48 fills CommandAction
+template <std::size_t Size>
+struct Capture
+{
+	unsigned char bytes[Size];
+};
+
+// Pushes and pops CommandCount commands through a CommandQueue, a frame's worth at a time
+template <std::size_t Size>
+static double runCommandQueue()
+{
+	CommandQueue queue;
+	Capture<Size - sizeof(unsigned char*)> capture = {};
+	unsigned char* sink = nullptr;
+
+	return measure([&]()
+	{
+		std::size_t categories = 0;
+		for (std::size_t frame = 0; frame < FrameCount; ++frame)
+		{
+			for (std::size_t i = 0; i < CommandsPerFrame; ++i)
+			{
+				Command command;
+				command.category = (unsigned int)i;
+				command.action = [capture, sink](SceneNode&, const GameTimer&) { *sink = capture.bytes[0]; };
+				queue.push(std::move(command));
+			}
+
+			while (!queue.isEmpty())
+				categories += queue.pop().category;
+		}
+		keep(categories);
+	});
+}
+
+// Pushes and pops CommandCount std::function commands through a std::queue, a frame's worth at a time
+template <std::size_t Size>
+static double runFunctionQueue()
+{
+	std::queue<FunctionCommand> queue;
+	Capture<Size - sizeof(unsigned char*)> capture = {};
+	unsigned char* sink = nullptr;
+
+	return measure([&]()
+	{
+		std::size_t categories = 0;
+		for (std::size_t frame = 0; frame < FrameCount; ++frame)
+		{
+			for (std::size_t i = 0; i < CommandsPerFrame; ++i)
+			{
+				FunctionCommand command;
+				command.category = (unsigned int)i;
+				command.action = [capture, sink](SceneNode&, const GameTimer&) { *sink = capture.bytes[0]; };
+				queue.push(std::move(command));
+			}
+
+			while (!queue.empty())
+			{
+				categories += queue.front().category;
+				queue.pop();
+			}
+		}
+		keep(categories);
+	});
+}
+
+// Command throughput of the in-place ring buffer against std::function in std::queue
+BENCHMARK(CommandQueuePushPop)
+{
+	report("CommandQueue, 16-byte capture", runCommandQueue<16>(), CommandCount);
+	report("std::queue<std::function>, 16-byte capture", runFunctionQueue<16>(), CommandCount);
+	report("CommandQueue, 48-byte capture", runCommandQueue<48>(), CommandCount);
+	report("std::queue<std::function>, 48-byte capture", runFunctionQueue<48>(), CommandCount);
+}
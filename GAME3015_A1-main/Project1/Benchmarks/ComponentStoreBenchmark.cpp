@@ -0,0 +1,148 @@
+//***************************************************************************************
+// ComponentStoreBenchmark.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Benchmark.hpp"
+#include "../Project1/ComponentStore.hpp"
+#include "../Project1/TransformStore.hpp"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+// Objects moved by both sides
+static const std::size_t ObjectCount = 100000;
+
+// The fixed simulation tick
+static const float StepTime = 1.0f / 60.0f;
+
+// Stand-in for SceneNode: its own update, then a virtual call per child, with the transform in a TransformStore
+class TreeNode
+{
+public:
+	explicit TreeNode(TransformStore& transforms)
+		: mTransforms(transforms)
+		, mHandle(transforms.create())
+		, mChildren()
+	{
+	}
+
+	virtual ~TreeNode()
+	{
+	}
+
+	// Attaches a child to this node
+	void attachChild(std::unique_ptr<TreeNode> child)
+	{
+		mTransforms.setParent(child->mHandle, mHandle);
+		mChildren.push_back(std::move(child));
+	}
+
+	// Updates this node, then its children
+	void update(float dt)
+	{
+		updateCurrent(dt);
+		for (const std::unique_ptr<TreeNode>& child : mChildren)
+			child->update(dt);
+	}
+
+
+protected:
+	// Does nothing for a plain node
+	virtual void updateCurrent(float dt)
+	{
+	}
+
+
+protected:
+	TransformStore& mTransforms;
+	TransformStore::Handle mHandle;
+
+
+private:
+	std::vector<std::unique_ptr<TreeNode>> mChildren;
+};
+
+// Stand-in for Entity: moves itself by its velocity in its virtual update
+class TreeEntity : public TreeNode
+{
+public:
+	TreeEntity(TransformStore& transforms, const XMFLOAT3& velocity, RenderItem* renderItem)
+		: TreeNode(transforms)
+		, mVelocity(velocity)
+	{
+		mTransforms.setRenderItem(mHandle, renderItem, nullptr);
+	}
+
+
+private:
+	// Moves the entity by one step of its velocity
+	virtual void updateCurrent(float dt) override
+	{
+		mTransforms.move(mHandle, mVelocity.x * dt, mVelocity.y * dt, mVelocity.z * dt);
+	}
+
+
+private:
+	XMFLOAT3 mVelocity;
+};
+
+// Returns count random velocities; the same ones every run
+static std::vector<XMFLOAT3> makeVelocities(std::size_t count)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> speed(-10.0f, 10.0f);
+
+	std::vector<XMFLOAT3> velocities(count);
+	for (XMFLOAT3& velocity : velocities)
+		velocity = XMFLOAT3(speed(random), speed(random), speed(random));
+	return velocities;
+}
+
+// One tick and one interpolated frame of 100k moving, rendered objects: as Entity-like nodes under one
+// layer of a virtual-dispatch tree over a TransformStore, and as rows of a ComponentStore archetype
+BENCHMARK(ComponentStore100kAgainstSceneGraph)
+{
+	const std::vector<XMFLOAT3> velocities = makeVelocities(ObjectCount);
+	std::vector<RenderItem*> changed;
+	changed.reserve(ObjectCount);
+
+	std::unique_ptr<RenderItem[]> treeItems(new RenderItem[ObjectCount]);
+	TransformStore transforms;
+	TreeNode root(transforms);
+	std::unique_ptr<TreeNode> layer(new TreeNode(transforms));
+	for (std::size_t i = 0; i < ObjectCount; ++i)
+		layer->attachChild(std::unique_ptr<TreeNode>(new TreeEntity(transforms, velocities[i], &treeItems[i])));
+	root.attachChild(std::move(layer));
+	transforms.update();
+
+	std::unique_ptr<RenderItem[]> storeItems(new RenderItem[ObjectCount]);
+	ComponentStore store;
+	for (std::size_t i = 0; i < ObjectCount; ++i)
+	{
+		const ComponentStore::Handle handle = store.create(Component::Transform | Component::Velocity | Component::Render);
+		*store.getVelocity(handle) = velocities[i];
+		*store.getRenderItem(handle) = &storeItems[i];
+	}
+
+	report("scene graph, update", measure([&]()
+	{
+		root.update(StepTime);
+		transforms.update();
+	}), ObjectCount);
+	report("component store, integrate", measure([&]() { store.integrate(StepTime); }), ObjectCount);
+
+	report("scene graph, interpolate", measure([&]()
+	{
+		changed.clear();
+		transforms.interpolate(0.5f, changed);
+	}), ObjectCount);
+	report("component store, interpolate", measure([&]()
+	{
+		changed.clear();
+		store.interpolate(0.5f, changed);
+	}), ObjectCount);
+	keep(changed.size());
+}
@@ -0,0 +1,184 @@
+//***************************************************************************************
+// DynamicAabbTreeBenchmark.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Benchmark.hpp"
+#include "../Project1/DynamicAabbTree.hpp"
+#include "../Project1/TransformStore.hpp"
+#include "../Project1/RenderItem.hpp"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+// Side of the cube the boxes are scattered in, and queries per run
+static const float WorldSize = 1000.0f;
+static const std::size_t QueryCount = 1000;
+
+// Returns count boxes of 1 to 4 units at random positions, the same ones every run
+static std::vector<Aabb> makeBoxes(std::size_t count, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(0.0f, WorldSize);
+	std::uniform_real_distribution<float> size(0.5f, 2.0f);
+
+	std::vector<Aabb> boxes(count);
+	for (Aabb& box : boxes)
+	{
+		const XMFLOAT3 center(position(random), position(random), position(random));
+		const float extent = size(random);
+		box.min = XMFLOAT3(center.x - extent, center.y - extent, center.z - extent);
+		box.max = XMFLOAT3(center.x + extent, center.y + extent, center.z + extent);
+	}
+	return boxes;
+}
+
+// Returns a box moved by an offset
+static Aabb offsetBox(const Aabb& box, float x, float y, float z)
+{
+	Aabb moved;
+	moved.min = XMFLOAT3(box.min.x + x, box.min.y + y, box.min.z + z);
+	moved.max = XMFLOAT3(box.max.x + x, box.max.y + y, box.max.z + z);
+	return moved;
+}
+
+// Builds a tree over the boxes
+static void fillTree(DynamicAabbTree& tree, const std::vector<Aabb>& boxes)
+{
+	for (const Aabb& box : boxes)
+		tree.createProxy(box, nullptr);
+}
+
+// Insert, bulk refit, rebuild and the three queries over one tree size
+static void runTree(std::size_t count)
+{
+	const std::vector<Aabb> boxes = makeBoxes(count, 1);
+	const std::vector<Aabb> queries = makeBoxes(QueryCount, 2);
+	const std::string size = " (" + std::to_string(count / 1000) + "k)";
+
+	report("insert" + size, measure([&]()
+	{
+		DynamicAabbTree tree;
+		fillTree(tree, boxes);
+		keep((std::size_t)tree.getHeight());
+	}), count);
+
+	DynamicAabbTree tree;
+	fillTree(tree, boxes);
+
+	// Every box moves further than the margin, as after a simulation step of fast objects
+	int step = 0;
+	report("updateProxy all + refit" + size, measure([&]()
+	{
+		const float offset = (++step % 2) ? 0.5f : -0.5f;
+		for (std::size_t i = 0; i < count; ++i)
+			tree.updateProxy((int)i, offsetBox(boxes[i], offset, 0.0f, 0.0f));
+		tree.refit();
+	}), count);
+
+	report("rebuild" + size, measure([&]()
+	{
+		tree.rebuild();
+	}), count);
+
+	// Boxes of about 20 units, a few hits each
+	report("overlap queries" + size, measure([&]()
+	{
+		std::size_t hits = 0;
+		for (const Aabb& query : queries)
+		{
+			const Aabb area = { XMFLOAT3(query.min.x - 10.0f, query.min.y - 10.0f, query.min.z - 10.0f),
+				XMFLOAT3(query.max.x + 10.0f, query.max.y + 10.0f, query.max.z + 10.0f) };
+			tree.queryOverlap(area, [&hits](int) { ++hits; return true; });
+		}
+		keep(hits);
+	}), QueryCount);
+
+	// The same queries as a scan over every box, what a state without a tree has to do
+	report("overlap queries, linear scan" + size, measure([&]()
+	{
+		std::size_t hits = 0;
+		for (const Aabb& query : queries)
+		{
+			const Aabb area = { XMFLOAT3(query.min.x - 10.0f, query.min.y - 10.0f, query.min.z - 10.0f),
+				XMFLOAT3(query.max.x + 10.0f, query.max.y + 10.0f, query.max.z + 10.0f) };
+			for (const Aabb& box : boxes)
+				hits += area.overlaps(box) ? 1 : 0;
+		}
+		keep(hits);
+	}), QueryCount);
+
+	// A view of a tenth of the world along each axis, as six inward facing planes
+	report("frustum queries" + size, measure([&]()
+	{
+		std::size_t hits = 0;
+		for (std::size_t q = 0; q < QueryCount / 10; ++q)
+		{
+			const XMFLOAT3 c = queries[q].min;
+			const float half = WorldSize * 0.05f;
+			const XMFLOAT4 planes[6] =
+			{
+				XMFLOAT4(1.0f, 0.0f, 0.0f, half - c.x), XMFLOAT4(-1.0f, 0.0f, 0.0f, half + c.x),
+				XMFLOAT4(0.0f, 1.0f, 0.0f, half - c.y), XMFLOAT4(0.0f, -1.0f, 0.0f, half + c.y),
+				XMFLOAT4(0.0f, 0.0f, 1.0f, half - c.z), XMFLOAT4(0.0f, 0.0f, -1.0f, half + c.z),
+			};
+			tree.queryFrustum(planes, 6, [&hits](int) { ++hits; return true; });
+		}
+		keep(hits);
+	}), QueryCount / 10);
+
+	// Rays across the world that stop at the nearest hit
+	report("ray casts, nearest hit" + size, measure([&]()
+	{
+		std::size_t hits = 0;
+		for (const Aabb& query : queries)
+		{
+			const XMFLOAT3 origin(query.min.x, query.min.y, 0.0f);
+			tree.rayCast(origin, XMFLOAT3(0.0f, 0.0f, 1.0f), WorldSize,
+				[&hits](int, float distance) { ++hits; return distance; });
+		}
+		keep(hits);
+	}), QueryCount);
+}
+
+// Dynamic AABB tree operations at the sizes a crowded state reaches
+BENCHMARK(DynamicAabbTreeOperations)
+{
+	runTree(10000);
+	runTree(50000);
+	runTree(100000);
+}
+
+// What keeping a tree in step with a TransformStore adds to a simulation step where everything moves
+BENCHMARK(DynamicAabbTreeTransformStoreStep)
+{
+	const std::size_t count = 10000;
+	const std::vector<Aabb> boxes = makeBoxes(count, 3);
+	std::vector<RenderItem> items(count);
+
+	for (int attached = 0; attached < 2; ++attached)
+	{
+		TransformStore transforms;
+		DynamicAabbTree tree;
+		if (attached)
+			transforms.setSpatialTree(&tree);
+
+		std::vector<TransformStore::Handle> handles;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			handles.push_back(transforms.create());
+			transforms.setPosition(handles.back(), boxes[i].min.x, boxes[i].min.y, boxes[i].min.z);
+			transforms.setRenderItem(handles.back(), &items[i], nullptr);
+		}
+		transforms.update();
+
+		report(attached ? "update, tree attached (10k)" : "update, no tree (10k)", measure([&]()
+		{
+			for (TransformStore::Handle handle : handles)
+				transforms.move(handle, 0.5f, 0.0f, 0.0f);
+			transforms.update();
+		}), count);
+	}
+}
@@ -0,0 +1,119 @@
+//***************************************************************************************
+// ProjectilePoolBenchmark.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Benchmark.hpp"
+#include "../Project1/ProjectilePool.hpp"
+#include "../Project1/HeadlessFrame.hpp"
+#include "../Project1/RecordingRenderDevice.hpp"
+#include "../../Common/Material.h"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+// Projectiles alive at once; the game keeps about 120, this shows how the pool and its draw scale
+static const std::size_t ProjectileCount = 50000;
+
+// The fixed simulation tick and the frame rate drawing it
+static const float StepTime = 1.0f / 60.0f;
+
+// Fills the pool with projectiles flying in random directions for random lifetimes of up to two
+// seconds, the lifetime of a fired bullet; the same projectiles every run
+static void fill(ProjectilePool& pool, std::mt19937& random)
+{
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> speed(-30.0f, 30.0f);
+	std::uniform_real_distribution<float> lifetime(0.1f, 2.0f);
+
+	while (pool.launch(XMFLOAT3(position(random), position(random), position(random)),
+		XMFLOAT3(speed(random), speed(random), speed(random)), lifetime(random)))
+	{
+	}
+}
+
+// Frame resources the frames cycle through, as many as Game uses by default
+static const unsigned int FramesInFlight = 3;
+
+// The batcher and the recorder only compare geometry addresses, so any unique address stands in for a mesh
+static char GeometryTag;
+
+// What a frame draws the projectiles with: one item at the scale the world uses, and a camera
+// looking down the z axis from behind the cube the projectiles fly in, so part of them is culled
+struct ProjectileScene
+{
+	Material						material;
+	RenderItem						item;
+	RecordingRenderDevice			device;
+	HeadlessFrame					frame;
+
+	ProjectileScene()
+		: material()
+		, item()
+		, device()
+		, frame(device, FramesInFlight)
+	{
+		item.Mat = &material;
+		item.Geo = reinterpret_cast<MeshGeometry*>(&GeometryTag);
+		item.IndexCount = 36;
+		item.Bounds = BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+		XMStoreFloat4x4(&item.World, XMMatrixScaling(0.5f, 0.5f, 0.5f));
+		frame.getFrameConstants().allocateObject(&item);
+		frame.getFrameConstants().publishObjects(&item, 1);
+
+		XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -150.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * MathHelper::Pi, 4.0f / 3.0f, 1.0f, 1000.0f);
+		frame.setCamera(view, proj, XMFLOAT3(0.0f, 0.0f, -150.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), 1000.0f);
+	}
+
+	// Draws the positions as Game draws the projectile stream: submit, cull, sort, batch, and upload
+	// the positions; the recorded stream is dropped first so it stays the size of one frame
+	void draw(const std::vector<XMFLOAT3>& positions, size_t count)
+	{
+		device.clear();
+		frame.run(
+			[](std::vector<RenderItem*>&) {},
+			[&](RenderBatcher& batcher) { batcher.submitInstances(&item, positions.data(), count); });
+	}
+};
+
+// One second at 60 Hz of a full pool: every tick steps the pool, refills the expired projectiles,
+// and draws the frame after it
+static void runSecond(ProjectilePool& pool, std::vector<XMFLOAT3>& positions, ProjectileScene& scene)
+{
+	std::mt19937 random(1);
+	pool.clear();
+	fill(pool, random);
+
+	for (int tick = 0; tick < 60; ++tick)
+	{
+		pool.update(StepTime);
+		fill(pool, random);
+
+		pool.interpolate(0.5f, positions.data());
+		scene.draw(positions, pool.getCount());
+	}
+	keep(scene.frame.getCullStats().Visible);
+}
+
+// The simulation, interpolation, and drawing cost of a full 50k projectile pool, against the 16.7 ms of a 60 Hz frame
+BENCHMARK(ProjectilePool50kAt60Hz)
+{
+	ProjectilePool pool(ProjectileCount);
+	std::vector<XMFLOAT3> positions(ProjectileCount);
+	std::unique_ptr<ProjectileScene> scene(new ProjectileScene());
+
+	std::mt19937 random(1);
+	fill(pool, random);
+	report("step, 50k", measure([&]() { pool.update(StepTime); fill(pool, random); }), ProjectileCount);
+	report("interpolate, 50k", measure([&]() { pool.interpolate(0.5f, positions.data()); }), ProjectileCount);
+	report("submit, cull, sort and upload, 50k", measure([&]() { scene->draw(positions, pool.getCount()); }), ProjectileCount);
+	std::printf("    %u visible, %u culled\n", scene->frame.getCullStats().Visible, scene->frame.getCullStats().Culled);
+
+	const double second = measure([&]() { runSecond(pool, positions, *scene); });
+	report("60 ticks and frames, 50k", second, ProjectileCount * 60);
+	std::printf("    %.3f ms per tick and frame, %.1f%% of a 60 Hz frame\n", second / 60.0, second / 60.0 / (1000.0 / 60.0) * 100.0);
+}
@@ -0,0 +1,166 @@
+//***************************************************************************************
+// TransformStoreBenchmark.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Benchmark.hpp"
+#include "../Project1/TransformStore.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+// One node's local transform values
+struct LocalTransform
+{
+	XMFLOAT3 position;
+	XMFLOAT3 rotation;
+	XMFLOAT3 scale;
+};
+
+// Random local transforms; the same ones every run
+static std::vector<LocalTransform> makeLocalTransforms(std::size_t count)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> rotation(-XM_PI, XM_PI);
+	std::uniform_real_distribution<float> scale(0.5f, 3.0f);
+
+	std::vector<LocalTransform> locals(count);
+	for (LocalTransform& local : locals)
+	{
+		local.position = XMFLOAT3(position(random), position(random), position(random));
+		local.rotation = XMFLOAT3(rotation(random), rotation(random), rotation(random));
+		local.scale = XMFLOAT3(scale(random), scale(random), scale(random));
+	}
+	return locals;
+}
+
+// The local transform rebuild of the four-slot kernel against the per-node DirectXMath chain it
+// replaced, with every node changed; both pay for writing the new rotation
+BENCHMARK(TransformStoreLocalKernel)
+{
+	for (std::size_t count : { 1000, 10000, 100000 })
+	{
+		const std::vector<LocalTransform> locals = makeLocalTransforms(count);
+		const std::string size = std::to_string(count / 1000) + "k";
+
+		std::vector<LocalTransform> chainLocals = locals;
+		std::vector<XMFLOAT4X4> chainTransforms(count);
+		report("chain, " + size, measure([&]()
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				LocalTransform& local = chainLocals[i];
+				local.rotation.z += 0.001f;
+				XMStoreFloat4x4(&chainTransforms[i], XMMatrixScaling(local.scale.x, local.scale.y, local.scale.z) *
+					XMMatrixRotationX(local.rotation.x) *
+					XMMatrixRotationY(local.rotation.y) *
+					XMMatrixRotationZ(local.rotation.z) *
+					XMMatrixTranslation(local.position.x, local.position.y, local.position.z));
+			}
+			keep((std::size_t)chainTransforms[count / 2]._11);
+		}), count);
+
+		TransformStore transforms;
+		std::vector<TransformStore::Handle> handles(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const LocalTransform& local = locals[i];
+			handles[i] = transforms.create();
+			transforms.setPosition(handles[i], local.position.x, local.position.y, local.position.z);
+			transforms.setRotation(handles[i], local.rotation.x, local.rotation.y, local.rotation.z);
+			transforms.setScale(handles[i], local.scale.x, local.scale.y, local.scale.z);
+		}
+		transforms.update();
+
+		std::vector<LocalTransform> kernelLocals = locals;
+		report("kernel, " + size, measure([&]()
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				LocalTransform& local = kernelLocals[i];
+				local.rotation.z += 0.001f;
+				transforms.setRotation(handles[i], local.rotation.x, local.rotation.y, local.rotation.z);
+			}
+			for (std::size_t i = 0; i < count; ++i)
+				transforms.getTransform(handles[i]);
+			keep((std::size_t)transforms.getTransform(handles[count / 2])._11);
+		}), count);
+	}
+}
+
+// Creates roots root nodes, each with a subtree of perRoot nodes: a chain when deep, otherwise
+// children of the root directly; returns the handles in creation order, every root first in its subtree
+static std::vector<TransformStore::Handle> buildForest(TransformStore& transforms, std::size_t roots,
+	std::size_t perRoot, bool deep)
+{
+	std::vector<TransformStore::Handle> handles;
+	for (std::size_t r = 0; r < roots; ++r)
+	{
+		const TransformStore::Handle root = transforms.create();
+		transforms.setPosition(root, (float)r, 0.0f, 0.0f);
+		handles.push_back(root);
+
+		TransformStore::Handle parent = root;
+		for (std::size_t i = 0; i < perRoot; ++i)
+		{
+			const TransformStore::Handle node = transforms.create();
+			transforms.setParent(node, parent);
+			transforms.setPosition(node, 0.0f, 1.0f, 0.0f);
+			transforms.setRotation(node, 0.0f, 0.0f, 0.01f);
+			handles.push_back(node);
+			if (deep)
+				parent = node;
+		}
+	}
+	transforms.update();
+	return handles;
+}
+
+// Sixty updates of a forest with the given nodes moved before each one
+static double measureUpdates(TransformStore& transforms, const std::vector<TransformStore::Handle>& moved)
+{
+	return measure([&]()
+	{
+		for (int tick = 0; tick < 60; ++tick)
+		{
+			const float offset = (tick & 1) ? 0.01f : -0.01f;
+			for (TransformStore::Handle handle : moved)
+				transforms.move(handle, offset, 0.0f, 0.0f);
+			transforms.update();
+		}
+		keep(transforms.size());
+	});
+}
+
+// Updating only the stale part of the hierarchy against rebuilding all of it, on 100 chains 100 deep
+// and on 10 roots with 1000 children each; moving a root makes its whole subtree stale
+BENCHMARK(TransformStoreHierarchy)
+{
+	const std::size_t roots[] = { 100, 10 };
+	const std::size_t perRoot[] = { 100, 1000 };
+	const char* names[] = { "deep chains", "wide fan-out" };
+
+	for (int shape = 0; shape < 2; ++shape)
+	{
+		TransformStore transforms;
+		const std::vector<TransformStore::Handle> handles = buildForest(transforms, roots[shape], perRoot[shape], shape == 0);
+		const std::size_t count = handles.size();
+		const std::string name = names[shape];
+
+		std::vector<TransformStore::Handle> leaf(1, handles[perRoot[shape]]);
+		report(name + ", one leaf moved", measureUpdates(transforms, leaf), count * 60);
+
+		std::vector<TransformStore::Handle> onePercent;
+		for (std::size_t i = 1; i < count; i += 100)
+			onePercent.push_back(handles[i]);
+		report(name + ", 1% moved", measureUpdates(transforms, onePercent), count * 60);
+
+		std::vector<TransformStore::Handle> root(1, handles[0]);
+		report(name + ", one root moved", measureUpdates(transforms, root), count * 60);
+
+		report(name + ", full rebuild", measureUpdates(transforms, handles), count * 60);
+	}
+}
@@ -0,0 +1,17 @@
+//***************************************************************************************
+// main.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Benchmark.hpp"
+
+#include <cstdio>
+
+// Runs the benchmarks; the optional argument only runs those whose name contains it.
+// Build in Release, timings of a Debug build say little about the game.
+int main(int argc, char** argv)
+{
+	const int run = runBenchmarks(argc > 1 ? argv[1] : nullptr);
+	if (run == 0)
+		std::printf("No benchmark matches\n");
+	return 0;
+}
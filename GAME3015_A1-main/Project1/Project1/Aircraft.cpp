@@ -10,6 +10,7 @@
 // Constructor
 Aircraft::Aircraft(Type type, State* state) : Entity(state)
 	, mType(type)
+	, mIsFiring(false)
 {
 	// Set the aircraft's sprite based on its type
 	switch (type)
@@ -39,37 +40,43 @@ unsigned int Aircraft::getCategory() const
 	}
 }
 
-// Draws the current aircraft
-void Aircraft::drawCurrent() const
+// Turns away from an aircraft it ran into, reversing the velocity components heading towards it
+void Aircraft::onCollision(Entity& other, const GameTimer& gt)
 {
-	// Calculate the constant buffer byte size
-	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-	UINT matCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants));
+	const XMFLOAT3 position = getWorldPosition();
+	const XMFLOAT3 otherPosition = other.getWorldPosition();
+	XMFLOAT3 velocity = getVelocity();
 
-	Game* game = mState->getContext()->game;
+	if (velocity.x * (otherPosition.x - position.x) > 0)
+		velocity.x = -velocity.x;
 
-	auto objectCB = game->mCurrFrameResource->ObjectCB->Resource();
-	auto matCB = game->mCurrFrameResource->MaterialCB->Resource();
+	if (velocity.y * (otherPosition.y - position.y) > 0)
+		velocity.y = -velocity.y;
 
-	// If the aircraft render item exists, configure the command list and draw it
-	if (mAircraftRitem != nullptr)
-	{
-		game->getCmdList()->IASetVertexBuffers(0, 1, &mAircraftRitem->Geo->VertexBufferView());
-		game->getCmdList()->IASetIndexBuffer(&mAircraftRitem->Geo->IndexBufferView());
-		game->getCmdList()->IASetPrimitiveTopology(mAircraftRitem->PrimitiveType);
+	if (velocity.z * (otherPosition.z - position.z) > 0)
+		velocity.z = -velocity.z;
 
-		CD3DX12_GPU_DESCRIPTOR_HANDLE tex(game->mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-		tex.Offset(mAircraftRitem->Mat->DiffuseSrvHeapIndex, game->mCbvSrvDescriptorSize);
+	setVelocity(velocity);
+}
 
-		D3D12_GPU_VIRTUAL_ADDRESS objCBAddress =  objectCB->GetGPUVirtualAddress() + (UINT64)mAircraftRitem->ObjCBIndex * objCBByteSize;
-		D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = matCB->GetGPUVirtualAddress() + (UINT64)mAircraftRitem->Mat->MatCBIndex * matCBByteSize;
+// Sets whether the aircraft fires this step
+void Aircraft::setFiring(bool firing)
+{
+	mIsFiring = firing;
+}
 
-		game->getCmdList()->SetGraphicsRootDescriptorTable(0, tex);
-		game->getCmdList()->SetGraphicsRootConstantBufferView(1, objCBAddress);
-		game->getCmdList()->SetGraphicsRootConstantBufferView(3, matCBAddress);
+// Returns true if the aircraft fires this step
+bool Aircraft::isFiring() const
+{
+	return mIsFiring;
+}
 
-		game->getCmdList()->DrawIndexedInstanced(mAircraftRitem->IndexCount, 1, mAircraftRitem->StartIndexLocation, mAircraftRitem->BaseVertexLocation, 0);
-	}
+// Draws the current aircraft
+void Aircraft::drawCurrent() const
+{
+	// Queue the render item; Game draws it instanced together with every item sharing its geometry and material
+	if (mAircraftRitem != nullptr)
+		mState->getContext()->game->getRenderBatcher().submit(mAircraftRitem);
 }
 
 // Builds the current aircraft
@@ -80,13 +87,14 @@ void Aircraft::buildCurrent()
 	auto render = std::make_unique<RenderItem>();
 	renderer = render.get();
 	renderer->World = getTransform();
-	renderer->ObjCBIndex = (UINT) mState->getRenderItems().size();
-	renderer->Mat = game->getMaterials()[mSprite].get();
-	renderer->Geo = game->getGeometries()["boxGeo"].get();
+	mState->allocateObject(renderer);
+	renderer->Mat = game->getMaterials().at(mSprite).get();
+	renderer->Geo = game->getGeometries().at("boxGeo").get();
 	renderer->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	renderer->IndexCount = renderer->Geo->DrawArgs["box"].IndexCount;
-	renderer->StartIndexLocation = renderer->Geo->DrawArgs["box"].StartIndexLocation;
-	renderer->BaseVertexLocation = renderer->Geo->DrawArgs["box"].BaseVertexLocation;
+	renderer->IndexCount = renderer->Geo->DrawArgs.at("box").IndexCount;
+	renderer->StartIndexLocation = renderer->Geo->DrawArgs.at("box").StartIndexLocation;
+	renderer->BaseVertexLocation = renderer->Geo->DrawArgs.at("box").BaseVertexLocation;
+	renderer->Bounds = renderer->Geo->DrawArgs.at("box").Bounds;
 	mAircraftRitem = render.get();
 	mState->getRenderItems().push_back(std::move(render));
 }
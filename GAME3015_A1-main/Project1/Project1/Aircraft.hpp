@@ -17,6 +17,10 @@ public:
 public:
 	Aircraft(Type type, State* state);
 	virtual unsigned int getCategory() const;
+	virtual void		onCollision(Entity& other, const GameTimer& gt);
+
+	void				setFiring(bool firing);
+	bool				isFiring() const;
 
 
 private:
@@ -28,4 +32,5 @@ private:
 	Type				mType;
 	std::string			mSprite;
 	RenderItem* mAircraftRitem;
+	bool				mIsFiring;
 };
@@ -0,0 +1,254 @@
+//***************************************************************************************
+// AircraftKernel.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "AircraftKernel.hpp"
+
+#include <cassert>
+#include <cfloat>
+#include <cstring>
+
+// Both paths must round every multiply and add on its own for their results to agree
+#ifdef _MSC_VER
+#pragma fp_contract (off)
+#endif
+
+using namespace DirectX;
+
+// Applies the bounds response of one axis to four lanes
+static inline void respond(XMVECTOR& position, XMVECTOR& velocity, FXMVECTOR min, FXMVECTOR max,
+	FXMVECTOR clamp, GXMVECTOR reflect)
+{
+	const XMVECTOR below = XMVectorLess(position, min);
+	const XMVECTOR above = XMVectorGreater(position, max);
+
+	const XMVECTOR clamped = XMVectorSelect(XMVectorSelect(position, max, above), min, below);
+	position = XMVectorSelect(position, clamped, clamp);
+
+	// Flipping the sign bit matches scalar negation; XMVectorNegate computes 0 - v, which differs for +0
+	const XMVECTOR reversed = XMVectorXorInt(velocity, XMVectorSplatSignMask());
+	velocity = XMVectorSelect(velocity, reversed, XMVectorAndInt(XMVectorOrInt(below, above), reflect));
+}
+
+// Constructor, without bounds every position passes
+AircraftKernel::AircraftKernel()
+	: mCount(0)
+	, mMinX(-FLT_MAX)
+	, mMaxX(FLT_MAX)
+	, mMinY(-FLT_MAX)
+	, mMaxY(FLT_MAX)
+{
+}
+
+// Adds a lane at the origin and at rest, and returns its index
+size_t AircraftKernel::add(Response response)
+{
+	const size_t lane = mCount++;
+	const size_t padded = (mCount + 3) & ~(size_t)3;
+
+	for (std::vector<float>* column : { &mPositionX, &mPositionY, &mPositionZ, &mVelocityX, &mVelocityY, &mVelocityZ,
+		&mStepX, &mStepY, &mStepZ })
+	{
+		column->resize(padded, 0.0f);
+	}
+	mClamp.resize(padded, 0);
+	mReflect.resize(padded, 0);
+
+	mClamp[lane] = response == Response::Clamp ? ~0u : 0u;
+	mReflect[lane] = response == Response::Reflect ? ~0u : 0u;
+	return lane;
+}
+
+// Removes every lane
+void AircraftKernel::clear()
+{
+	for (std::vector<float>* column : { &mPositionX, &mPositionY, &mPositionZ, &mVelocityX, &mVelocityY, &mVelocityZ,
+		&mStepX, &mStepY, &mStepZ })
+	{
+		column->clear();
+	}
+	mClamp.clear();
+	mReflect.clear();
+	mCount = 0;
+}
+
+// Sets the x and y ranges the lanes respond to
+void AircraftKernel::setBounds(float minX, float maxX, float minY, float maxY)
+{
+	mMinX = minX;
+	mMaxX = maxX;
+	mMinY = minY;
+	mMaxY = maxY;
+}
+
+// Sets the position and velocity of a lane before a step
+void AircraftKernel::setState(size_t lane, const XMFLOAT3& position, const XMFLOAT3& velocity)
+{
+	mPositionX[lane] = position.x;
+	mPositionY[lane] = position.y;
+	mPositionZ[lane] = position.z;
+	mVelocityX[lane] = velocity.x;
+	mVelocityY[lane] = velocity.y;
+	mVelocityZ[lane] = velocity.z;
+}
+
+// Sets the position of a lane
+void AircraftKernel::setPosition(size_t lane, const XMFLOAT3& position)
+{
+	mPositionX[lane] = position.x;
+	mPositionY[lane] = position.y;
+	mPositionZ[lane] = position.z;
+}
+
+// Sets the velocity of a lane
+void AircraftKernel::setVelocity(size_t lane, const XMFLOAT3& velocity)
+{
+	mVelocityX[lane] = velocity.x;
+	mVelocityY[lane] = velocity.y;
+	mVelocityZ[lane] = velocity.z;
+}
+
+// Sets how far a lane moved in the last step, e.g. after collision response moved it back
+void AircraftKernel::setStep(size_t lane, const XMFLOAT3& step)
+{
+	mStepX[lane] = step.x;
+	mStepY[lane] = step.y;
+	mStepZ[lane] = step.z;
+}
+
+// Returns the position of a lane
+XMFLOAT3 AircraftKernel::getPosition(size_t lane) const
+{
+	return XMFLOAT3(mPositionX[lane], mPositionY[lane], mPositionZ[lane]);
+}
+
+// Returns the velocity of a lane
+XMFLOAT3 AircraftKernel::getVelocity(size_t lane) const
+{
+	return XMFLOAT3(mVelocityX[lane], mVelocityY[lane], mVelocityZ[lane]);
+}
+
+// Returns how far a lane moved in the last step, before its bounds response
+XMFLOAT3 AircraftKernel::getStep(size_t lane) const
+{
+	return XMFLOAT3(mStepX[lane], mStepY[lane], mStepZ[lane]);
+}
+
+// Integrates every lane and applies its bounds response, four lanes at a time
+void AircraftKernel::step(float dt)
+{
+#ifndef NDEBUG
+	AircraftKernel reference(*this);
+	reference.stepScalar(dt);
+#endif
+
+	const XMVECTOR delta = XMVectorReplicate(dt);
+	const XMVECTOR minX = XMVectorReplicate(mMinX);
+	const XMVECTOR maxX = XMVectorReplicate(mMaxX);
+	const XMVECTOR minY = XMVectorReplicate(mMinY);
+	const XMVECTOR maxY = XMVectorReplicate(mMaxY);
+
+	auto load = [](const std::vector<float>& column, size_t i) { return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&column[i])); };
+	auto store = [](std::vector<float>& column, size_t i, FXMVECTOR v) { XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&column[i]), v); };
+
+	for (size_t i = 0; i < mCount; i += 4)
+	{
+		const XMVECTOR clamp = XMLoadInt4(&mClamp[i]);
+		const XMVECTOR reflect = XMLoadInt4(&mReflect[i]);
+
+		XMVECTOR velocityX = load(mVelocityX, i);
+		XMVECTOR velocityY = load(mVelocityY, i);
+		const XMVECTOR velocityZ = load(mVelocityZ, i);
+
+		// The step is rounded before it is added, as in the scalar path
+		const XMVECTOR stepX = XMVectorMultiply(velocityX, delta);
+		const XMVECTOR stepY = XMVectorMultiply(velocityY, delta);
+		const XMVECTOR stepZ = XMVectorMultiply(velocityZ, delta);
+
+		XMVECTOR positionX = XMVectorAdd(load(mPositionX, i), stepX);
+		XMVECTOR positionY = XMVectorAdd(load(mPositionY, i), stepY);
+		const XMVECTOR positionZ = XMVectorAdd(load(mPositionZ, i), stepZ);
+
+		respond(positionX, velocityX, minX, maxX, clamp, reflect);
+		respond(positionY, velocityY, minY, maxY, clamp, reflect);
+
+		store(mStepX, i, stepX);
+		store(mStepY, i, stepY);
+		store(mStepZ, i, stepZ);
+		store(mPositionX, i, positionX);
+		store(mPositionY, i, positionY);
+		store(mPositionZ, i, positionZ);
+		store(mVelocityX, i, velocityX);
+		store(mVelocityY, i, velocityY);
+	}
+
+#ifndef NDEBUG
+	assert(matches(reference));
+#endif
+}
+
+// Integrates every lane and applies its bounds response, one lane at a time
+void AircraftKernel::stepScalar(float dt)
+{
+	for (size_t i = 0; i < mCount; ++i)
+	{
+		mStepX[i] = mVelocityX[i] * dt;
+		mStepY[i] = mVelocityY[i] * dt;
+		mStepZ[i] = mVelocityZ[i] * dt;
+
+		mPositionX[i] += mStepX[i];
+		mPositionY[i] += mStepY[i];
+		mPositionZ[i] += mStepZ[i];
+
+		if (mClamp[i])
+		{
+			if (mPositionX[i] < mMinX)
+				mPositionX[i] = mMinX;
+			else if (mPositionX[i] > mMaxX)
+				mPositionX[i] = mMaxX;
+
+			if (mPositionY[i] < mMinY)
+				mPositionY[i] = mMinY;
+			else if (mPositionY[i] > mMaxY)
+				mPositionY[i] = mMaxY;
+		}
+
+		if (mReflect[i])
+		{
+			if (mPositionX[i] < mMinX || mPositionX[i] > mMaxX)
+				mVelocityX[i] = -mVelocityX[i];
+
+			if (mPositionY[i] < mMinY || mPositionY[i] > mMaxY)
+				mVelocityY[i] = -mVelocityY[i];
+		}
+	}
+}
+
+// Returns true if every lane of both kernels holds the same bits. Any two NaNs count as equal:
+// which operand's payload an add keeps depends on the operand order the compiler picks.
+bool AircraftKernel::matches(const AircraftKernel& other) const
+{
+	if (mCount != other.mCount)
+		return false;
+
+	auto same = [](float a, float b) { return memcmp(&a, &b, sizeof(float)) == 0 || (a != a && b != b); };
+
+	for (size_t i = 0; i < mCount; ++i)
+	{
+		if (!same(mPositionX[i], other.mPositionX[i]) || !same(mPositionY[i], other.mPositionY[i])
+			|| !same(mPositionZ[i], other.mPositionZ[i]) || !same(mVelocityX[i], other.mVelocityX[i])
+			|| !same(mVelocityY[i], other.mVelocityY[i]) || !same(mVelocityZ[i], other.mVelocityZ[i])
+			|| !same(mStepX[i], other.mStepX[i]) || !same(mStepY[i], other.mStepY[i])
+			|| !same(mStepZ[i], other.mStepZ[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Returns the number of lanes
+size_t AircraftKernel::size() const
+{
+	return mCount;
+}
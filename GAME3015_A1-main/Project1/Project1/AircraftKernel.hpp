@@ -0,0 +1,68 @@
+#pragma once
+#include "../../Common/MathHelper.h"
+
+#include <cstdint>
+#include <vector>
+
+// Packed positions and velocities of a world's aircraft, stepped together.
+// step() integrates every lane and applies its response to the x/y bounds in
+// one pass, four lanes at a time and without branches: clamped lanes are held
+// inside the bounds, reflected lanes have the velocity component reversed on
+// the axis they left the bounds on. stepScalar() does the same one lane at a
+// time with the branches of the original per-entity code; both use the same
+// float operations in the same order, so their results are identical to the
+// bit (NaN payloads aside), and debug builds check step() against it every call.
+class AircraftKernel
+{
+public:
+	enum class Response
+	{
+		Clamp,
+		Reflect,
+	};
+
+
+public:
+									AircraftKernel();
+
+	size_t							add(Response response);
+	void							clear();
+	void							setBounds(float minX, float maxX, float minY, float maxY);
+
+	void							setState(size_t lane, const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& velocity);
+	void							setPosition(size_t lane, const DirectX::XMFLOAT3& position);
+	void							setVelocity(size_t lane, const DirectX::XMFLOAT3& velocity);
+	void							setStep(size_t lane, const DirectX::XMFLOAT3& step);
+	DirectX::XMFLOAT3				getPosition(size_t lane) const;
+	DirectX::XMFLOAT3				getVelocity(size_t lane) const;
+	DirectX::XMFLOAT3				getStep(size_t lane) const;
+
+	void							step(float dt);
+	void							stepScalar(float dt);
+	bool							matches(const AircraftKernel& other) const;
+
+	size_t							size() const;
+
+
+private:
+	// Lane columns, padded to a multiple of four with lanes that have no response
+	std::vector<float>				mPositionX;
+	std::vector<float>				mPositionY;
+	std::vector<float>				mPositionZ;
+	std::vector<float>				mVelocityX;
+	std::vector<float>				mVelocityY;
+	std::vector<float>				mVelocityZ;
+	std::vector<float>				mStepX;
+	std::vector<float>				mStepY;
+	std::vector<float>				mStepZ;
+
+	// All bits set in the lanes with that response
+	std::vector<uint32_t>			mClamp;
+	std::vector<uint32_t>			mReflect;
+
+	size_t							mCount;
+	float							mMinX;
+	float							mMaxX;
+	float							mMinY;
+	float							mMaxY;
+};
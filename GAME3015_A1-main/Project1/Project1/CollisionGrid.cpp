@@ -0,0 +1,440 @@
+//***************************************************************************************
+// CollisionGrid.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "CollisionGrid.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+// Bits per packed cell coordinate; cells further than 2^20 from the origin are clamped
+static const int CellBits = 21;
+static const int CellBias = 1 << (CellBits - 1);
+
+// Constructor, the cell size should be about the size of a typical collider
+CollisionGrid::CollisionGrid(float cellSize)
+	: mColliders()
+	, mEntries()
+	, mCellSize(1.0f)
+	, mInverseCellSize(1.0f)
+	, mStats()
+{
+	setCellSize(cellSize);
+}
+
+// Sets the edge length of the world cells, used from the next findContacts()
+void CollisionGrid::setCellSize(float cellSize)
+{
+	mCellSize = std::max(cellSize, 0.001f);
+	mInverseCellSize = 1.0f / mCellSize;
+}
+
+// Returns the edge length of the world cells
+float CollisionGrid::getCellSize() const
+{
+	return mCellSize;
+}
+
+// Forgets the colliders of the previous step, keeping the allocations
+void CollisionGrid::clear()
+{
+	mColliders.clear();
+	mEntries.clear();
+}
+
+// Adds a collider that does not move fast with its world space collision box for the next findContacts()
+void CollisionGrid::add(Collidable* collidable, const BoundingOrientedBox& box)
+{
+	add(collidable, box, XMFLOAT3(0.0f, 0.0f, 0.0f));
+}
+
+// Adds a collider with its world space collision box at the end of the step and how far it moved during
+// the step; a moving collider is swept and tested continuously against the others
+void CollisionGrid::add(Collidable* collidable, const BoundingOrientedBox& box, const XMFLOAT3& displacement)
+{
+	Collider collider;
+	collider.collidable = collidable;
+	collider.box = box;
+	collider.displacement = displacement;
+	collider.swept = displacement.x != 0.0f || displacement.y != 0.0f || displacement.z != 0.0f;
+
+	// Box around the oriented box: each world axis gets the projection of the three box axes
+	const XMMATRIX rotation = XMMatrixRotationQuaternion(XMLoadFloat4(&box.Orientation));
+	XMVECTOR extents = XMVectorMultiply(XMVectorAbs(rotation.r[0]), XMVectorReplicate(box.Extents.x));
+	extents = XMVectorMultiplyAdd(XMVectorAbs(rotation.r[1]), XMVectorReplicate(box.Extents.y), extents);
+	extents = XMVectorMultiplyAdd(XMVectorAbs(rotation.r[2]), XMVectorReplicate(box.Extents.z), extents);
+
+	const XMVECTOR center = XMLoadFloat3(&box.Center);
+	XMStoreFloat3(&collider.endAabb.min, XMVectorSubtract(center, extents));
+	XMStoreFloat3(&collider.endAabb.max, XMVectorAdd(center, extents));
+
+	// Swept colliders enter the grid with the box covering their whole motion
+	collider.aabb = collider.endAabb;
+	if (collider.swept)
+	{
+		Aabb start;
+		start.min = XMFLOAT3(collider.endAabb.min.x - displacement.x, collider.endAabb.min.y - displacement.y, collider.endAabb.min.z - displacement.z);
+		start.max = XMFLOAT3(collider.endAabb.max.x - displacement.x, collider.endAabb.max.y - displacement.y, collider.endAabb.max.z - displacement.z);
+		collider.aabb = Aabb::merge(collider.endAabb, start);
+	}
+
+	mColliders.push_back(collider);
+}
+
+// Replaces contacts with every pair of added colliders whose oriented boxes intersect, or touch
+// at some point of the step when one of them is swept
+void CollisionGrid::findContacts(std::vector<CollisionContact>& contacts)
+{
+	contacts.clear();
+	mEntries.clear();
+	mStats = Stats();
+
+	// Enter every collider into each cell its box touches
+	for (UINT i = 0; i < (UINT)mColliders.size(); ++i)
+	{
+		const Aabb& aabb = mColliders[i].aabb;
+		const int minX = getCell(aabb.min.x), maxX = getCell(aabb.max.x);
+		const int minY = getCell(aabb.min.y), maxY = getCell(aabb.max.y);
+		const int minZ = getCell(aabb.min.z), maxZ = getCell(aabb.max.z);
+
+		for (int z = minZ; z <= maxZ; ++z)
+		{
+			for (int y = minY; y <= maxY; ++y)
+			{
+				for (int x = minX; x <= maxX; ++x)
+				{
+					CellEntry entry;
+					entry.key = makeCellKey(x, y, z);
+					entry.collider = i;
+					mEntries.push_back(entry);
+				}
+			}
+		}
+	}
+
+	std::sort(mEntries.begin(), mEntries.end(), [](const CellEntry& a, const CellEntry& b)
+	{
+		return a.key < b.key || (a.key == b.key && a.collider < b.collider);
+	});
+
+	// Pair up the colliders of each cell
+	size_t first = 0;
+	while (first < mEntries.size())
+	{
+		const UINT64 key = mEntries[first].key;
+		size_t last = first + 1;
+		while (last < mEntries.size() && mEntries[last].key == key)
+			++last;
+
+		for (size_t i = first; i < last; ++i)
+		{
+			const Collider& a = mColliders[mEntries[i].collider];
+			for (size_t j = i + 1; j < last; ++j)
+			{
+				const Collider& b = mColliders[mEntries[j].collider];
+				if (!a.aabb.overlaps(b.aabb))
+					continue;
+
+				// Only the cell holding the minimum corner of the overlap reports the pair
+				const float overlapX = std::max(a.aabb.min.x, b.aabb.min.x);
+				const float overlapY = std::max(a.aabb.min.y, b.aabb.min.y);
+				const float overlapZ = std::max(a.aabb.min.z, b.aabb.min.z);
+				if (makeCellKey(getCell(overlapX), getCell(overlapY), getCell(overlapZ)) != key)
+					continue;
+
+				mStats.CandidatePairs++;
+
+				CollisionContact contact;
+				contact.first = a.collidable;
+				contact.second = b.collidable;
+				contact.time = 1.0f;
+				contact.separation = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+				if (a.swept || b.swept)
+				{
+					mStats.SweptPairs++;
+					if (sweep(a, b, contact.time))
+					{
+						if (contact.time <= 0.0f)
+							contact.separation = getSeparation(a, b);
+						contacts.push_back(contact);
+					}
+				}
+				else if (a.box.Intersects(b.box))
+				{
+					contacts.push_back(contact);
+				}
+			}
+		}
+
+		first = last;
+	}
+
+	mStats.Colliders = (UINT)mColliders.size();
+	mStats.CellEntries = (UINT)mEntries.size();
+	mStats.Contacts = (UINT)contacts.size();
+}
+
+// Returns the number of colliders added since the last clear()
+size_t CollisionGrid::getColliderCount() const
+{
+	return mColliders.size();
+}
+
+// Returns the work done by the last findContacts()
+const CollisionGrid::Stats& CollisionGrid::getStats() const
+{
+	return mStats;
+}
+
+// Returns the oriented box of a local space box under a world transform; the transform may scale
+// each axis differently, but must not shear
+BoundingOrientedBox CollisionGrid::makeOrientedBox(const BoundingBox& box, const XMFLOAT4X4& world)
+{
+	const XMMATRIX m = XMLoadFloat4x4(&world);
+
+	// The rows of a scale-rotate-translate matrix are the scaled box axes
+	const XMVECTOR scaleX = XMVector3Length(m.r[0]);
+	const XMVECTOR scaleY = XMVector3Length(m.r[1]);
+	const XMVECTOR scaleZ = XMVector3Length(m.r[2]);
+
+	XMMATRIX rotation = XMMatrixIdentity();
+	rotation.r[0] = XMVector3Normalize(m.r[0]);
+	rotation.r[1] = XMVector3Normalize(m.r[1]);
+	rotation.r[2] = XMVector3Normalize(m.r[2]);
+
+	BoundingOrientedBox oriented;
+	XMStoreFloat3(&oriented.Center, XMVector3TransformCoord(XMLoadFloat3(&box.Center), m));
+	oriented.Extents.x = box.Extents.x * XMVectorGetX(scaleX);
+	oriented.Extents.y = box.Extents.y * XMVectorGetX(scaleY);
+	oriented.Extents.z = box.Extents.z * XMVectorGetX(scaleZ);
+	XMStoreFloat4(&oriented.Orientation, XMQuaternionRotationMatrix(rotation));
+	return oriented;
+}
+
+// Returns the shortest move of b along a world axis that stops the end of step boxes of a and b overlapping;
+// zero if they no longer overlap
+XMFLOAT3 CollisionGrid::getSeparation(const Collider& a, const Collider& b)
+{
+	const float aMin[3] = { a.endAabb.min.x, a.endAabb.min.y, a.endAabb.min.z };
+	const float aMax[3] = { a.endAabb.max.x, a.endAabb.max.y, a.endAabb.max.z };
+	const float bMin[3] = { b.endAabb.min.x, b.endAabb.min.y, b.endAabb.min.z };
+	const float bMax[3] = { b.endAabb.max.x, b.endAabb.max.y, b.endAabb.max.z };
+
+	int axis = -1;
+	float depth = FLT_MAX;
+	for (int i = 0; i < 3; ++i)
+	{
+		const float overlap = std::min(aMax[i], bMax[i]) - std::max(aMin[i], bMin[i]);
+		if (overlap <= 0.0f)
+			return XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+		if (overlap < depth)
+		{
+			axis = i;
+			depth = overlap;
+		}
+	}
+
+	// Push b out on the side its center is on; coincident centers push along the positive axis
+	if (bMin[axis] + bMax[axis] < aMin[axis] + aMax[axis])
+		depth = -depth;
+
+	float separation[3] = { 0.0f, 0.0f, 0.0f };
+	separation[axis] = depth;
+	return XMFLOAT3(separation[0], separation[1], separation[2]);
+}
+
+// Returns the index of the cell a world coordinate falls in
+int CollisionGrid::getCell(float coordinate) const
+{
+	const float cell = std::floor(coordinate * mInverseCellSize);
+	return (int)std::min(std::max(cell, (float)-CellBias), (float)(CellBias - 1));
+}
+
+// Finds the first time in [0, 1] at which two colliders moving along their displacements touch.
+// The swept boxes bound the interval; the oriented boxes are then stepped through it.
+bool CollisionGrid::sweep(const Collider& a, const Collider& b, float& time) const
+{
+	auto axis = [](const XMFLOAT3& v, int i) { return i == 0 ? v.x : (i == 1 ? v.y : v.z); };
+
+	// Slab test of a's start box moving by the relative displacement against b's start box
+	float first = 0.0f;
+	float last = 1.0f;
+	for (int i = 0; i < 3; ++i)
+	{
+		const float aMin = axis(a.endAabb.min, i) - axis(a.displacement, i);
+		const float aMax = axis(a.endAabb.max, i) - axis(a.displacement, i);
+		const float bMin = axis(b.endAabb.min, i) - axis(b.displacement, i);
+		const float bMax = axis(b.endAabb.max, i) - axis(b.displacement, i);
+		const float move = axis(a.displacement, i) - axis(b.displacement, i);
+
+		if (move == 0.0f)
+		{
+			if (aMax < bMin || bMax < aMin)
+				return false;
+			continue;
+		}
+
+		const float enter = (move > 0.0f ? bMin - aMax : bMax - aMin) / move;
+		const float exit = (move > 0.0f ? bMax - aMin : bMin - aMax) / move;
+		first = std::max(first, enter);
+		last = std::min(last, exit);
+		if (first > last)
+			return false;
+	}
+
+	const XMVECTOR displacementA = XMLoadFloat3(&a.displacement);
+	const XMVECTOR displacementB = XMLoadFloat3(&b.displacement);
+	const float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(displacementA, displacementB)));
+
+	// Moving together, the boxes keep the same relative placement for the whole step
+	if (distance == 0.0f)
+	{
+		time = first;
+		return a.box.Intersects(b.box);
+	}
+
+	// Boxes closer than a thousandth of their smallest extent count as touching
+	float extent = FLT_MAX;
+	for (const BoundingOrientedBox* box : { &a.box, &b.box })
+	{
+		for (float e : { box->Extents.x, box->Extents.y, box->Extents.z })
+		{
+			if (e > 0.0f)
+				extent = std::min(extent, e);
+		}
+	}
+	const float slop = extent == FLT_MAX ? 0.0f : extent * 1e-3f;
+
+	// Conservative advancement: move both boxes to t, then on by as much as a separating axis proves is free
+	const XMVECTOR motion = XMVectorSubtract(displacementB, displacementA);
+	BoundingOrientedBox boxA = a.box;
+	BoundingOrientedBox boxB = b.box;
+	float t = first;
+	for (int i = 0; i < MaxSweepSteps; ++i)
+	{
+		const XMVECTOR back = XMVectorReplicate(1.0f - t);
+		XMStoreFloat3(&boxA.Center, XMVectorSubtract(XMLoadFloat3(&a.box.Center), XMVectorMultiply(displacementA, back)));
+		XMStoreFloat3(&boxB.Center, XMVectorSubtract(XMLoadFloat3(&b.box.Center), XMVectorMultiply(displacementB, back)));
+
+		const float advance = getSafeAdvance(boxA, boxB, motion, slop);
+		if (advance <= 0.0f)
+		{
+			time = t;
+			return true;
+		}
+
+		t += advance;
+		if (t > last)
+			return false;
+	}
+
+	// Still closing in after every iteration: a grazing pair this close is reported touching rather than missed
+	time = t;
+	return true;
+}
+
+// Returns how much of the step box b can move by motion relative to box a before a separating axis of the two
+// stops separating them: 0 when they are within slop of each other, FLT_MAX when a separating axis never closes.
+// Both boxes only translate, so along every axis the gap between their projections closes linearly.
+float CollisionGrid::getSafeAdvance(const BoundingOrientedBox& a, const BoundingOrientedBox& b, FXMVECTOR motion, float slop)
+{
+	const XMMATRIX rotationA = XMMatrixRotationQuaternion(XMLoadFloat4(&a.Orientation));
+	const XMMATRIX rotationB = XMMatrixRotationQuaternion(XMLoadFloat4(&b.Orientation));
+	const XMMATRIX toLocalA = XMMatrixTranspose(rotationA);
+	const XMMATRIX toLocalB = XMMatrixTranspose(rotationB);
+	const XMVECTOR extentsA = XMLoadFloat3(&a.Extents);
+	const XMVECTOR extentsB = XMLoadFloat3(&b.Extents);
+	const XMVECTOR offset = XMVectorSubtract(XMLoadFloat3(&b.Center), XMLoadFloat3(&a.Center));
+
+	// The face normals of both boxes and the cross products of their edges
+	XMVECTOR axes[15];
+	int axisCount = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		axes[axisCount++] = rotationA.r[i];
+		axes[axisCount++] = rotationB.r[i];
+	}
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			const XMVECTOR cross = XMVector3Cross(rotationA.r[i], rotationB.r[j]);
+			if (XMVectorGetX(XMVector3LengthSq(cross)) > 1e-6f)
+				axes[axisCount++] = XMVector3Normalize(cross);
+		}
+	}
+
+	float advance = 0.0f;
+	for (int i = 0; i < axisCount; ++i)
+	{
+		const XMVECTOR axis = axes[i];
+		const float radiusA = XMVectorGetX(XMVector3Dot(extentsA, XMVectorAbs(XMVector3TransformNormal(axis, toLocalA))));
+		const float radiusB = XMVectorGetX(XMVector3Dot(extentsB, XMVectorAbs(XMVector3TransformNormal(axis, toLocalB))));
+		const float distance = XMVectorGetX(XMVector3Dot(offset, axis));
+		const float gap = fabsf(distance) - radiusA - radiusB;
+		if (gap <= slop)
+			continue;
+
+		// Positive when b moves towards a along the axis
+		const float closing = -XMVectorGetX(XMVector3Dot(motion, axis)) * (distance < 0.0f ? -1.0f : 1.0f);
+		if (closing <= 0.0f)
+			return FLT_MAX;
+		advance = std::max(advance, gap / closing);
+	}
+	return advance;
+}
+
+// Responds to contacts found for a step: earliest first, each collider of a contact within the step is moved back
+// to where it first touched something, and pairs already overlapping at the start are pushed apart.
+// rewound receives the colliders moved back; returns true if anything moved.
+bool CollisionGrid::resolveContacts(std::vector<CollisionContact>& contacts, std::vector<Collidable*>& rewound)
+{
+	// Earliest contacts first, so a collider in several stops at the first thing it hit
+	std::sort(contacts.begin(), contacts.end(), [](const CollisionContact& a, const CollisionContact& b)
+	{
+		return a.time < b.time;
+	});
+
+	rewound.clear();
+	bool moved = false;
+	for (const CollisionContact& contact : contacts)
+	{
+		if (contact.time >= 1.0f)
+			break;
+
+		// Already overlapping when the step began: moving back would keep them stuck, so push them apart
+		if (contact.time <= 0.0f)
+		{
+			const XMFLOAT3& separation = contact.separation;
+			contact.first->displace(-0.5f * separation.x, -0.5f * separation.y, -0.5f * separation.z);
+			contact.second->displace(0.5f * separation.x, 0.5f * separation.y, 0.5f * separation.z);
+			moved = true;
+			continue;
+		}
+
+		for (Collidable* collidable : { contact.first, contact.second })
+		{
+			if (std::find(rewound.begin(), rewound.end(), collidable) == rewound.end())
+			{
+				collidable->rewind(contact.time);
+				rewound.push_back(collidable);
+				moved = true;
+			}
+		}
+	}
+	return moved;
+}
+
+// Packs the coordinates of a cell into one key
+UINT64 CollisionGrid::makeCellKey(int x, int y, int z)
+{
+	const UINT64 mask = (1ull << CellBits) - 1;
+	return (((UINT64)(x + CellBias) & mask) << (2 * CellBits))
+		| (((UINT64)(y + CellBias) & mask) << CellBits)
+		| ((UINT64)(z + CellBias) & mask);
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "DynamicAabbTree.hpp"
+
+#include <vector>
+
+// What the grid and the collision response need of a collider: the motion of
+// its last step, moving it back along that motion, and pushing it aside.
+class Collidable
+{
+public:
+	virtual							~Collidable() {}
+
+	virtual DirectX::XMFLOAT3		getDisplacement() const = 0;
+	virtual void					rewind(float time) = 0;
+	virtual void					displace(float x, float y, float z) = 0;
+};
+
+// Two colliders whose collision boxes overlap, and the fraction of the step
+// at which they first touched; contacts between discrete colliders are at 1.
+// A swept pair already overlapping at the start of the step is at 0 and
+// cannot be moved back to where it touched, so it carries the shortest move
+// of second away from first that separates their boxes instead.
+struct CollisionContact
+{
+	Collidable*						first;
+	Collidable*						second;
+	float							time;
+	DirectX::XMFLOAT3				separation;
+};
+
+// Broad and narrow phase collision between colliders on a uniform grid.
+// Every collider is entered into each world cell its bounding box touches,
+// keyed by the packed cell coordinates; sorting the entries by key puts the
+// colliders of one cell next to each other, so candidate pairs only come from
+// colliders sharing a cell, never from the whole set. A pair sharing several
+// cells is only reported by the cell holding the minimum corner of the overlap
+// of their boxes. Candidates whose boxes overlap are tested exactly with their
+// oriented boxes.
+// Fast colliders are added with their displacement over the step and enter
+// the grid with the box swept along it, so they cannot tunnel through others
+// between two steps. Only pairs involving a swept collider pay for the
+// continuous test: the time interval in which the swept boxes overlap is found
+// with a slab test, then the oriented boxes are advanced through it by
+// conservative advancement, each iteration moving them on as far as one of
+// their separating axes proves is free, until no axis separates them.
+class CollisionGrid
+{
+public:
+	// Most conservative advancement iterations per swept pair; a pair still closing in after that many is
+	// reported touching at the last time reached, so a contact is never skipped
+	static const int				MaxSweepSteps = 64;
+
+	// Work done by the last findContacts()
+	struct Stats
+	{
+		UINT						Colliders = 0;
+		UINT						CellEntries = 0;
+		UINT						CandidatePairs = 0;
+		UINT						SweptPairs = 0;
+		UINT						Contacts = 0;
+	};
+
+
+public:
+	explicit						CollisionGrid(float cellSize = 4.0f);
+
+	void							setCellSize(float cellSize);
+	float							getCellSize() const;
+
+	void							clear();
+	void							add(Collidable* collidable, const DirectX::BoundingOrientedBox& box);
+	void							add(Collidable* collidable, const DirectX::BoundingOrientedBox& box, const DirectX::XMFLOAT3& displacement);
+	void							findContacts(std::vector<CollisionContact>& contacts);
+
+	static bool						resolveContacts(std::vector<CollisionContact>& contacts, std::vector<Collidable*>& rewound);
+
+	size_t							getColliderCount() const;
+	const Stats&					getStats() const;
+
+	static DirectX::BoundingOrientedBox	makeOrientedBox(const DirectX::BoundingBox& box, const DirectX::XMFLOAT4X4& world);
+
+
+private:
+	struct Collider
+	{
+		Collidable*					collidable;
+		DirectX::BoundingOrientedBox	box;
+		DirectX::XMFLOAT3			displacement;
+		Aabb						endAabb;
+		Aabb						aabb;
+		bool						swept;
+	};
+
+	struct CellEntry
+	{
+		UINT64						key;
+		UINT						collider;
+	};
+
+
+private:
+	int								getCell(float coordinate) const;
+	bool							sweep(const Collider& a, const Collider& b, float& time) const;
+	static DirectX::XMFLOAT3		getSeparation(const Collider& a, const Collider& b);
+	static float					getSafeAdvance(const DirectX::BoundingOrientedBox& a, const DirectX::BoundingOrientedBox& b,
+										DirectX::FXMVECTOR motion, float slop);
+	static UINT64					makeCellKey(int x, int y, int z);
+
+
+private:
+	std::vector<Collider>			mColliders;
+	std::vector<CellEntry>			mEntries;
+	float							mCellSize;
+	float							mInverseCellSize;
+	Stats							mStats;
+};
@@ -10,4 +10,85 @@ Command::Command()
 {
 }
 
+// Constructs an empty action
+CommandAction::CommandAction()
+	: mInvoker(nullptr)
+	, mManager(nullptr)
+{
+}
 
+// Copies the stored callable into this action's own buffer
+CommandAction::CommandAction(const CommandAction& other)
+	: mInvoker(other.mInvoker)
+	, mManager(other.mManager)
+{
+	if (mManager != nullptr)
+		mManager(Operation::Copy, mStorage, const_cast<unsigned char*>(other.mStorage));
+}
+
+// Moves the stored callable into this action's own buffer, leaving the source empty
+CommandAction::CommandAction(CommandAction&& other) noexcept
+	: mInvoker(other.mInvoker)
+	, mManager(other.mManager)
+{
+	if (mManager != nullptr)
+		mManager(Operation::Move, mStorage, other.mStorage);
+	other.reset();
+}
+
+// Destructor
+CommandAction::~CommandAction()
+{
+	reset();
+}
+
+// Replaces the stored callable with a copy of another action's
+CommandAction& CommandAction::operator=(const CommandAction& other)
+{
+	if (this != &other)
+	{
+		reset();
+		if (other.mManager != nullptr)
+			other.mManager(Operation::Copy, mStorage, const_cast<unsigned char*>(other.mStorage));
+		mInvoker = other.mInvoker;
+		mManager = other.mManager;
+	}
+	return *this;
+}
+
+// Replaces the stored callable with another action's, leaving the source empty
+CommandAction& CommandAction::operator=(CommandAction&& other) noexcept
+{
+	if (this != &other)
+	{
+		reset();
+		if (other.mManager != nullptr)
+			other.mManager(Operation::Move, mStorage, other.mStorage);
+		mInvoker = other.mInvoker;
+		mManager = other.mManager;
+		other.reset();
+	}
+	return *this;
+}
+
+// Invokes the stored callable on a scene node
+void CommandAction::operator()(SceneNode& node, const GameTimer& gt) const
+{
+	assert(mInvoker != nullptr);
+	mInvoker(mStorage, node, gt);
+}
+
+// Returns true if the action holds a callable
+CommandAction::operator bool() const
+{
+	return mInvoker != nullptr;
+}
+
+// Destroys the stored callable, if any
+void CommandAction::reset()
+{
+	if (mManager != nullptr)
+		mManager(Operation::Destroy, mStorage, nullptr);
+	mInvoker = nullptr;
+	mManager = nullptr;
+}
@@ -4,24 +4,117 @@
 
 #include "../../Common/d3dApp.h"
 
-#include <functional>
 #include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 class SceneNode;
 class Game;
 
+// Type-erased callable for command actions. The callable lives in a fixed
+// in-place buffer, so creating, copying, queueing and popping commands never
+// touches the heap; a functor that does not fit is a compile-time error.
+// Moving never throws, so vectors of commands move rather than copy them.
+class CommandAction
+{
+public:
+	static const std::size_t Capacity = 48;
+
+
+public:
+	CommandAction();
+	CommandAction(const CommandAction& other);
+	CommandAction(CommandAction&& other) noexcept;
+	~CommandAction();
+
+	template <typename Function, typename = typename std::enable_if<
+		!std::is_same<typename std::decay<Function>::type, CommandAction>::value>::type>
+	CommandAction(Function&& fn);
+
+	CommandAction&		operator=(const CommandAction& other);
+	CommandAction&		operator=(CommandAction&& other) noexcept;
+
+	void				operator()(SceneNode& node, const GameTimer& gt) const;
+	explicit			operator bool() const;
+
+private:
+	enum class Operation
+	{
+		Copy,
+		Move,
+		Destroy,
+	};
+
+	typedef void(*Invoker)(const void* storage, SceneNode& node, const GameTimer& gt);
+	typedef void(*Manager)(Operation operation, void* destination, void* source);
+
+	template <typename Function>
+	static void			invoke(const void* storage, SceneNode& node, const GameTimer& gt);
+	template <typename Function>
+	static void			manage(Operation operation, void* destination, void* source);
+
+	void				reset();
+
+
+private:
+	// No stricter than operator new guarantees, so commands can live in heap arrays
+	alignas(std::max_align_t) unsigned char	mStorage[Capacity];
+	Invoker						mInvoker;
+	Manager						mManager;
+};
+
 struct Command
 {
 	Command();
 
-	std::function<void(SceneNode&, const GameTimer&)>	action;
+	CommandAction								action;
 	unsigned int								category;
 };
 
+static_assert(std::is_nothrow_move_constructible<Command>::value, "Command queues rely on moving commands without copies");
+
+template <typename Function, typename>
+CommandAction::CommandAction(Function&& fn)
+	: mInvoker(&invoke<typename std::decay<Function>::type>)
+	, mManager(&manage<typename std::decay<Function>::type>)
+{
+	typedef typename std::decay<Function>::type Stored;
+	static_assert(sizeof(Stored) <= Capacity, "Command action does not fit in CommandAction::Capacity; capture less state");
+	static_assert(alignof(Stored) <= alignof(std::max_align_t), "Command action is over-aligned for the CommandAction buffer");
+	static_assert(std::is_nothrow_move_constructible<Stored>::value, "Command action must not throw when moved");
+
+	new (mStorage) Stored(std::forward<Function>(fn));
+}
+
+template <typename Function>
+void CommandAction::invoke(const void* storage, SceneNode& node, const GameTimer& gt)
+{
+	(*static_cast<const Function*>(storage))(node, gt);
+}
+
+template <typename Function>
+void CommandAction::manage(Operation operation, void* destination, void* source)
+{
+	switch (operation)
+	{
+	case Operation::Copy:
+		new (destination) Function(*static_cast<const Function*>(source));
+		break;
+	case Operation::Move:
+		new (destination) Function(std::move(*static_cast<Function*>(source)));
+		break;
+	case Operation::Destroy:
+		static_cast<Function*>(destination)->~Function();
+		break;
+	}
+}
+
 template <typename GameObject, typename Function>
-std::function<void(SceneNode&, const GameTimer&)> derivedAction(Function fn)
+CommandAction derivedAction(Function fn)
 {
-	return [=](SceneNode& node, const GameTimer& gt) //cannot convert from 'derived Action::<lambda ae70999ce770862bd1b8049a4852b029>' to 'std::function<void (SceneNode &,const GameTimer &)>
+	return [=](SceneNode& node, const GameTimer& gt)
 	{
 		// Check if cast is safe
 		assert(dynamic_cast<GameObject*>(&node) != nullptr);
@@ -5,24 +5,58 @@
 #include "CommandQueue.hpp"
 #include "SceneNode.hpp"
 
-// Adds a new command to the end of the command queue
+// Constructor, reserves the ring buffer
+CommandQueue::CommandQueue(std::size_t capacity)
+	: mBuffer(capacity > 0 ? capacity : 1)
+	, mHead(0)
+	, mCount(0)
+{
+}
+
+// Adds a copy of a command to the end of the command queue
 void CommandQueue::push(const Command& command)
 {
-	mQueue.push(command);
+	if (mCount == mBuffer.size())
+		grow();
+
+	mBuffer[(mHead + mCount) % mBuffer.size()] = command;
+	mCount++;
+}
+
+// Moves a command to the end of the command queue
+void CommandQueue::push(Command&& command)
+{
+	if (mCount == mBuffer.size())
+		grow();
+
+	mBuffer[(mHead + mCount) % mBuffer.size()] = std::move(command);
+	mCount++;
 }
 
 // Removes and returns the first command in the queue
 Command CommandQueue::pop()
 {
-	Command command = mQueue.front();
-	mQueue.pop();
+	assert(mCount > 0);
+
+	Command command = std::move(mBuffer[mHead]);
+	mHead = (mHead + 1) % mBuffer.size();
+	mCount--;
 	return command;
 }
 
 //Checks if the command queue is empty
 bool CommandQueue::isEmpty() const
 {
-	return mQueue.empty();
+	return mCount == 0;
 }
 
+// Doubles the ring buffer when it is full; only happens when more commands arrive in a frame than ever before
+void CommandQueue::grow()
+{
+	std::vector<Command> buffer(mBuffer.size() * 2);
+	for (std::size_t i = 0; i < mCount; ++i)
+		buffer[i] = std::move(mBuffer[(mHead + i) % mBuffer.size()]);
 
+	mBuffer.swap(buffer);
+	mHead = 0;
+}
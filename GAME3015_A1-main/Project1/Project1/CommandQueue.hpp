@@ -1,20 +1,30 @@
-
 #pragma once
 #include "Command.hpp"
 
-#include <queue>
+#include <vector>
 
 
+// FIFO of commands stored in a ring buffer that is allocated once up front,
+// so pushing and popping only move commands in place.
 class CommandQueue
 {
 public:
+	explicit					CommandQueue(std::size_t capacity = 64);
+
 	void						push(const Command& command);
+	void						push(Command&& command);
 	Command						pop();
 	bool						isEmpty() const;
 
 
 private:
-	std::queue<Command>			mQueue;
+	void						grow();
+
+
+private:
+	std::vector<Command>		mBuffer;
+	std::size_t					mHead;
+	std::size_t					mCount;
 };
 
 
@@ -0,0 +1,323 @@
+//***************************************************************************************
+// ComponentStore.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "ComponentStore.hpp"
+#include "RenderBatcher.hpp"
+
+#include <cassert>
+#include <cstring>
+
+using namespace DirectX;
+
+// Constructor
+ComponentStore::ComponentStore()
+	: mArchetypes()
+	, mSlots()
+	, mFreeSlots()
+	, mCount(0)
+{
+}
+
+// Creates an object with default valued components: at the origin, unrotated, unit scale, at rest,
+// without a render item, and in no category
+ComponentStore::Handle ComponentStore::create(unsigned int components)
+{
+	Handle handle;
+	if (!mFreeSlots.empty())
+	{
+		handle.index = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else
+	{
+		handle.index = (UINT)mSlots.size();
+		Slot slot;
+		slot.generation = 0;
+		mSlots.push_back(slot);
+	}
+	handle.generation = mSlots[handle.index].generation;
+
+	Slot& slot = mSlots[handle.index];
+	slot.archetype = getArchetype(components);
+	slot.row = appendRow(slot.archetype, handle);
+
+	mCount++;
+	return handle;
+}
+
+// Destroys an object; its handle, and any copy of it, goes stale
+void ComponentStore::destroy(Handle handle)
+{
+	if (!isAlive(handle))
+		return;
+
+	Slot& slot = mSlots[handle.index];
+	removeRow(slot.archetype, slot.row);
+	slot.generation++;
+	mFreeSlots.push_back(handle.index);
+	mCount--;
+}
+
+// Returns true if the handle refers to an object that has not been destroyed
+bool ComponentStore::isAlive(Handle handle) const
+{
+	return handle.index < mSlots.size() && mSlots[handle.index].generation == handle.generation;
+}
+
+// Adds and removes components so the object has exactly the given ones; components it keeps keep their values
+void ComponentStore::setComponents(Handle handle, unsigned int components)
+{
+	assert(isAlive(handle));
+	Slot& slot = mSlots[handle.index];
+	const UINT from = slot.archetype;
+	const UINT to = getArchetype(components);
+	if (from == to)
+		return;
+
+	const UINT fromRow = slot.row;
+	const UINT toRow = appendRow(to, handle);
+
+	// getArchetype may have grown mArchetypes, so the archetypes are looked up after it
+	Archetype& source = mArchetypes[from];
+	Archetype& destination = mArchetypes[to];
+	const unsigned int kept = source.components & destination.components;
+
+	if (kept & Component::Transform)
+		destination.transforms[toRow] = source.transforms[fromRow];
+	if (kept & Component::Velocity)
+		destination.velocities[toRow] = source.velocities[fromRow];
+	if (kept & Component::Render)
+		destination.renderItems[toRow] = source.renderItems[fromRow];
+	if (kept & Component::Category)
+		destination.categories[toRow] = source.categories[fromRow];
+
+	removeRow(from, fromRow);
+	slot.archetype = to;
+	slot.row = toRow;
+}
+
+// Returns the components of an object
+unsigned int ComponentStore::getComponents(Handle handle) const
+{
+	assert(isAlive(handle));
+	return mArchetypes[mSlots[handle.index].archetype].components;
+}
+
+// Destroys every object, making all handles stale
+void ComponentStore::clear()
+{
+	for (Archetype& archetype : mArchetypes)
+	{
+		for (const Handle& handle : archetype.handles)
+		{
+			mSlots[handle.index].generation++;
+			mFreeSlots.push_back(handle.index);
+		}
+
+		archetype.handles.clear();
+		archetype.transforms.clear();
+		archetype.velocities.clear();
+		archetype.renderItems.clear();
+		archetype.categories.clear();
+	}
+	mCount = 0;
+}
+
+// Returns the transform of an object, or nullptr if it has none
+TransformComponent* ComponentStore::getTransform(Handle handle)
+{
+	assert(isAlive(handle));
+	const Slot& slot = mSlots[handle.index];
+	Archetype& archetype = mArchetypes[slot.archetype];
+	return (archetype.components & Component::Transform) ? &archetype.transforms[slot.row] : nullptr;
+}
+
+// Returns the velocity of an object, or nullptr if it has none
+XMFLOAT3* ComponentStore::getVelocity(Handle handle)
+{
+	assert(isAlive(handle));
+	const Slot& slot = mSlots[handle.index];
+	Archetype& archetype = mArchetypes[slot.archetype];
+	return (archetype.components & Component::Velocity) ? &archetype.velocities[slot.row] : nullptr;
+}
+
+// Returns the render item of an object, or nullptr if it has no render component
+RenderItem** ComponentStore::getRenderItem(Handle handle)
+{
+	assert(isAlive(handle));
+	const Slot& slot = mSlots[handle.index];
+	Archetype& archetype = mArchetypes[slot.archetype];
+	return (archetype.components & Component::Render) ? &archetype.renderItems[slot.row] : nullptr;
+}
+
+// Returns the category of an object, or nullptr if it has none
+unsigned int* ComponentStore::getCategory(Handle handle)
+{
+	assert(isAlive(handle));
+	const Slot& slot = mSlots[handle.index];
+	Archetype& archetype = mArchetypes[slot.archetype];
+	return (archetype.components & Component::Category) ? &archetype.categories[slot.row] : nullptr;
+}
+
+// Moves every object with a transform and a velocity by one step
+void ComponentStore::integrate(float dt)
+{
+	forEach(Component::Transform | Component::Velocity, [dt](Columns& columns)
+	{
+		for (size_t i = 0; i < columns.count; ++i)
+		{
+			TransformComponent& transform = columns.transforms[i];
+			const XMFLOAT3& velocity = columns.velocities[i];
+
+			transform.previousPosition = transform.position;
+			transform.position.x += velocity.x * dt;
+			transform.position.y += velocity.y * dt;
+			transform.position.z += velocity.z * dt;
+		}
+	});
+}
+
+// Writes the world matrix of every rendered object, blended between its last two positions, into its render item;
+// items whose matrix changed are collected for upload
+void ComponentStore::interpolate(float alpha, std::vector<RenderItem*>& changed)
+{
+	forEach(Component::Transform | Component::Render, [alpha, &changed](Columns& columns)
+	{
+		for (size_t i = 0; i < columns.count; ++i)
+		{
+			RenderItem* item = columns.renderItems[i];
+			if (item == nullptr)
+				continue;
+
+			const TransformComponent& transform = columns.transforms[i];
+			const XMVECTOR position = XMVectorLerp(XMLoadFloat3(&transform.previousPosition), XMLoadFloat3(&transform.position), alpha);
+
+			// Same composition as the scene graph's transforms: scaling, rotation about x, y, then z, translation
+			XMFLOAT4X4 world;
+			XMStoreFloat4x4(&world,
+				XMMatrixScaling(transform.scale.x, transform.scale.y, transform.scale.z) *
+				XMMatrixRotationX(transform.rotation.x) *
+				XMMatrixRotationY(transform.rotation.y) *
+				XMMatrixRotationZ(transform.rotation.z) *
+				XMMatrixTranslationFromVector(position));
+
+			if (memcmp(&world, &item->World, sizeof(XMFLOAT4X4)) != 0)
+			{
+				item->World = world;
+				changed.push_back(item);
+			}
+		}
+	});
+}
+
+// Queues the render item of every rendered object
+void ComponentStore::draw(RenderBatcher& batcher)
+{
+	forEach(Component::Render, [&batcher](Columns& columns)
+	{
+		for (size_t i = 0; i < columns.count; ++i)
+		{
+			if (columns.renderItems[i] != nullptr)
+				batcher.submit(columns.renderItems[i]);
+		}
+	});
+}
+
+// Returns the number of live objects
+size_t ComponentStore::size() const
+{
+	return mCount;
+}
+
+// Returns the number of component combinations seen so far
+size_t ComponentStore::getArchetypeCount() const
+{
+	return mArchetypes.size();
+}
+
+// Returns the index of the archetype with exactly the given components, creating it on first use
+UINT ComponentStore::getArchetype(unsigned int components)
+{
+	for (UINT i = 0; i < (UINT)mArchetypes.size(); ++i)
+	{
+		if (mArchetypes[i].components == components)
+			return i;
+	}
+
+	Archetype archetype;
+	archetype.components = components;
+	mArchetypes.push_back(std::move(archetype));
+	return (UINT)mArchetypes.size() - 1;
+}
+
+// Appends a row of default valued components to an archetype and returns it
+UINT ComponentStore::appendRow(UINT index, Handle handle)
+{
+	Archetype& archetype = mArchetypes[index];
+	archetype.handles.push_back(handle);
+
+	if (archetype.components & Component::Transform)
+	{
+		TransformComponent transform;
+		transform.position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+		transform.previousPosition = transform.position;
+		transform.rotation = XMFLOAT3(0.0f, 0.0f, 0.0f);
+		transform.scale = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		archetype.transforms.push_back(transform);
+	}
+	if (archetype.components & Component::Velocity)
+		archetype.velocities.push_back(XMFLOAT3(0.0f, 0.0f, 0.0f));
+	if (archetype.components & Component::Render)
+		archetype.renderItems.push_back(nullptr);
+	if (archetype.components & Component::Category)
+		archetype.categories.push_back(Category::None);
+
+	return (UINT)archetype.handles.size() - 1;
+}
+
+// Removes a row by moving the archetype's last row into it
+void ComponentStore::removeRow(UINT index, UINT row)
+{
+	Archetype& archetype = mArchetypes[index];
+	const UINT last = (UINT)archetype.handles.size() - 1;
+
+	if (row != last)
+	{
+		archetype.handles[row] = archetype.handles[last];
+		if (archetype.components & Component::Transform)
+			archetype.transforms[row] = archetype.transforms[last];
+		if (archetype.components & Component::Velocity)
+			archetype.velocities[row] = archetype.velocities[last];
+		if (archetype.components & Component::Render)
+			archetype.renderItems[row] = archetype.renderItems[last];
+		if (archetype.components & Component::Category)
+			archetype.categories[row] = archetype.categories[last];
+
+		mSlots[archetype.handles[row].index].row = row;
+	}
+
+	archetype.handles.pop_back();
+	if (archetype.components & Component::Transform)
+		archetype.transforms.pop_back();
+	if (archetype.components & Component::Velocity)
+		archetype.velocities.pop_back();
+	if (archetype.components & Component::Render)
+		archetype.renderItems.pop_back();
+	if (archetype.components & Component::Category)
+		archetype.categories.pop_back();
+}
+
+// Returns pointers to the columns of an archetype; columns of components it lacks are nullptr
+ComponentStore::Columns ComponentStore::getColumns(Archetype& archetype)
+{
+	Columns columns;
+	columns.components = archetype.components;
+	columns.count = archetype.handles.size();
+	columns.handles = archetype.handles.data();
+	columns.transforms = (archetype.components & Component::Transform) ? archetype.transforms.data() : nullptr;
+	columns.velocities = (archetype.components & Component::Velocity) ? archetype.velocities.data() : nullptr;
+	columns.renderItems = (archetype.components & Component::Render) ? archetype.renderItems.data() : nullptr;
+	columns.categories = (archetype.components & Component::Category) ? archetype.categories.data() : nullptr;
+	return columns;
+}
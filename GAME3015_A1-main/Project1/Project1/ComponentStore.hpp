@@ -0,0 +1,135 @@
+#pragma once
+#include "RenderItem.hpp"
+#include "Category.hpp"
+
+#include <vector>
+
+class RenderBatcher;
+
+// Components an object of the store can have, one bit each
+namespace Component
+{
+	enum Type
+	{
+		None = 0,
+		Transform = 1 << 0,
+		Velocity = 1 << 1,
+		Render = 1 << 2,
+		Category = 1 << 3,
+	};
+}
+
+// Position, rotation, and scale of an object without a parent; previousPosition
+// is the position of the last step, which the render item is blended from
+struct TransformComponent
+{
+	DirectX::XMFLOAT3				position;
+	DirectX::XMFLOAT3				previousPosition;
+	DirectX::XMFLOAT3				rotation;
+	DirectX::XMFLOAT3				scale;
+};
+
+// Storage for gameplay objects that need no hierarchy, kept next to the scene
+// graph instead of as SceneNode subclasses. Objects with the same set of
+// components share an archetype, which stores each component in its own packed
+// column; a system visits the archetypes having the components it needs and
+// loops straight over their columns, with no virtual calls or tree walk.
+// Objects are referred to by handles that go stale once the object is destroyed.
+// Adding, removing, or destroying objects moves rows between and within
+// archetypes, so component pointers are only valid until the next such change.
+class ComponentStore
+{
+public:
+	struct Handle
+	{
+		UINT						index;
+		UINT						generation;
+	};
+
+	// The columns of one archetype, as seen by a system
+	struct Columns
+	{
+		unsigned int				components;
+		size_t						count;
+		const Handle*				handles;
+		TransformComponent*			transforms;
+		DirectX::XMFLOAT3*			velocities;
+		RenderItem**				renderItems;
+		unsigned int*				categories;
+	};
+
+
+public:
+									ComponentStore();
+
+	Handle							create(unsigned int components);
+	void							destroy(Handle handle);
+	bool							isAlive(Handle handle) const;
+	void							setComponents(Handle handle, unsigned int components);
+	unsigned int					getComponents(Handle handle) const;
+	void							clear();
+
+	TransformComponent*				getTransform(Handle handle);
+	DirectX::XMFLOAT3*				getVelocity(Handle handle);
+	RenderItem**					getRenderItem(Handle handle);
+	unsigned int*					getCategory(Handle handle);
+
+	// fn(Columns&) is called for every non-empty archetype having all the given components
+	template <typename Function>
+	void							forEach(unsigned int components, Function fn);
+
+	void							integrate(float dt);
+	void							interpolate(float alpha, std::vector<RenderItem*>& changed);
+	void							draw(RenderBatcher& batcher);
+
+	size_t							size() const;
+	size_t							getArchetypeCount() const;
+
+
+private:
+	struct Archetype
+	{
+		unsigned int				components;
+		std::vector<Handle>			handles;
+		std::vector<TransformComponent>	transforms;
+		std::vector<DirectX::XMFLOAT3>	velocities;
+		std::vector<RenderItem*>	renderItems;
+		std::vector<unsigned int>	categories;
+	};
+
+	// Where the object of a handle index lives; generation counts its reuses
+	struct Slot
+	{
+		UINT						archetype;
+		UINT						row;
+		UINT						generation;
+	};
+
+
+private:
+	UINT							getArchetype(unsigned int components);
+	UINT							appendRow(UINT archetype, Handle handle);
+	void							removeRow(UINT archetype, UINT row);
+	Columns							getColumns(Archetype& archetype);
+
+
+private:
+	std::vector<Archetype>			mArchetypes;
+	std::vector<Slot>				mSlots;
+	std::vector<UINT>				mFreeSlots;
+	size_t							mCount;
+};
+
+// Calls fn with the columns of every archetype having the components
+template <typename Function>
+void ComponentStore::forEach(unsigned int components, Function fn)
+{
+	for (Archetype& archetype : mArchetypes)
+	{
+		if ((archetype.components & components) == components && !archetype.handles.empty())
+		{
+			Columns columns = getColumns(archetype);
+			fn(columns);
+		}
+	}
+}
@@ -0,0 +1,111 @@
+//***************************************************************************************
+// ConcurrentCommandQueue.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "ConcurrentCommandQueue.hpp"
+#include "CommandQueue.hpp"
+
+// Constructor, rounds the capacity up to a power of two so positions wrap with a mask
+ConcurrentCommandQueue::ConcurrentCommandQueue(std::size_t capacity)
+	: mTail(0)
+	, mHead(0)
+{
+	std::size_t size = 2;
+	while (size < capacity)
+		size *= 2;
+
+	mCells.reset(new Cell[size]);
+	mMask = size - 1;
+
+	for (std::size_t i = 0; i < size; ++i)
+		mCells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+// Copies a command into the queue; returns false if the queue is full. Safe from any thread.
+bool ConcurrentCommandQueue::tryPush(const Command& command)
+{
+	Cell* cell = claim();
+	if (cell == nullptr)
+		return false;
+
+	cell->command = command;
+	cell->sequence.store(cell->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	return true;
+}
+
+// Moves a command into the queue; returns false if the queue is full. Safe from any thread.
+bool ConcurrentCommandQueue::tryPush(Command&& command)
+{
+	Cell* cell = claim();
+	if (cell == nullptr)
+		return false;
+
+	cell->command = std::move(command);
+	cell->sequence.store(cell->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	return true;
+}
+
+// Takes the oldest command; returns false if the queue is empty. Consumer thread only.
+bool ConcurrentCommandQueue::tryPop(Command& command)
+{
+	Cell& cell = mCells[mHead & mMask];
+
+	// The producer publishes a cell by setting its sequence to position + 1
+	if (cell.sequence.load(std::memory_order_acquire) != mHead + 1)
+		return false;
+
+	command = std::move(cell.command);
+
+	// Hand the cell back to producers for the next lap around the ring
+	cell.sequence.store(mHead + mMask + 1, std::memory_order_release);
+	mHead++;
+	return true;
+}
+
+// Moves every published command into the frame's command queue and returns how many were moved
+std::size_t ConcurrentCommandQueue::drain(CommandQueue& commands)
+{
+	std::size_t count = 0;
+	Command command;
+	while (tryPop(command))
+	{
+		commands.push(std::move(command));
+		count++;
+	}
+	return count;
+}
+
+// Returns the number of commands the queue can hold
+std::size_t ConcurrentCommandQueue::getCapacity() const
+{
+	return mMask + 1;
+}
+
+// Reserves the cell at the tail for the calling producer, or returns nullptr if the queue is full
+ConcurrentCommandQueue::Cell* ConcurrentCommandQueue::claim()
+{
+	std::size_t position = mTail.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Cell& cell = mCells[position & mMask];
+		std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+
+		if (difference == 0)
+		{
+			// The cell is free for this lap; claim it by advancing the tail
+			if (mTail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				return &cell;
+		}
+		else if (difference < 0)
+		{
+			// The consumer has not freed this cell yet: the queue is full
+			return nullptr;
+		}
+		else
+		{
+			// Another producer claimed this position first
+			position = mTail.load(std::memory_order_relaxed);
+		}
+	}
+}
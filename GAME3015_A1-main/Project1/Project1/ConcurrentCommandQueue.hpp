@@ -0,0 +1,53 @@
+#pragma once
+#include "Command.hpp"
+
+#include <atomic>
+#include <memory>
+
+class CommandQueue;
+
+// Bounded lock-free multi-producer/single-consumer command queue. Any thread
+// (input polling, AI, network receive) may push; the game thread drains it
+// into the World's CommandQueue once per frame. Each cell carries a sequence
+// number that tells producers and the consumer whose turn it is, so a push
+// is one compare-and-swap on the tail plus a store into the claimed cell.
+class ConcurrentCommandQueue
+{
+public:
+	explicit					ConcurrentCommandQueue(std::size_t capacity = 1024);
+								ConcurrentCommandQueue(const ConcurrentCommandQueue&) = delete;
+	ConcurrentCommandQueue&		operator=(const ConcurrentCommandQueue&) = delete;
+
+	bool						tryPush(const Command& command);
+	bool						tryPush(Command&& command);
+	bool						tryPop(Command& command);
+	std::size_t					drain(CommandQueue& commands);
+
+	std::size_t					getCapacity() const;
+
+private:
+	static const std::size_t	CacheLineSize = 64;
+
+	struct Cell
+	{
+		std::atomic<std::size_t>	sequence;
+		Command						command;
+	};
+
+private:
+	Cell*						claim();
+
+
+private:
+	std::unique_ptr<Cell[]>		mCells;
+	std::size_t					mMask;
+
+	// Producers and the consumer write different ends, so each gets a cache line of its own.
+	// Padded rather than alignas(64): an over-aligned queue would make World over-aligned,
+	// and operator new ignores that before C++17.
+	char						mTailPadding[CacheLineSize];
+	std::atomic<std::size_t>	mTail;
+	char						mHeadPadding[CacheLineSize - sizeof(std::atomic<std::size_t>)];
+	std::size_t					mHead;
+	char						mEndPadding[CacheLineSize - sizeof(std::size_t)];
+};
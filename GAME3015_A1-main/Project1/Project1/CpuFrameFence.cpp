@@ -0,0 +1,67 @@
+//***************************************************************************************
+// CpuFrameFence.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "CpuFrameFence.hpp"
+
+#include <algorithm>
+
+// Constructor, immediate completes every value as soon as it is signalled
+CpuFrameFence::CpuFrameFence(bool immediate)
+	: mImmediate(immediate)
+	, mPending()
+	, mCompleted(0)
+{
+}
+
+// Queues a value, or completes it right away in immediate mode
+void CpuFrameFence::signal(uint64_t value)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (!mImmediate)
+		{
+			mPending.push_back(value);
+			return;
+		}
+		mCompleted = std::max(mCompleted, value);
+	}
+	mCompletedChanged.notify_all();
+}
+
+// Returns the last completed value
+uint64_t CpuFrameFence::getCompletedValue() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mCompleted;
+}
+
+// Blocks until retire() has completed value
+void CpuFrameFence::wait(uint64_t value, unsigned int slot)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mCompletedChanged.wait(lock, [this, value]() { return mCompleted >= value; });
+}
+
+// Completes the oldest signalled values, in the order they were signalled
+size_t CpuFrameFence::retire(size_t count)
+{
+	size_t retired = 0;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (; retired < count && !mPending.empty(); ++retired)
+		{
+			mCompleted = std::max(mCompleted, mPending.front());
+			mPending.pop_front();
+		}
+	}
+	mCompletedChanged.notify_all();
+	return retired;
+}
+
+// Returns the number of signalled values that have not completed yet
+size_t CpuFrameFence::getPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mPending.size();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "FrameFence.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// FrameFence without a GPU. Signalled values queue up until retire() completes
+// them, so another thread can play the GPU and drive the frame pacing. In
+// immediate mode every signal completes at once.
+class CpuFrameFence : public FrameFence
+{
+public:
+	explicit						CpuFrameFence(bool immediate = false);
+
+	virtual void					signal(uint64_t value) override;
+	virtual uint64_t				getCompletedValue() const override;
+	virtual void					wait(uint64_t value, unsigned int slot) override;
+
+	// Completes the oldest count signalled values; returns how many it completed
+	size_t							retire(size_t count = 1);
+	size_t							getPendingCount() const;
+
+
+private:
+	bool							mImmediate;
+	std::deque<uint64_t>			mPending;
+	uint64_t						mCompleted;
+
+	mutable std::mutex				mMutex;
+	std::condition_variable			mCompletedChanged;
+};
@@ -0,0 +1,49 @@
+//***************************************************************************************
+// D3D12FrameFence.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "D3D12FrameFence.hpp"
+
+// Constructor, creates the fence and one auto-reset event per frame slot
+D3D12FrameFence::D3D12FrameFence(ID3D12Device* device, ID3D12CommandQueue* queue, unsigned int slotCount)
+	: mQueue(queue)
+	, mFence()
+	, mEvents()
+{
+	ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
+
+	for (unsigned int i = 0; i < slotCount; ++i)
+	{
+		HANDLE eventHandle = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+		if (eventHandle == nullptr)
+			ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+		mEvents.push_back(eventHandle);
+	}
+}
+
+// Destructor, closes the wait events
+D3D12FrameFence::~D3D12FrameFence()
+{
+	for (HANDLE eventHandle : mEvents)
+		CloseHandle(eventHandle);
+}
+
+// Queues the signal on the command queue
+void D3D12FrameFence::signal(uint64_t value)
+{
+	ThrowIfFailed(mQueue->Signal(mFence.Get(), value));
+}
+
+// Returns the last value the GPU has signalled
+uint64_t D3D12FrameFence::getCompletedValue() const
+{
+	return mFence->GetCompletedValue();
+}
+
+// Blocks on the slot's event until the fence reaches value
+void D3D12FrameFence::wait(uint64_t value, unsigned int slot)
+{
+	HANDLE eventHandle = mEvents[slot % mEvents.size()];
+	ThrowIfFailed(mFence->SetEventOnCompletion(value, eventHandle));
+	WaitForSingleObject(eventHandle, INFINITE);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "FrameFence.hpp"
+#include "../../Common/d3dUtil.h"
+
+#include <vector>
+
+// FrameFence over an ID3D12Fence signalled on a command queue. Every frame slot
+// owns a wait event, created once, instead of creating one per wait.
+class D3D12FrameFence : public FrameFence
+{
+public:
+									D3D12FrameFence(ID3D12Device* device, ID3D12CommandQueue* queue, unsigned int slotCount);
+	virtual							~D3D12FrameFence();
+									D3D12FrameFence(const D3D12FrameFence&) = delete;
+	D3D12FrameFence&				operator=(const D3D12FrameFence&) = delete;
+
+	virtual void					signal(uint64_t value) override;
+	virtual uint64_t				getCompletedValue() const override;
+	virtual void					wait(uint64_t value, unsigned int slot) override;
+
+
+private:
+	ID3D12CommandQueue*				mQueue;
+	Microsoft::WRL::ComPtr<ID3D12Fence>	mFence;
+	std::vector<HANDLE>				mEvents;
+};
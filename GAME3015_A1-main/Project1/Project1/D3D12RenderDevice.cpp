@@ -0,0 +1,132 @@
+//***************************************************************************************
+// D3D12RenderDevice.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "D3D12RenderDevice.hpp"
+#include "Game.hpp"
+
+// Root parameter slots, matching Game::BuildRootSignature
+static const UINT TextureTableSlot = 0;
+static const UINT ObjectDataSlot = 1;
+static const UINT PassSlot = 2;
+static const UINT MaterialSlot = 3;
+static const UINT InstanceObjectsSlot = 4;
+static const UINT InstanceBaseSlot = 5;
+static const UINT InstancePositionsSlot = 6;
+
+// Constructor, a null cmdList records into the game's main command list
+D3D12RenderDevice::D3D12RenderDevice(Game* game, ID3D12GraphicsCommandList* cmdList)
+	: mGame(game)
+	, mCmdList(cmdList)
+{
+}
+
+// Redirects recording to another command list, e.g. the current frame's copy of a chunk list
+void D3D12RenderDevice::setCommandList(ID3D12GraphicsCommandList* cmdList)
+{
+	mCmdList = cmdList;
+}
+
+// Copies the constants of count objects with consecutive indices into the current frame's object buffer
+void D3D12RenderDevice::uploadObjectConstants(unsigned int firstIndex, const ObjectConstants* constants, unsigned int count)
+{
+	mGame->mCurrFrameResource->ObjectCB->CopyData((int)firstIndex, constants, (int)count);
+}
+
+// Copies the constants of one material into the current frame's material buffer
+void D3D12RenderDevice::uploadMaterialConstants(unsigned int index, const MaterialConstants& constants)
+{
+	mGame->mCurrFrameResource->MaterialCB->CopyData((int)index, constants);
+}
+
+// Copies the pass constants into the current frame's pass buffer
+void D3D12RenderDevice::uploadPassConstants(const PassConstants& constants)
+{
+	mGame->mCurrFrameResource->PassCB->CopyData(0, constants);
+}
+
+// Copies the object index of every instance into transient frame memory and binds it
+void D3D12RenderDevice::uploadInstanceObjects(const std::vector<unsigned int>& objects)
+{
+	const UINT64 byteSize = objects.size() * sizeof(unsigned int);
+	LinearAllocator::Allocation allocation = mGame->mCurrFrameResource->FrameAllocator->allocate(byteSize);
+	memcpy(allocation.cpuAddress, objects.data(), (size_t)byteSize);
+
+	// Until positions are uploaded the position slot points at the indices; no draw reads it then
+	mGame->mCurrFrameResource->InstanceObjects = allocation.gpuAddress;
+	mGame->mCurrFrameResource->InstancePositions = allocation.gpuAddress;
+	bindInstanceObjects();
+}
+
+// Copies the instance positions into transient frame memory and binds them
+void D3D12RenderDevice::uploadInstancePositions(const DirectX::XMFLOAT3* positions, unsigned int count)
+{
+	const UINT64 byteSize = (UINT64)count * sizeof(DirectX::XMFLOAT3);
+	LinearAllocator::Allocation allocation = mGame->mCurrFrameResource->FrameAllocator->allocate(byteSize);
+	memcpy(allocation.cpuAddress, positions, (size_t)byteSize);
+
+	mGame->mCurrFrameResource->InstancePositions = allocation.gpuAddress;
+	bindInstanceObjects();
+}
+
+// Binds the instance indices and positions uploaded into the current frame resource
+void D3D12RenderDevice::bindInstanceObjects()
+{
+	getCmdList()->SetGraphicsRootShaderResourceView(InstanceObjectsSlot, mGame->mCurrFrameResource->InstanceObjects);
+	getCmdList()->SetGraphicsRootShaderResourceView(InstancePositionsSlot, mGame->mCurrFrameResource->InstancePositions);
+}
+
+// Binds the current frame's pass constants and object data
+void D3D12RenderDevice::beginPass()
+{
+	FrameResource* frame = mGame->mCurrFrameResource;
+	ID3D12GraphicsCommandList* cmdList = getCmdList();
+
+	cmdList->SetGraphicsRootConstantBufferView(PassSlot, frame->PassCB->Resource()->GetGPUVirtualAddress());
+	cmdList->SetGraphicsRootShaderResourceView(ObjectDataSlot, frame->ObjectCB->Resource()->GetGPUVirtualAddress());
+}
+
+// Binds the vertex buffer, index buffer and topology of a render item
+void D3D12RenderDevice::setGeometry(const RenderItem& item)
+{
+	ID3D12GraphicsCommandList* cmdList = getCmdList();
+
+	cmdList->IASetVertexBuffers(0, 1, &item.Geo->VertexBufferView());
+	cmdList->IASetIndexBuffer(&item.Geo->IndexBufferView());
+	cmdList->IASetPrimitiveTopology((D3D12_PRIMITIVE_TOPOLOGY)item.PrimitiveType);
+}
+
+// Binds the diffuse texture and constants of a material
+void D3D12RenderDevice::setMaterial(const Material& material)
+{
+	UINT matCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants));
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mGame->mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+	tex.Offset(material.DiffuseSrvHeapIndex, mGame->mCbvSrvDescriptorSize);
+
+	D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = mGame->mCurrFrameResource->MaterialCB->Resource()->GetGPUVirtualAddress()
+		+ (UINT64)material.MatCBIndex * matCBByteSize;
+
+	getCmdList()->SetGraphicsRootDescriptorTable(TextureTableSlot, tex);
+	getCmdList()->SetGraphicsRootConstantBufferView(MaterialSlot, matCBAddress);
+}
+
+// Sets the offsets of the next draw into the instance index and position buffers
+void D3D12RenderDevice::setInstanceBase(unsigned int base, unsigned int positionBase)
+{
+	const UINT bases[2] = { base, positionBase };
+	getCmdList()->SetGraphicsRoot32BitConstants(InstanceBaseSlot, 2, bases, 0);
+}
+
+// Issues an indexed, instanced draw
+void D3D12RenderDevice::drawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount,
+	unsigned int startIndexLocation, int baseVertexLocation)
+{
+	getCmdList()->DrawIndexedInstanced(indexCount, instanceCount, startIndexLocation, baseVertexLocation, 0);
+}
+
+// Returns the command list this device records into
+ID3D12GraphicsCommandList* D3D12RenderDevice::getCmdList() const
+{
+	return mCmdList != nullptr ? mCmdList : mGame->getCmdList();
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "RenderDevice.hpp"
+
+class Game;
+struct ID3D12GraphicsCommandList;
+
+// RenderDevice that records into a command list and writes into the upload
+// buffers of the game's current frame resource. Without a list of its own it
+// records into the game's main command list.
+class D3D12RenderDevice : public RenderDevice
+{
+public:
+	explicit						D3D12RenderDevice(Game* game, ID3D12GraphicsCommandList* cmdList = nullptr);
+
+	void							setCommandList(ID3D12GraphicsCommandList* cmdList);
+
+	virtual void					uploadObjectConstants(unsigned int firstIndex, const ObjectConstants* constants, unsigned int count) override;
+	virtual void					uploadMaterialConstants(unsigned int index, const MaterialConstants& constants) override;
+	virtual void					uploadPassConstants(const PassConstants& constants) override;
+	virtual void					uploadInstanceObjects(const std::vector<unsigned int>& objects) override;
+	virtual void					uploadInstancePositions(const DirectX::XMFLOAT3* positions, unsigned int count) override;
+	virtual void					bindInstanceObjects() override;
+
+	virtual void					beginPass() override;
+	virtual void					setGeometry(const RenderItem& item) override;
+	virtual void					setMaterial(const Material& material) override;
+	virtual void					setInstanceBase(unsigned int base, unsigned int positionBase) override;
+	virtual void					drawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount,
+										unsigned int startIndexLocation, int baseVertexLocation) override;
+
+
+private:
+	ID3D12GraphicsCommandList*		getCmdList() const;
+
+
+private:
+	Game*							mGame;
+	ID3D12GraphicsCommandList*		mCmdList;
+};
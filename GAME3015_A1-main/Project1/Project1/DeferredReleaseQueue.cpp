@@ -0,0 +1,46 @@
+//***************************************************************************************
+// DeferredReleaseQueue.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "DeferredReleaseQueue.hpp"
+
+// Takes over a COM reference until fenceValue has been reached
+void DeferredReleaseQueue::release(Microsoft::WRL::ComPtr<IUnknown> object, UINT64 fenceValue)
+{
+	if (object == nullptr)
+		return;
+
+	push(std::shared_ptr<void>(object.Detach(), [](void* p) { static_cast<IUnknown*>(p)->Release(); }), fenceValue);
+}
+
+// Frees every object whose fence value the GPU has reached
+void DeferredReleaseQueue::collect(UINT64 completedFenceValue)
+{
+	while (!mEntries.empty() && mEntries.front().fenceValue <= completedFenceValue)
+		mEntries.pop_front();
+}
+
+// Frees every object; only call once the GPU is idle
+void DeferredReleaseQueue::clear()
+{
+	mEntries.clear();
+}
+
+// Returns the number of objects waiting to be freed
+size_t DeferredReleaseQueue::size() const
+{
+	return mEntries.size();
+}
+
+// Appends an entry, keeping the queue ordered by fence value
+void DeferredReleaseQueue::push(std::shared_ptr<void> object, UINT64 fenceValue)
+{
+	Entry entry;
+	entry.fenceValue = fenceValue;
+	entry.object = std::move(object);
+
+	auto position = mEntries.end();
+	while (position != mEntries.begin() && std::prev(position)->fenceValue > fenceValue)
+		--position;
+	mEntries.insert(position, std::move(entry));
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "../../Common/d3dUtil.h"
+
+#include <deque>
+#include <iterator>
+#include <memory>
+
+// Keeps objects the GPU may still be reading alive until the fence value of
+// their last use has been reached, instead of stalling the CPU to free them.
+class DeferredReleaseQueue
+{
+public:
+	template <typename T>
+	void							release(std::unique_ptr<T> object, UINT64 fenceValue);
+	void							release(Microsoft::WRL::ComPtr<IUnknown> object, UINT64 fenceValue);
+
+	void							collect(UINT64 completedFenceValue);
+	void							clear();
+	size_t							size() const;
+
+
+private:
+	struct Entry
+	{
+		UINT64						fenceValue;
+		std::shared_ptr<void>		object;
+	};
+
+
+private:
+	void							push(std::shared_ptr<void> object, UINT64 fenceValue);
+
+
+private:
+	// Ordered by fence value, since objects are released in submission order
+	std::deque<Entry>				mEntries;
+};
+
+// Takes ownership of an object until fenceValue has been reached
+template <typename T>
+void DeferredReleaseQueue::release(std::unique_ptr<T> object, UINT64 fenceValue)
+{
+	if (object != nullptr)
+		push(std::shared_ptr<void>(std::move(object)), fenceValue);
+}
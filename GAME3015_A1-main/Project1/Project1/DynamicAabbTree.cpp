@@ -0,0 +1,575 @@
+//***************************************************************************************
+// DynamicAabbTree.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "DynamicAabbTree.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace DirectX;
+
+// Out of class definition, so the sentinel can be bound to references like push_back's
+const int DynamicAabbTree::NullNode;
+
+// Refits may let the area ratio grow to this multiple of a freshly built tree's before it counts as degraded
+static const float DegradedAreaFactor = 2.0f;
+
+// Returns the world space box around an object space box transformed by a row-vector world matrix
+Aabb Aabb::fromBoundingBox(const BoundingBox& box, const XMFLOAT4X4& world)
+{
+	const XMMATRIX m = XMLoadFloat4x4(&world);
+
+	const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&box.Center), m);
+	XMVECTOR extents = XMVectorMultiply(XMVectorAbs(m.r[0]), XMVectorReplicate(box.Extents.x));
+	extents = XMVectorMultiplyAdd(XMVectorAbs(m.r[1]), XMVectorReplicate(box.Extents.y), extents);
+	extents = XMVectorMultiplyAdd(XMVectorAbs(m.r[2]), XMVectorReplicate(box.Extents.z), extents);
+
+	Aabb aabb;
+	XMStoreFloat3(&aabb.min, XMVectorSubtract(center, extents));
+	XMStoreFloat3(&aabb.max, XMVectorAdd(center, extents));
+	return aabb;
+}
+
+// Returns the box around both boxes
+Aabb Aabb::merge(const Aabb& a, const Aabb& b)
+{
+	Aabb aabb;
+	aabb.min = XMFLOAT3(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z));
+	aabb.max = XMFLOAT3(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z));
+	return aabb;
+}
+
+// Returns true if other lies completely inside this box
+bool Aabb::contains(const Aabb& other) const
+{
+	return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+		&& other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+}
+
+// Returns true if the boxes touch or intersect
+bool Aabb::overlaps(const Aabb& other) const
+{
+	return min.x <= other.max.x && other.min.x <= max.x
+		&& min.y <= other.max.y && other.min.y <= max.y
+		&& min.z <= other.max.z && other.min.z <= max.z;
+}
+
+// Returns the surface area, the cost measure of the tree
+float Aabb::surfaceArea() const
+{
+	const float x = max.x - min.x;
+	const float y = max.y - min.y;
+	const float z = max.z - min.z;
+	return 2.0f * (x * y + y * z + z * x);
+}
+
+// Returns the center point
+XMFLOAT3 Aabb::center() const
+{
+	return XMFLOAT3(0.5f * (min.x + max.x), 0.5f * (min.y + max.y), 0.5f * (min.z + max.z));
+}
+
+// Constructor, margin is how far leaf boxes are enlarged on every side
+DynamicAabbTree::DynamicAabbTree(float margin)
+	: mNodes()
+	, mRoot(NullNode)
+	, mFreeList(NullNode)
+	, mProxyCount(0)
+	, mMargin(margin)
+	, mAreaRatio(0.0f)
+	, mBuiltAreaRatio(0.0f)
+	, mStructureChanged(false)
+	, mStack()
+{
+}
+
+// Adds a proxy for a box and returns its id
+int DynamicAabbTree::createProxy(const Aabb& aabb, void* userData)
+{
+	const int proxyId = allocateNode();
+	mNodes[proxyId].aabb = fatten(aabb);
+	mNodes[proxyId].userData = userData;
+	mNodes[proxyId].height = 0;
+
+	insertLeaf(proxyId);
+	mProxyCount++;
+	return proxyId;
+}
+
+// Removes a proxy
+void DynamicAabbTree::destroyProxy(int proxyId)
+{
+	assert(mNodes[proxyId].isLeaf());
+
+	removeLeaf(proxyId);
+	freeNode(proxyId);
+	mProxyCount--;
+}
+
+// Moves a proxy, reinserting it if the box left its enlarged box; returns true if it was reinserted
+bool DynamicAabbTree::moveProxy(int proxyId, const Aabb& aabb)
+{
+	if (mNodes[proxyId].aabb.contains(aabb))
+		return false;
+
+	removeLeaf(proxyId);
+	mNodes[proxyId].aabb = fatten(aabb);
+	insertLeaf(proxyId);
+	return true;
+}
+
+// Grows or moves a proxy's enlarged box in place without fixing its ancestors; call refit() after a batch of updates.
+// Returns true if the box changed.
+bool DynamicAabbTree::updateProxy(int proxyId, const Aabb& aabb)
+{
+	if (mNodes[proxyId].aabb.contains(aabb))
+		return false;
+
+	mNodes[proxyId].aabb = fatten(aabb);
+	return true;
+}
+
+// Recomputes the box of every internal node from its children, in one pass over the tree
+void DynamicAabbTree::refit()
+{
+	if (mRoot == NullNode)
+		return;
+
+	// In pre-order every child comes after its parent, so walking the order backwards visits children first
+	std::vector<int> order;
+	order.reserve(mNodes.size());
+	mStack.clear();
+	mStack.push_back(mRoot);
+	while (!mStack.empty())
+	{
+		const int index = mStack.back();
+		mStack.pop_back();
+		order.push_back(index);
+
+		if (!mNodes[index].isLeaf())
+		{
+			mStack.push_back(mNodes[index].child1);
+			mStack.push_back(mNodes[index].child2);
+		}
+	}
+
+	for (auto it = order.rbegin(); it != order.rend(); ++it)
+	{
+		Node& node = mNodes[*it];
+		if (!node.isLeaf())
+			node.aabb = Aabb::merge(mNodes[node.child1].aabb, mNodes[node.child2].aabb);
+	}
+
+	mAreaRatio = computeAreaRatio();
+	if (mStructureChanged)
+	{
+		mBuiltAreaRatio = mAreaRatio;
+		mStructureChanged = false;
+	}
+}
+
+// Rebuilds the hierarchy top-down over the current leaves, splitting at the median of the longest axis
+void DynamicAabbTree::rebuild()
+{
+	std::vector<int> leaves;
+	leaves.reserve(mProxyCount);
+	for (int i = 0; i < (int)mNodes.size(); ++i)
+	{
+		if (mNodes[i].height == 0)
+			leaves.push_back(i);
+		else if (mNodes[i].height > 0)
+			freeNode(i);
+	}
+
+	mRoot = leaves.empty() ? NullNode : buildTopDown(leaves.data(), (int)leaves.size());
+	if (mRoot != NullNode)
+		mNodes[mRoot].parent = NullNode;
+
+	mAreaRatio = computeAreaRatio();
+	mBuiltAreaRatio = mAreaRatio;
+	mStructureChanged = false;
+}
+
+// Removes every proxy
+void DynamicAabbTree::clear()
+{
+	mNodes.clear();
+	mRoot = NullNode;
+	mFreeList = NullNode;
+	mProxyCount = 0;
+	mAreaRatio = 0.0f;
+	mBuiltAreaRatio = 0.0f;
+	mStructureChanged = false;
+}
+
+// Returns the user data the proxy was created with
+void* DynamicAabbTree::getUserData(int proxyId) const
+{
+	return mNodes[proxyId].userData;
+}
+
+// Returns the enlarged box stored for a proxy
+const Aabb& DynamicAabbTree::getFatAabb(int proxyId) const
+{
+	return mNodes[proxyId].aabb;
+}
+
+// Returns the number of proxies
+size_t DynamicAabbTree::getProxyCount() const
+{
+	return mProxyCount;
+}
+
+// Returns the height of the tree, 0 for a single leaf or an empty tree
+int DynamicAabbTree::getHeight() const
+{
+	return mRoot == NullNode ? 0 : mNodes[mRoot].height;
+}
+
+// Returns the summed area of all nodes over the root's area as of the last refit or rebuild
+float DynamicAabbTree::getAreaRatio() const
+{
+	return mAreaRatio;
+}
+
+// Returns true if refits have let the tree become much worse than when it was last built
+bool DynamicAabbTree::isDegraded() const
+{
+	return mBuiltAreaRatio > 0.0f && mAreaRatio > DegradedAreaFactor * mBuiltAreaRatio;
+}
+
+// Asserts the parent links, heights and boxes of the whole tree
+void DynamicAabbTree::validate() const
+{
+	if (mRoot == NullNode)
+		return;
+
+	assert(mNodes[mRoot].parent == NullNode);
+
+	size_t leaves = 0;
+	std::vector<int> stack(1, mRoot);
+	while (!stack.empty())
+	{
+		const int index = stack.back();
+		stack.pop_back();
+
+		const Node& node = mNodes[index];
+		if (node.isLeaf())
+		{
+			assert(node.height == 0);
+			leaves++;
+			continue;
+		}
+
+		const Node& child1 = mNodes[node.child1];
+		const Node& child2 = mNodes[node.child2];
+		assert(child1.parent == index && child2.parent == index);
+		assert(node.height == 1 + std::max(child1.height, child2.height));
+		assert(node.aabb.contains(child1.aabb) && node.aabb.contains(child2.aabb));
+		(void)child1;
+		(void)child2;
+
+		stack.push_back(node.child1);
+		stack.push_back(node.child2);
+	}
+
+	assert(leaves == mProxyCount);
+	(void)leaves;
+}
+
+// Takes a node from the free list, growing the pool if it is empty
+int DynamicAabbTree::allocateNode()
+{
+	if (mFreeList == NullNode)
+	{
+		Node node;
+		node.parent = NullNode;
+		node.height = -1;
+		mNodes.push_back(node);
+		mFreeList = (int)mNodes.size() - 1;
+	}
+
+	const int index = mFreeList;
+	mFreeList = mNodes[index].parent;
+
+	Node& node = mNodes[index];
+	node.userData = nullptr;
+	node.parent = NullNode;
+	node.child1 = NullNode;
+	node.child2 = NullNode;
+	node.height = 0;
+	return index;
+}
+
+// Returns a node to the free list
+void DynamicAabbTree::freeNode(int node)
+{
+	mNodes[node].parent = mFreeList;
+	mNodes[node].height = -1;
+	mFreeList = node;
+}
+
+// Inserts a leaf next to the sibling that grows the summed surface area the least
+void DynamicAabbTree::insertLeaf(int leaf)
+{
+	mStructureChanged = true;
+
+	if (mRoot == NullNode)
+	{
+		mRoot = leaf;
+		mNodes[leaf].parent = NullNode;
+		return;
+	}
+
+	const Aabb leafAabb = mNodes[leaf].aabb;
+	int index = mRoot;
+	while (!mNodes[index].isLeaf())
+	{
+		const Node& node = mNodes[index];
+		const float area = node.aabb.surfaceArea();
+		const float combinedArea = Aabb::merge(node.aabb, leafAabb).surfaceArea();
+
+		// Cost of pairing the leaf with this node, and the growth every descendant inherits
+		const float cost = 2.0f * combinedArea;
+		const float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCosts[2];
+		const int children[2] = { node.child1, node.child2 };
+		for (int i = 0; i < 2; ++i)
+		{
+			const Node& child = mNodes[children[i]];
+			const float mergedArea = Aabb::merge(leafAabb, child.aabb).surfaceArea();
+			childCosts[i] = (child.isLeaf() ? mergedArea : mergedArea - child.aabb.surfaceArea()) + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+			break;
+
+		index = childCosts[0] < childCosts[1] ? node.child1 : node.child2;
+	}
+
+	// Replace the sibling by a new parent of the sibling and the leaf
+	const int sibling = index;
+	const int oldParent = mNodes[sibling].parent;
+	const int newParent = allocateNode();
+
+	mNodes[newParent].parent = oldParent;
+	mNodes[newParent].aabb = Aabb::merge(leafAabb, mNodes[sibling].aabb);
+	mNodes[newParent].height = mNodes[sibling].height + 1;
+	mNodes[newParent].child1 = sibling;
+	mNodes[newParent].child2 = leaf;
+	mNodes[sibling].parent = newParent;
+	mNodes[leaf].parent = newParent;
+
+	if (oldParent == NullNode)
+	{
+		mRoot = newParent;
+	}
+	else if (mNodes[oldParent].child1 == sibling)
+	{
+		mNodes[oldParent].child1 = newParent;
+	}
+	else
+	{
+		mNodes[oldParent].child2 = newParent;
+	}
+
+	fixUpwards(oldParent);
+}
+
+// Detaches a leaf, replacing its parent by its sibling
+void DynamicAabbTree::removeLeaf(int leaf)
+{
+	mStructureChanged = true;
+
+	if (leaf == mRoot)
+	{
+		mRoot = NullNode;
+		return;
+	}
+
+	const int parent = mNodes[leaf].parent;
+	const int grandParent = mNodes[parent].parent;
+	const int sibling = mNodes[parent].child1 == leaf ? mNodes[parent].child2 : mNodes[parent].child1;
+
+	mNodes[sibling].parent = grandParent;
+	freeNode(parent);
+
+	if (grandParent == NullNode)
+	{
+		mRoot = sibling;
+		return;
+	}
+
+	if (mNodes[grandParent].child1 == parent)
+		mNodes[grandParent].child1 = sibling;
+	else
+		mNodes[grandParent].child2 = sibling;
+
+	fixUpwards(grandParent);
+}
+
+// Rotates the taller child of an unbalanced node above it; returns the node now at its place
+int DynamicAabbTree::balance(int iA)
+{
+	if (mNodes[iA].isLeaf() || mNodes[iA].height < 2)
+		return iA;
+
+	const int iB = mNodes[iA].child1;
+	const int iC = mNodes[iA].child2;
+	const int difference = mNodes[iC].height - mNodes[iB].height;
+	if (difference >= -1 && difference <= 1)
+		return iA;
+
+	// up is the taller child that takes A's place; down is A's other child
+	const int up = difference > 1 ? iC : iB;
+	const int down = difference > 1 ? iB : iC;
+	const int iF = mNodes[up].child1;
+	const int iG = mNodes[up].child2;
+
+	// A becomes a child of up, in the slot of its own parent link
+	mNodes[up].child1 = iA;
+	mNodes[up].parent = mNodes[iA].parent;
+	mNodes[iA].parent = up;
+
+	const int parent = mNodes[up].parent;
+	if (parent == NullNode)
+		mRoot = up;
+	else if (mNodes[parent].child1 == iA)
+		mNodes[parent].child1 = up;
+	else
+		mNodes[parent].child2 = up;
+
+	// up keeps its taller grandchild; the shorter one moves under A where up was
+	const int keep = mNodes[iF].height > mNodes[iG].height ? iF : iG;
+	const int move = keep == iF ? iG : iF;
+
+	mNodes[up].child2 = keep;
+	if (up == iC)
+		mNodes[iA].child2 = move;
+	else
+		mNodes[iA].child1 = move;
+	mNodes[move].parent = iA;
+
+	mNodes[iA].aabb = Aabb::merge(mNodes[down].aabb, mNodes[move].aabb);
+	mNodes[iA].height = 1 + std::max(mNodes[down].height, mNodes[move].height);
+	mNodes[up].aabb = Aabb::merge(mNodes[iA].aabb, mNodes[keep].aabb);
+	mNodes[up].height = 1 + std::max(mNodes[iA].height, mNodes[keep].height);
+	return up;
+}
+
+// Rebalances and recomputes the boxes and heights from a node up to the root
+void DynamicAabbTree::fixUpwards(int node)
+{
+	while (node != NullNode)
+	{
+		node = balance(node);
+
+		Node& current = mNodes[node];
+		current.height = 1 + std::max(mNodes[current.child1].height, mNodes[current.child2].height);
+		current.aabb = Aabb::merge(mNodes[current.child1].aabb, mNodes[current.child2].aabb);
+
+		node = current.parent;
+	}
+}
+
+// Builds a subtree over count leaves and returns its root
+int DynamicAabbTree::buildTopDown(int* leaves, int count)
+{
+	if (count == 1)
+		return leaves[0];
+
+	// Split at the median center along the axis the centers spread the most
+	Aabb centers;
+	centers.min = centers.max = mNodes[leaves[0]].aabb.center();
+	for (int i = 1; i < count; ++i)
+	{
+		const XMFLOAT3 c = mNodes[leaves[i]].aabb.center();
+		Aabb point = { c, c };
+		centers = Aabb::merge(centers, point);
+	}
+
+	const float spreadX = centers.max.x - centers.min.x;
+	const float spreadY = centers.max.y - centers.min.y;
+	const float spreadZ = centers.max.z - centers.min.z;
+	const int axis = spreadX >= spreadY && spreadX >= spreadZ ? 0 : (spreadY >= spreadZ ? 1 : 2);
+
+	auto axisCenter = [this, axis](int leaf)
+	{
+		const XMFLOAT3 c = mNodes[leaf].aabb.center();
+		return axis == 0 ? c.x : (axis == 1 ? c.y : c.z);
+	};
+
+	const int half = count / 2;
+	std::nth_element(leaves, leaves + half, leaves + count,
+		[&axisCenter](int a, int b) { return axisCenter(a) < axisCenter(b); });
+
+	const int child1 = buildTopDown(leaves, half);
+	const int child2 = buildTopDown(leaves + half, count - half);
+
+	const int node = allocateNode();
+	mNodes[node].child1 = child1;
+	mNodes[node].child2 = child2;
+	mNodes[node].aabb = Aabb::merge(mNodes[child1].aabb, mNodes[child2].aabb);
+	mNodes[node].height = 1 + std::max(mNodes[child1].height, mNodes[child2].height);
+	mNodes[child1].parent = node;
+	mNodes[child2].parent = node;
+	return node;
+}
+
+// Returns the summed area of all nodes over the root's area
+float DynamicAabbTree::computeAreaRatio() const
+{
+	if (mRoot == NullNode)
+		return 0.0f;
+
+	const float rootArea = mNodes[mRoot].aabb.surfaceArea();
+	if (rootArea <= 0.0f)
+		return 0.0f;
+
+	float totalArea = 0.0f;
+	for (const Node& node : mNodes)
+	{
+		if (node.height >= 0)
+			totalArea += node.aabb.surfaceArea();
+	}
+	return totalArea / rootArea;
+}
+
+// Returns the box enlarged by the margin on every side
+Aabb DynamicAabbTree::fatten(const Aabb& aabb) const
+{
+	Aabb fat;
+	fat.min = XMFLOAT3(aabb.min.x - mMargin, aabb.min.y - mMargin, aabb.min.z - mMargin);
+	fat.max = XMFLOAT3(aabb.max.x + mMargin, aabb.max.y + mMargin, aabb.max.z + mMargin);
+	return fat;
+}
+
+// Slab test; on a hit within maxDistance returns true and the distance at which the ray enters the box
+bool DynamicAabbTree::intersectRay(const Aabb& aabb, const XMFLOAT3& origin,
+	const XMFLOAT3& inverseDirection, float maxDistance, float& entry)
+{
+	const float originValues[3] = { origin.x, origin.y, origin.z };
+	const float inverseValues[3] = { inverseDirection.x, inverseDirection.y, inverseDirection.z };
+	const float minValues[3] = { aabb.min.x, aabb.min.y, aabb.min.z };
+	const float maxValues[3] = { aabb.max.x, aabb.max.y, aabb.max.z };
+
+	float tMin = 0.0f;
+	float tMax = maxDistance;
+	for (int i = 0; i < 3; ++i)
+	{
+		float t1 = (minValues[i] - originValues[i]) * inverseValues[i];
+		float t2 = (maxValues[i] - originValues[i]) * inverseValues[i];
+
+		// A ray parallel to the slab and inside it gives NaN; treat that as no constraint
+		if (t1 != t1 || t2 != t2)
+			continue;
+
+		tMin = std::max(tMin, std::min(t1, t2));
+		tMax = std::min(tMax, std::max(t1, t2));
+	}
+
+	entry = tMin;
+	return tMin <= tMax;
+}
@@ -0,0 +1,256 @@
+#pragma once
+#include "../../Common/MathHelper.h"
+
+#include <DirectXCollision.h>
+#include <vector>
+
+// Axis aligned box given by its corners
+struct Aabb
+{
+	DirectX::XMFLOAT3				min;
+	DirectX::XMFLOAT3				max;
+
+	static Aabb						fromBoundingBox(const DirectX::BoundingBox& box, const DirectX::XMFLOAT4X4& world);
+	static Aabb						merge(const Aabb& a, const Aabb& b);
+
+	bool							contains(const Aabb& other) const;
+	bool							overlaps(const Aabb& other) const;
+	float							surfaceArea() const;
+	DirectX::XMFLOAT3				center() const;
+};
+
+// Dynamic bounding volume hierarchy over proxies with world space boxes.
+// Leaves store the box enlarged by a margin, so small movements do not touch
+// the tree at all. Proxies can be moved one by one, which reinserts the leaf,
+// or updated in bulk with updateProxy() followed by one refit() over the whole
+// tree; rebuild() recreates the hierarchy top-down once refits have let its
+// quality degrade. Queries walk the tree with an explicit stack and report
+// proxies whose enlarged box passes the test; the stack is shared, so queries
+// must not be nested or run on several threads at once.
+class DynamicAabbTree
+{
+public:
+	static const int				NullNode = -1;
+
+
+public:
+	explicit						DynamicAabbTree(float margin = 0.1f);
+
+	int								createProxy(const Aabb& aabb, void* userData);
+	void							destroyProxy(int proxyId);
+	bool							moveProxy(int proxyId, const Aabb& aabb);
+	bool							updateProxy(int proxyId, const Aabb& aabb);
+	void							refit();
+	void							rebuild();
+	void							clear();
+
+	void*							getUserData(int proxyId) const;
+	const Aabb&						getFatAabb(int proxyId) const;
+	size_t							getProxyCount() const;
+	int								getHeight() const;
+	float							getAreaRatio() const;
+	bool							isDegraded() const;
+	void							validate() const;
+
+	// callback(int proxyId) returns false to stop the query
+	template <typename Callback>
+	void							queryOverlap(const Aabb& aabb, Callback callback) const;
+	template <typename Callback>
+	void							queryFrustum(const DirectX::XMFLOAT4* planes, int planeCount, Callback callback) const;
+
+	// callback(int proxyId, float entryDistance) returns the new maximum distance:
+	// the hit distance to only look for closer hits, 0 to stop
+	template <typename Callback>
+	void							rayCast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction,
+										float maxDistance, Callback callback) const;
+
+
+private:
+	struct Node
+	{
+		Aabb						aabb;
+		void*						userData;
+
+		// Parent in the tree, or the next free node while on the free list
+		int							parent;
+		int							child1;
+		int							child2;
+
+		// Leaves have height 0, free nodes -1
+		int							height;
+
+		bool						isLeaf() const { return child1 == NullNode; }
+	};
+
+
+private:
+	int								allocateNode();
+	void							freeNode(int node);
+	void							insertLeaf(int leaf);
+	void							removeLeaf(int leaf);
+	int								balance(int node);
+	void							fixUpwards(int node);
+	int								buildTopDown(int* leaves, int count);
+	float							computeAreaRatio() const;
+	Aabb							fatten(const Aabb& aabb) const;
+
+	static bool						intersectRay(const Aabb& aabb, const DirectX::XMFLOAT3& origin,
+										const DirectX::XMFLOAT3& inverseDirection, float maxDistance, float& entry);
+
+
+private:
+	std::vector<Node>				mNodes;
+	int								mRoot;
+	int								mFreeList;
+	size_t							mProxyCount;
+	float							mMargin;
+
+	// Summed node area over root area, as of the last refit or rebuild, and as of
+	// the last structural change, to tell when refits have degraded the hierarchy
+	float							mAreaRatio;
+	float							mBuiltAreaRatio;
+	bool							mStructureChanged;
+
+	// Traversal stack reused by the queries
+	mutable std::vector<int>		mStack;
+};
+
+// Reports the proxies whose enlarged box overlaps aabb
+template <typename Callback>
+void DynamicAabbTree::queryOverlap(const Aabb& aabb, Callback callback) const
+{
+	if (mRoot == NullNode)
+		return;
+
+	mStack.clear();
+	mStack.push_back(mRoot);
+	while (!mStack.empty())
+	{
+		const int index = mStack.back();
+		mStack.pop_back();
+
+		const Node& node = mNodes[index];
+		if (!node.aabb.overlaps(aabb))
+			continue;
+
+		if (node.isLeaf())
+		{
+			if (!callback(index))
+				return;
+		}
+		else
+		{
+			mStack.push_back(node.child1);
+			mStack.push_back(node.child2);
+		}
+	}
+}
+
+// Reports the proxies whose enlarged box is not fully behind one of the inward facing planes
+template <typename Callback>
+void DynamicAabbTree::queryFrustum(const DirectX::XMFLOAT4* planes, int planeCount, Callback callback) const
+{
+	if (mRoot == NullNode)
+		return;
+
+	// A high bit on a stack entry marks a subtree known to be fully inside, whose leaves are reported without tests
+	const int InsideFlag = 1 << 30;
+
+	mStack.clear();
+	mStack.push_back(mRoot);
+	while (!mStack.empty())
+	{
+		const int entry = mStack.back();
+		mStack.pop_back();
+
+		const int index = entry & ~InsideFlag;
+		const Node& node = mNodes[index];
+		bool inside = (entry & InsideFlag) != 0;
+
+		if (!inside)
+		{
+			const DirectX::XMFLOAT3 c = node.aabb.center();
+			const DirectX::XMFLOAT3 e(node.aabb.max.x - c.x, node.aabb.max.y - c.y, node.aabb.max.z - c.z);
+
+			bool outside = false;
+			inside = true;
+			for (int p = 0; p < planeCount && !outside; ++p)
+			{
+				const DirectX::XMFLOAT4& plane = planes[p];
+				const float distance = plane.x * c.x + plane.y * c.y + plane.z * c.z + plane.w;
+				const float radius = fabsf(plane.x) * e.x + fabsf(plane.y) * e.y + fabsf(plane.z) * e.z;
+
+				outside = distance + radius < 0.0f;
+				inside = inside && distance - radius >= 0.0f;
+			}
+
+			if (outside)
+				continue;
+		}
+
+		if (node.isLeaf())
+		{
+			if (!callback(index))
+				return;
+		}
+		else
+		{
+			const int flag = inside ? InsideFlag : 0;
+			mStack.push_back(node.child1 | flag);
+			mStack.push_back(node.child2 | flag);
+		}
+	}
+}
+
+// Reports the proxies whose enlarged box the ray enters within maxDistance, nearest subtree first
+template <typename Callback>
+void DynamicAabbTree::rayCast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction,
+	float maxDistance, Callback callback) const
+{
+	if (mRoot == NullNode)
+		return;
+
+	// Division by zero gives infinities, which the slab test handles
+	const DirectX::XMFLOAT3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+	mStack.clear();
+	mStack.push_back(mRoot);
+	while (!mStack.empty())
+	{
+		const int index = mStack.back();
+		mStack.pop_back();
+
+		const Node& node = mNodes[index];
+		float entry;
+		if (!intersectRay(node.aabb, origin, inverseDirection, maxDistance, entry))
+			continue;
+
+		if (node.isLeaf())
+		{
+			maxDistance = callback(index, entry);
+			if (maxDistance <= 0.0f)
+				return;
+		}
+		else
+		{
+			// Push the farther child first so the nearer one is visited first
+			float entry1, entry2;
+			const bool hit1 = intersectRay(mNodes[node.child1].aabb, origin, inverseDirection, maxDistance, entry1);
+			const bool hit2 = intersectRay(mNodes[node.child2].aabb, origin, inverseDirection, maxDistance, entry2);
+
+			if (hit1 && hit2)
+			{
+				mStack.push_back(entry1 <= entry2 ? node.child2 : node.child1);
+				mStack.push_back(entry1 <= entry2 ? node.child1 : node.child2);
+			}
+			else if (hit1)
+			{
+				mStack.push_back(node.child1);
+			}
+			else if (hit2)
+			{
+				mStack.push_back(node.child2);
+			}
+		}
+	}
+}
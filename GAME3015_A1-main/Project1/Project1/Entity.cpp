@@ -3,58 +3,133 @@
 // by Zijie Wang and Wanhao Sun
 //***************************************************************************************
 #include "Entity.hpp"
+#include "CollisionGrid.hpp"
+#include "AircraftKernel.hpp"
 
 // The constructor initializes an Entity object with a given State pointer and a zero velocity
-Entity::Entity(State* state) : SceneNode(state), mVelocity(0, 0, 0)
+Entity::Entity(State* state) : SceneNode(state), mVelocity(0, 0, 0), mFast(false), mDisplacement(0, 0, 0), mKernel(nullptr), mKernelLane(0)
 {
 }
 
 // Sets the velocity of the Entity object to the given XMFLOAT3 velocity vector
 void Entity::setVelocity(XMFLOAT3 velocity)
 {
-	mVelocity = velocity;
+	if (mKernel != nullptr)
+		mKernel->setVelocity(mKernelLane, velocity);
+	else
+		mVelocity = velocity;
 }
 
 // Sets the velocity of the Entity object to the given x, y, and z velocity components
 void Entity::setVelocity(float vx, float vy, float vz)
 {
-	mVelocity.x = vx;
-	mVelocity.y = vy;
-	mVelocity.z = vz;
+	setVelocity(XMFLOAT3(vx, vy, vz));
 }
 
 // Returns the velocity of the Entity object
 XMFLOAT3 Entity::getVelocity() const
 {
-	return mVelocity;
+	return mKernel != nullptr ? mKernel->getVelocity(mKernelLane) : mVelocity;
 }
 
 // Adds the given XMFLOAT3 velocity vector to the current velocity of the Entity object
 void Entity::accelerate(XMFLOAT3 velocity)
 {
-	mVelocity.x = mVelocity.x + velocity.x;
-	mVelocity.y = mVelocity.y + velocity.y;
-	mVelocity.z = mVelocity.z + velocity.z;
+	accelerate(velocity.x, velocity.y, velocity.z);
 }
 
 // Adds the given x, y, and z velocity components to the current velocity of the Entity objecT
 void Entity::accelerate(float vx, float vy, float vz)
 {
-	mVelocity.x = mVelocity.x + vx;
-	mVelocity.y = mVelocity.y + vy;
-	mVelocity.z = mVelocity.z + vz;
+	const XMFLOAT3 velocity = getVelocity();
+	setVelocity(velocity.x + vx, velocity.y + vy, velocity.z + vz);
+}
+
+// Marks the entity as moving fast enough to tunnel through others, so collisions sweep it over each step
+void Entity::setFast(bool fast)
+{
+	mFast = fast;
+}
+
+// Returns true if collisions sweep the entity over each step
+bool Entity::isFast() const
+{
+	return mFast;
+}
+
+// Returns how far the entity moved in its last update
+XMFLOAT3 Entity::getDisplacement() const
+{
+	return mKernel != nullptr ? mKernel->getStep(mKernelLane) : mDisplacement;
+}
+
+// Moves the entity back to where it was at the given fraction of its last update
+void Entity::rewind(float time)
+{
+	const XMFLOAT3 displacement = getDisplacement();
+	const float back = 1.0f - time;
+	displace(-displacement.x * back, -displacement.y * back, -displacement.z * back);
+
+	const XMFLOAT3 rewound(displacement.x * time, displacement.y * time, displacement.z * time);
+	if (mKernel != nullptr)
+		mKernel->setStep(mKernelLane, rewound);
+	else
+		mDisplacement = rewound;
+}
+
+// Moves the entity outside of its own update, e.g. as collision response; a kernel lane holding it moves too
+void Entity::displace(float x, float y, float z)
+{
+	move(x, y, z);
+
+	if (mKernel != nullptr)
+	{
+		const XMFLOAT3 position = mKernel->getPosition(mKernelLane);
+		mKernel->setPosition(mKernelLane, XMFLOAT3(position.x + x, position.y + y, position.z + z));
+	}
+}
+
+// Hands the entity's position and velocity over to a kernel lane, which then holds them and moves the entity
+// instead of updateCurrent; the owner of the kernel writes the lane's position back to the transforms
+void Entity::bindKernel(AircraftKernel* kernel, size_t lane)
+{
+	mKernel = kernel;
+	mKernelLane = lane;
+	mKernel->setState(lane, getWorldPosition(), mVelocity);
+}
+
+// Returns true if a kernel lane holds the entity's position and velocity
+bool Entity::isKernelBound() const
+{
+	return mKernel != nullptr;
+}
+
+// Stores the world space box of the entity's render item; returns false for entities without one
+bool Entity::getCollisionBox(BoundingOrientedBox& box) const
+{
+	if (renderer == nullptr)
+		return false;
+
+	box = CollisionGrid::makeOrientedBox(renderer->Bounds, getWorldTransform());
+	return true;
+}
+
+// Called with the other entity of a contact found by the world's collision grid; does nothing by default
+void Entity::onCollision(Entity& other, const GameTimer& gt)
+{
 }
 
 // Updates the current position of the Entity object based on its current velocity and the given GameTimer object
 void Entity::updateCurrent(const GameTimer& gt) 
 {
+	if (mKernel != nullptr)
+		return;
+
 	XMFLOAT3 mV;
 	mV.x = mVelocity.x * gt.DeltaTime();
 	mV.y = mVelocity.y * gt.DeltaTime();
 	mV.z = mVelocity.z * gt.DeltaTime();
 
 	move(mV.x, mV.y, mV.z);
-
-	renderer->World = getWorldTransform();
-	renderer->NumFramesDirty++;
+	mDisplacement = mV;
 }
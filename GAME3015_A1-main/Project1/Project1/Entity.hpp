@@ -1,8 +1,11 @@
 #pragma once
 #include "SceneNode.hpp"
+#include "CollisionGrid.hpp"
+
+class AircraftKernel;
 
 class Entity :
-    public SceneNode
+    public SceneNode, public Collidable
 {
 public:
 	Entity(State* state);
@@ -13,10 +16,32 @@ public:
 	void				accelerate(XMFLOAT3 velocity);
 	void				accelerate(float vx, float vy, float vz);
 
+	void				setFast(bool fast);
+	bool				isFast() const;
+	virtual XMFLOAT3	getDisplacement() const override;
+	virtual void		rewind(float time) override;
+	virtual void		displace(float x, float y, float z) override;
+
+	void				bindKernel(AircraftKernel* kernel, size_t lane);
+	bool				isKernelBound() const;
+
+	bool				getCollisionBox(BoundingOrientedBox& box) const;
+	virtual void		onCollision(Entity& other, const GameTimer& gt);
+
 
 	virtual	void		updateCurrent(const GameTimer& gt);
 
 public:
 	XMFLOAT3		mVelocity;
+
+private:
+	// Fast entities are swept by the collision grid; the displacement is the last step's motion
+	bool			mFast;
+	XMFLOAT3		mDisplacement;
+
+	// Set when the world moves the entity in bulk; the lane holds its position, velocity, and
+	// displacement, and updateCurrent leaves it alone
+	AircraftKernel*	mKernel;
+	size_t			mKernelLane;
 };
 
@@ -0,0 +1,314 @@
+//***************************************************************************************
+// FrameConstants.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "FrameConstants.hpp"
+#include "RenderDevice.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace DirectX;
+
+// Constructor, setFrameCount() has to be called before objects are marked dirty
+FrameConstants::FrameConstants()
+	: mObjectSlots()
+	, mPublished()
+	, mFreeObjectSlots()
+	, mPublishedCount(0)
+	, mPublishedEnd(0)
+	, mObjectSlotMutex()
+	, mDirtyObjects()
+	, mMaterials()
+	, mObjectUploads()
+	, mUploadStats()
+{
+}
+
+// Sets the number of frame resources; dirty masks hold one bit per frame resource
+void FrameConstants::setFrameCount(unsigned int count)
+{
+	assert(count >= 1 && count <= 32);
+	mDirtyObjects.resize(count);
+}
+
+// Returns the number of frame resources
+unsigned int FrameConstants::getFrameCount() const
+{
+	return (unsigned int)mDirtyObjects.size();
+}
+
+// Reserves an object constant slot for a render item, stores it as the item's ObjCBIndex and returns it.
+// States built in the background call this too; the item stays unpublished until publishObjects().
+UINT FrameConstants::allocateObject(RenderItem* item)
+{
+	std::lock_guard<std::mutex> lock(mObjectSlotMutex);
+	if (!mFreeObjectSlots.empty())
+	{
+		item->ObjCBIndex = mFreeObjectSlots.back();
+		mFreeObjectSlots.pop_back();
+		mObjectSlots[item->ObjCBIndex] = item;
+		return item->ObjCBIndex;
+	}
+
+	item->ObjCBIndex = (UINT)mObjectSlots.size();
+	mObjectSlots.push_back(item);
+	mPublished.push_back(0);
+	return item->ObjCBIndex;
+}
+
+// Reserves consecutive object constant slots for an array of render items, so their constants upload as one run.
+// A run of released slots is reused when one is long enough, or when it ends the buffer and can be extended.
+void FrameConstants::allocateObjects(RenderItem* items, size_t count)
+{
+	std::lock_guard<std::mutex> lock(mObjectSlotMutex);
+	if (count == 0)
+		return;
+
+	// Sorted, the free slots of one run sit next to each other
+	std::sort(mFreeObjectSlots.begin(), mFreeObjectSlots.end());
+
+	size_t runStart = mFreeObjectSlots.size();
+	size_t start = 0;
+	while (start < mFreeObjectSlots.size())
+	{
+		size_t end = start + 1;
+		while (end < mFreeObjectSlots.size() && mFreeObjectSlots[end] == mFreeObjectSlots[end - 1] + 1)
+			++end;
+
+		const bool endsBuffer = mFreeObjectSlots[end - 1] + 1 == mObjectSlots.size();
+		if (end - start >= count || endsBuffer)
+		{
+			runStart = start;
+			break;
+		}
+		start = end;
+	}
+
+	const UINT first = runStart < mFreeObjectSlots.size() ? mFreeObjectSlots[runStart] : (UINT)mObjectSlots.size();
+	const size_t reused = std::min(count, mFreeObjectSlots.size() - runStart);
+	mFreeObjectSlots.erase(mFreeObjectSlots.begin() + runStart, mFreeObjectSlots.begin() + runStart + reused);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		items[i].ObjCBIndex = first + (UINT)i;
+		if (i < reused)
+		{
+			mObjectSlots[items[i].ObjCBIndex] = &items[i];
+		}
+		else
+		{
+			mObjectSlots.push_back(&items[i]);
+			mPublished.push_back(0);
+		}
+	}
+}
+
+// Hands an array of allocated render items to the main thread; from now on a replaced
+// object buffer re-uploads them. Their first upload still comes from markObjectDirty().
+void FrameConstants::publishObjects(RenderItem* items, size_t count)
+{
+	std::lock_guard<std::mutex> lock(mObjectSlotMutex);
+	for (RenderItem* item = items; item != items + count; ++item)
+	{
+		assert(mObjectSlots[item->ObjCBIndex] == item);
+		if (!mPublished[item->ObjCBIndex])
+		{
+			mPublished[item->ObjCBIndex] = 1;
+			mPublishedCount++;
+			mPublishedEnd = std::max(mPublishedEnd, (size_t)item->ObjCBIndex + 1);
+		}
+	}
+}
+
+// Frees the object constant slots of render items that are about to be destroyed and takes them off every dirty list
+void FrameConstants::releaseObjects(const std::vector<std::unique_ptr<RenderItem>>& items)
+{
+	for (const auto& item : items)
+	{
+		for (unsigned int i = 0; i < getFrameCount(); ++i)
+		{
+			if (!(item->DirtyFrames & (1u << i)))
+				continue;
+
+			std::vector<RenderItem*>& dirty = mDirtyObjects[i];
+			dirty.erase(std::find(dirty.begin(), dirty.end(), item.get()));
+		}
+		item->DirtyFrames = 0;
+
+		std::lock_guard<std::mutex> lock(mObjectSlotMutex);
+		freeSlot(item.get());
+	}
+}
+
+// Frees the object constant slots of an array of render items about to be destroyed; each dirty list is
+// filtered once, instead of once per item
+void FrameConstants::releaseObjects(RenderItem* items, size_t count)
+{
+	RenderItem* end = items + count;
+	for (std::vector<RenderItem*>& dirty : mDirtyObjects)
+	{
+		dirty.erase(std::remove_if(dirty.begin(), dirty.end(),
+			[items, end](const RenderItem* item) { return item >= items && item < end; }), dirty.end());
+	}
+
+	std::lock_guard<std::mutex> lock(mObjectSlotMutex);
+	for (RenderItem* item = items; item != end; ++item)
+	{
+		item->DirtyFrames = 0;
+		freeSlot(item);
+	}
+}
+
+// Returns one past the highest object constant slot handed out, the size an object buffer must have
+size_t FrameConstants::getObjectSlotCount() const
+{
+	std::lock_guard<std::mutex> lock(mObjectSlotMutex);
+	return mObjectSlots.size();
+}
+
+// Returns one past the highest published slot, the entries an object buffer needs; slots of states
+// still building in the background are left out until they are published
+size_t FrameConstants::getPublishedSlotEnd() const
+{
+	std::lock_guard<std::mutex> lock(mObjectSlotMutex);
+	return mPublishedEnd;
+}
+
+// Queues a render item on the dirty list of every frame resource that has not picked up its change yet
+void FrameConstants::markObjectDirty(RenderItem* item)
+{
+	for (unsigned int i = 0; i < getFrameCount(); ++i)
+	{
+		const unsigned int frameBit = 1u << i;
+		if (!(item->DirtyFrames & frameBit))
+		{
+			mDirtyObjects[i].push_back(item);
+			item->DirtyFrames |= frameBit;
+		}
+	}
+}
+
+// Queues every published object on one frame resource's dirty list, e.g. after its object buffer was replaced
+void FrameConstants::markAllObjectsDirty(unsigned int frameIndex)
+{
+	const unsigned int frameBit = 1u << frameIndex;
+
+	std::lock_guard<std::mutex> lock(mObjectSlotMutex);
+	for (size_t i = 0; i < mObjectSlots.size(); ++i)
+	{
+		RenderItem* item = mObjectSlots[i];
+		if (mPublished[i] && !(item->DirtyFrames & frameBit))
+		{
+			mDirtyObjects[frameIndex].push_back(item);
+			item->DirtyFrames |= frameBit;
+		}
+	}
+}
+
+// Adds a material whose constants are uploaded to every frame resource while it is dirty
+void FrameConstants::addMaterial(Material* material)
+{
+	mMaterials.push_back(material);
+}
+
+// Uploads the object and material constants a frame resource has not picked up yet
+void FrameConstants::upload(unsigned int frameIndex, RenderDevice& device)
+{
+	uploadObjects(frameIndex, device);
+	uploadMaterials(frameIndex, device);
+}
+
+// Returns the object constant uploads of the last frame
+const FrameConstants::UploadStats& FrameConstants::getUploadStats() const
+{
+	return mUploadStats;
+}
+
+// Uploads the object constants of the render items on a frame resource's dirty list
+void FrameConstants::uploadObjects(unsigned int frameIndex, RenderDevice& device)
+{
+	const unsigned int frameBit = 1u << frameIndex;
+	std::vector<RenderItem*>& dirty = mDirtyObjects[frameIndex];
+
+	// Sorting by object index turns the dirty list into runs of consecutive buffer slots
+	std::sort(dirty.begin(), dirty.end(), [](const RenderItem* a, const RenderItem* b)
+	{
+		return a->ObjCBIndex < b->ObjCBIndex;
+	});
+
+	// Transpose the world and texture transforms into one contiguous staging array
+	mObjectUploads.resize(dirty.size());
+	for (size_t i = 0; i < dirty.size(); ++i)
+	{
+		RenderItem* e = dirty[i];
+		XMStoreFloat4x4(&mObjectUploads[i].World, XMMatrixTranspose(XMLoadFloat4x4(&e->World)));
+		XMStoreFloat4x4(&mObjectUploads[i].TexTransform, XMMatrixTranspose(XMLoadFloat4x4(&e->TexTransform)));
+		e->DirtyFrames &= ~frameBit;
+	}
+
+	// Copy each run of consecutive object indices in one upload
+	size_t first = 0;
+	for (size_t i = 1; i <= dirty.size(); ++i)
+	{
+		if (i == dirty.size() || dirty[i]->ObjCBIndex != dirty[i - 1]->ObjCBIndex + 1)
+		{
+			device.uploadObjectConstants(dirty[first]->ObjCBIndex, &mObjectUploads[first], (unsigned int)(i - first));
+			first = i;
+		}
+	}
+
+	size_t objectCount;
+	{
+		std::lock_guard<std::mutex> lock(mObjectSlotMutex);
+		objectCount = mPublishedCount;
+	}
+	mUploadStats.Uploaded = (UINT)dirty.size();
+	mUploadStats.Skipped = (UINT)(objectCount > dirty.size() ? objectCount - dirty.size() : 0);
+
+	dirty.clear();
+}
+
+// Uploads the constants of the materials a frame resource has not picked up the last change of
+void FrameConstants::uploadMaterials(unsigned int frameIndex, RenderDevice& device)
+{
+	const unsigned int frameBit = 1u << frameIndex;
+	for (Material* mat : mMaterials)
+	{
+		if (mat->DirtyFrames & frameBit)
+		{
+			// Load the material transform matrix for the material
+			XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
+
+			// Copy the material properties to a material constants struct
+			MaterialConstants matConstants;
+			matConstants.DiffuseAlbedo = mat->DiffuseAlbedo;
+			matConstants.FresnelR0 = mat->FresnelR0;
+			matConstants.Roughness = mat->Roughness;
+			XMStoreFloat4x4(&matConstants.MatTransform, XMMatrixTranspose(matTransform));
+
+			// Copy the material constants to the frame's material constant buffer at the material's index
+			device.uploadMaterialConstants(mat->MatCBIndex, matConstants);
+
+			// This frame resource is up to date, the others may still need the update
+			mat->DirtyFrames &= ~frameBit;
+		}
+	}
+}
+
+// Gives an item's slot back if the item still owns it; the caller holds the slot mutex
+void FrameConstants::freeSlot(RenderItem* item)
+{
+	if (item->ObjCBIndex >= mObjectSlots.size() || mObjectSlots[item->ObjCBIndex] != item)
+		return;
+
+	if (mPublished[item->ObjCBIndex])
+	{
+		mPublished[item->ObjCBIndex] = 0;
+		mPublishedCount--;
+		while (mPublishedEnd > 0 && !mPublished[mPublishedEnd - 1])
+			mPublishedEnd--;
+	}
+	mObjectSlots[item->ObjCBIndex] = nullptr;
+	mFreeObjectSlots.push_back(item->ObjCBIndex);
+}
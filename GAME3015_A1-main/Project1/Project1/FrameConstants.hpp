@@ -0,0 +1,77 @@
+#pragma once
+#include "RenderItem.hpp"
+#include "ShaderConstants.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class RenderDevice;
+
+// The object and material constants of every frame in flight. Hands out the
+// object constant slots shared by all states and keeps, per frame resource,
+// the render items whose constants it has not uploaded yet; upload() sends a
+// frame resource's pending object and material constants to a RenderDevice.
+// Slots can be allocated from any thread, but their render items are only
+// read once publishObjects() hands them over on the main thread, so a state
+// built in the background stays private until it is put on the stack.
+// Nothing here touches Direct3D, so frames can be driven headless.
+class FrameConstants
+{
+public:
+	// Object constant uploads of the last frame
+	struct UploadStats
+	{
+		UINT Uploaded = 0;
+		UINT Skipped = 0;
+	};
+
+
+public:
+									FrameConstants();
+
+	void							setFrameCount(unsigned int count);
+	unsigned int					getFrameCount() const;
+
+	UINT							allocateObject(RenderItem* item);
+	void							allocateObjects(RenderItem* items, size_t count);
+	void							publishObjects(RenderItem* items, size_t count);
+	void							releaseObjects(const std::vector<std::unique_ptr<RenderItem>>& items);
+	void							releaseObjects(RenderItem* items, size_t count);
+	size_t							getObjectSlotCount() const;
+	size_t							getPublishedSlotEnd() const;
+
+	void							markObjectDirty(RenderItem* item);
+	void							markAllObjectsDirty(unsigned int frameIndex);
+
+	void							addMaterial(Material* material);
+
+	void							upload(unsigned int frameIndex, RenderDevice& device);
+	const UploadStats&				getUploadStats() const;
+
+
+private:
+	void							uploadObjects(unsigned int frameIndex, RenderDevice& device);
+	void							uploadMaterials(unsigned int frameIndex, RenderDevice& device);
+	void							freeSlot(RenderItem* item);
+
+
+private:
+	// Render item owning each object constant slot; states built in the background allocate too.
+	// Only published slots are walked, the others belong to the thread building them.
+	std::vector<RenderItem*>		mObjectSlots;
+	std::vector<unsigned char>		mPublished;
+	std::vector<UINT>				mFreeObjectSlots;
+	size_t							mPublishedCount;
+	size_t							mPublishedEnd;
+	mutable std::mutex				mObjectSlotMutex;
+
+	// Render items whose object constants changed since frame resource i last uploaded them
+	std::vector<std::vector<RenderItem*>>	mDirtyObjects;
+
+	std::vector<Material*>			mMaterials;
+
+	// Transposed constants of the dirty objects, staged for upload
+	std::vector<ObjectConstants>	mObjectUploads;
+	UploadStats						mUploadStats;
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+// Fence the frame pacing waits on. Values are signalled in increasing order
+// behind the work of each frame and complete once that work has finished.
+// The D3D12 implementation wraps an ID3D12Fence; the CPU one stands in for
+// the GPU so the pacing logic runs without a device.
+class FrameFence
+{
+public:
+	virtual							~FrameFence() {}
+
+	// Queues a signal of value behind the work submitted so far
+	virtual void					signal(uint64_t value) = 0;
+	virtual uint64_t				getCompletedValue() const = 0;
+
+	// Blocks until value has completed; slot is the frame in flight that waits
+	virtual void					wait(uint64_t value, unsigned int slot) = 0;
+};
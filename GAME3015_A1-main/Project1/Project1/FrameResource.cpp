@@ -9,10 +9,42 @@ FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCo
   //  FrameCB = std::make_unique<UploadBuffer<FrameConstants>>(device, 1, true);
     PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
     MaterialCB = std::make_unique<UploadBuffer<MaterialConstants>>(device, materialCount, true);
+    ResizeObjectCB(device, objectCount);
+    FrameAllocator = std::make_unique<LinearAllocator>(device, 64 * 1024);
+}
+
+void FrameResource::ResizeObjectCB(ID3D12Device* device, UINT objectCount)
+{
     ObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, true);
+    ObjectCapacity = objectCount;
+}
+
+void FrameResource::EnsureChunkCmdLists(ID3D12Device* device, UINT chunkCount)
+{
+    if (PostCmdList == nullptr)
+    {
+        ThrowIfFailed(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            CmdListAlloc.Get(), nullptr, IID_PPV_ARGS(PostCmdList.GetAddressOf())));
+        ThrowIfFailed(PostCmdList->Close());
+    }
+
+    while (ChunkCmdLists.size() < chunkCount)
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> alloc;
+        ThrowIfFailed(device->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(alloc.GetAddressOf())));
+
+        // Lists are created open, close them so they can be reset like the others
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> cmdList;
+        ThrowIfFailed(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            alloc.Get(), nullptr, IID_PPV_ARGS(cmdList.GetAddressOf())));
+        ThrowIfFailed(cmdList->Close());
+
+        ChunkCmdListAllocs.push_back(alloc);
+        ChunkCmdLists.push_back(cmdList);
+    }
 }
 
 FrameResource::~FrameResource()
 {
-    Sleep(15);
 }
\ No newline at end of file
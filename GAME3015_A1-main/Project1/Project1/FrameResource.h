@@ -3,38 +3,8 @@
 #include "../../Common/d3dUtil.h"
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
-
-struct ObjectConstants
-{
-    DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
-	DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
-};
-
-struct PassConstants
-{
-    DirectX::XMFLOAT4X4 View = MathHelper::Identity4x4();
-    DirectX::XMFLOAT4X4 InvView = MathHelper::Identity4x4();
-    DirectX::XMFLOAT4X4 Proj = MathHelper::Identity4x4();
-    DirectX::XMFLOAT4X4 InvProj = MathHelper::Identity4x4();
-    DirectX::XMFLOAT4X4 ViewProj = MathHelper::Identity4x4();
-    DirectX::XMFLOAT4X4 InvViewProj = MathHelper::Identity4x4();
-    DirectX::XMFLOAT3 EyePosW = { 0.0f, 0.0f, 0.0f };
-    float cbPerObjectPad1 = 0.0f;
-    DirectX::XMFLOAT2 RenderTargetSize = { 0.0f, 0.0f };
-    DirectX::XMFLOAT2 InvRenderTargetSize = { 0.0f, 0.0f };
-    float NearZ = 0.0f;
-    float FarZ = 0.0f;
-    float TotalTime = 0.0f;
-    float DeltaTime = 0.0f;
-
-    DirectX::XMFLOAT4 AmbientLight = { 0.0f, 0.0f, 0.0f, 1.0f };
-
-    // Indices [0, NUM_DIR_LIGHTS) are directional lights;
-    // indices [NUM_DIR_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHTS) are point lights;
-    // indices [NUM_DIR_LIGHTS+NUM_POINT_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHT+NUM_SPOT_LIGHTS)
-    // are spot lights for a maximum of MaxLights per object.
-    Light Lights[MaxLights];
-};
+#include "LinearAllocator.hpp"
+#include "ShaderConstants.hpp"
 
 struct Vertex
 {
@@ -55,16 +25,40 @@ public:
     FrameResource& operator=(const FrameResource& rhs) = delete;
     ~FrameResource();
 
+    // Replaces the object buffer with an empty one holding objectCount objects.
+    // The old buffer must be kept alive until the GPU has finished with it.
+    void ResizeObjectCB(ID3D12Device* device, UINT objectCount);
+
+    // Creates command lists until there are chunkCount chunk lists and a post list.
+    void EnsureChunkCmdLists(ID3D12Device* device, UINT chunkCount);
+
     // We cannot reset the allocator until the GPU is done processing the commands.
     // So each frame needs their own allocator.
     Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAlloc;
 
+    // Command lists the scene draws are recorded into in parallel, each with
+    // its own allocator, and the list recorded after them from CmdListAlloc.
+    std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> ChunkCmdListAllocs;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> ChunkCmdLists;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> PostCmdList;
+
     // We cannot update a cbuffer until the GPU is done processing the commands
     // that reference it.  So each frame needs their own cbuffers.
    // std::unique_ptr<UploadBuffer<FrameConstants>> FrameCB = nullptr;
     std::unique_ptr<UploadBuffer<PassConstants>> PassCB = nullptr;
     std::unique_ptr<UploadBuffer<MaterialConstants>> MaterialCB = nullptr;
     std::unique_ptr<UploadBuffer<ObjectConstants>> ObjectCB = nullptr;
+    UINT ObjectCapacity = 0;
+
+    // Transient upload memory for data written once per frame, such as the
+    // instance indices. Reset when the frame's fence has been reached.
+    std::unique_ptr<LinearAllocator> FrameAllocator = nullptr;
+
+    // Instance indices uploaded this frame, bound again by every chunk list.
+    D3D12_GPU_VIRTUAL_ADDRESS InstanceObjects = 0;
+
+    // World positions of the instances of position draws, uploaded and bound alike.
+    D3D12_GPU_VIRTUAL_ADDRESS InstancePositions = 0;
 
     // Fence value to mark commands up to this fence point.  This lets us
     // check if these frame resources are still in use by the GPU.
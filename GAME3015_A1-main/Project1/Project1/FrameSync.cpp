@@ -0,0 +1,100 @@
+//***************************************************************************************
+// FrameSync.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "FrameSync.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+// Constructor, framesInFlight is the number of frames the CPU may run ahead of the GPU
+FrameSync::FrameSync(std::unique_ptr<FrameFence> fence, unsigned int framesInFlight)
+	: mFence(std::move(fence))
+	, mSlotFences(std::max(1u, framesInFlight), 0)
+	, mCurrentSlot((unsigned int)mSlotFences.size() - 1)
+	, mLastSignalled(0)
+	, mWaitStats()
+{
+}
+
+// Advances to the next slot and waits until the GPU is done with its previous frame; returns the slot
+unsigned int FrameSync::beginFrame()
+{
+	mCurrentSlot = (mCurrentSlot + 1) % (unsigned int)mSlotFences.size();
+
+	const uint64_t value = mSlotFences[mCurrentSlot];
+	float waitMs = 0.0f;
+	if (value != 0 && mFence->getCompletedValue() < value)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		mFence->wait(value, mCurrentSlot);
+		std::chrono::duration<float, std::milli> waited = std::chrono::high_resolution_clock::now() - start;
+
+		waitMs = waited.count();
+		mWaitStats.StalledFrames++;
+	}
+
+	mWaitStats.LastMs = waitMs;
+	mWaitStats.MaxMs = std::max(mWaitStats.MaxMs, waitMs);
+	mWaitStats.TotalMs += waitMs;
+	mWaitStats.Frames++;
+
+	return mCurrentSlot;
+}
+
+// Signals the fence behind the frame just submitted and returns its value
+uint64_t FrameSync::endFrame()
+{
+	mSlotFences[mCurrentSlot] = ++mLastSignalled;
+	mFence->signal(mLastSignalled);
+	return mLastSignalled;
+}
+
+// Waits until every submitted frame has completed
+void FrameSync::flush()
+{
+	if (mLastSignalled != 0 && mFence->getCompletedValue() < mLastSignalled)
+		mFence->wait(mLastSignalled, mCurrentSlot);
+}
+
+// Returns the number of frame slots
+unsigned int FrameSync::getFramesInFlight() const
+{
+	return (unsigned int)mSlotFences.size();
+}
+
+// Returns the slot of the frame being recorded
+unsigned int FrameSync::getCurrentSlot() const
+{
+	return mCurrentSlot;
+}
+
+// Returns the fence value of the last frame recorded into a slot
+uint64_t FrameSync::getSlotFence(unsigned int slot) const
+{
+	return mSlotFences[slot];
+}
+
+// Returns the last fence value the GPU has reached
+uint64_t FrameSync::getCompletedValue() const
+{
+	return mFence->getCompletedValue();
+}
+
+// Returns the fence the frames are paced on
+FrameFence& FrameSync::getFence()
+{
+	return *mFence;
+}
+
+// Returns the CPU wait times recorded so far
+const FrameSync::WaitStats& FrameSync::getWaitStats() const
+{
+	return mWaitStats;
+}
+
+// Clears the recorded wait times
+void FrameSync::resetWaitStats()
+{
+	mWaitStats = WaitStats();
+}
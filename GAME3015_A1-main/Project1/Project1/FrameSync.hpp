@@ -0,0 +1,50 @@
+#pragma once
+#include "FrameFence.hpp"
+
+#include <memory>
+#include <vector>
+
+// Paces the CPU against the GPU over a ring of frames in flight. beginFrame()
+// moves to the next slot and waits until the GPU has finished the frame that
+// last used it; endFrame() signals the fence behind the frame just submitted.
+class FrameSync
+{
+public:
+	// CPU time spent waiting on the GPU in beginFrame()
+	struct WaitStats
+	{
+		float LastMs = 0.0f;
+		float MaxMs = 0.0f;
+		double TotalMs = 0.0;
+		uint64_t Frames = 0;
+		uint64_t StalledFrames = 0;
+	};
+
+
+public:
+									FrameSync(std::unique_ptr<FrameFence> fence, unsigned int framesInFlight);
+
+	unsigned int					beginFrame();
+	uint64_t						endFrame();
+	void							flush();
+
+	unsigned int					getFramesInFlight() const;
+	unsigned int					getCurrentSlot() const;
+	uint64_t						getSlotFence(unsigned int slot) const;
+	uint64_t						getCompletedValue() const;
+	FrameFence&						getFence();
+
+	const WaitStats&				getWaitStats() const;
+	void							resetWaitStats();
+
+
+private:
+	std::unique_ptr<FrameFence>		mFence;
+
+	// Fence value signalled behind the last frame of each slot, 0 if none yet
+	std::vector<uint64_t>			mSlotFences;
+	unsigned int					mCurrentSlot;
+	uint64_t						mLastSignalled;
+
+	WaitStats						mWaitStats;
+};
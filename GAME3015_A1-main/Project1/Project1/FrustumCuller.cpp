@@ -0,0 +1,174 @@
+//***************************************************************************************
+// FrustumCuller.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "FrustumCuller.hpp"
+#include "RenderItem.hpp"
+
+#include <cmath>
+
+using namespace DirectX;
+
+// Constructor, the planes start out accepting everything until a view is set
+FrustumCuller::FrustumCuller()
+{
+	for (int i = 0; i < PlaneCount; ++i)
+		mPlanes[i] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+// Extracts the frustum planes from a view-projection matrix.
+// With row vectors a point is inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w
+// in clip space; each inequality is a plane built from the columns of the matrix.
+void FrustumCuller::setViewProj(FXMMATRIX viewProj)
+{
+	XMMATRIX columns = XMMatrixTranspose(viewProj);
+
+	XMVECTOR planes[PlaneCount] =
+	{
+		XMVectorAdd(columns.r[3], columns.r[0]),		// left
+		XMVectorSubtract(columns.r[3], columns.r[0]),	// right
+		XMVectorAdd(columns.r[3], columns.r[1]),		// bottom
+		XMVectorSubtract(columns.r[3], columns.r[1]),	// top
+		columns.r[2],									// near
+		XMVectorSubtract(columns.r[3], columns.r[2]),	// far
+	};
+
+	for (int i = 0; i < PlaneCount; ++i)
+		XMStoreFloat4(&mPlanes[i], XMPlaneNormalize(planes[i]));
+}
+
+// Sets visible[i] to 1 if the bounds of items[i] intersect the frustum and to 0 otherwise
+void FrustumCuller::cull(const RenderItem* const* items, size_t count, std::vector<UINT8>& visible)
+{
+	visible.resize(count);
+	if (count == 0)
+		return;
+
+	stageBoxes(items, count);
+	testBoxes(count, visible);
+}
+
+// Sets visible[i] to 1 if item drawn at positions[i], its translation replaced, intersects the frustum
+// and to 0 otherwise
+void FrustumCuller::cullInstances(const RenderItem& item, const XMFLOAT3* positions, size_t count, std::vector<UINT8>& visible)
+{
+	visible.resize(count);
+	if (count == 0)
+		return;
+
+	stageInstanceBoxes(item, positions, count);
+	testBoxes(count, visible);
+}
+
+// Sets visible[i] to 1 if the staged box i intersects the frustum and to 0 otherwise
+void FrustumCuller::testBoxes(size_t count, std::vector<UINT8>& visible) const
+{
+	const XMVECTOR zero = XMVectorZero();
+	for (size_t i = 0; i < count; i += 4)
+	{
+		const XMVECTOR cx = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCenterX[i]));
+		const XMVECTOR cy = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCenterY[i]));
+		const XMVECTOR cz = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCenterZ[i]));
+		const XMVECTOR ex = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mExtentX[i]));
+		const XMVECTOR ey = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mExtentY[i]));
+		const XMVECTOR ez = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mExtentZ[i]));
+
+		// A box is outside a plane when its center lies further behind it than its projected radius
+		XMVECTOR inside = XMVectorTrueInt();
+		for (int p = 0; p < PlaneCount; ++p)
+		{
+			const XMFLOAT4& plane = mPlanes[p];
+
+			XMVECTOR distance = XMVectorMultiplyAdd(cx, XMVectorReplicate(plane.x), XMVectorReplicate(plane.w));
+			distance = XMVectorMultiplyAdd(cy, XMVectorReplicate(plane.y), distance);
+			distance = XMVectorMultiplyAdd(cz, XMVectorReplicate(plane.z), distance);
+
+			XMVECTOR radius = XMVectorMultiply(ex, XMVectorReplicate(fabsf(plane.x)));
+			radius = XMVectorMultiplyAdd(ey, XMVectorReplicate(fabsf(plane.y)), radius);
+			radius = XMVectorMultiplyAdd(ez, XMVectorReplicate(fabsf(plane.z)), radius);
+
+			inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorAdd(distance, radius), zero));
+		}
+
+		XMUINT4 mask;
+		XMStoreUInt4(&mask, inside);
+		const UINT lanes[4] = { mask.x, mask.y, mask.z, mask.w };
+		for (size_t lane = 0; lane < 4 && i + lane < count; ++lane)
+			visible[i + lane] = lanes[lane] != 0 ? 1 : 0;
+	}
+}
+
+// Transforms the object space bounds of every item to a world space box and stores it as structure-of-arrays
+void FrustumCuller::stageBoxes(const RenderItem* const* items, size_t count)
+{
+	padBoxes(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const RenderItem& item = *items[i];
+		const XMMATRIX world = XMLoadFloat4x4(&item.World);
+
+		// With row vectors the extent along each world axis is the sum of the
+		// absolute rows of the matrix, weighted by the object space extents
+		const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&item.Bounds.Center), world);
+		XMVECTOR extents = XMVectorMultiply(XMVectorAbs(world.r[0]), XMVectorReplicate(item.Bounds.Extents.x));
+		extents = XMVectorMultiplyAdd(XMVectorAbs(world.r[1]), XMVectorReplicate(item.Bounds.Extents.y), extents);
+		extents = XMVectorMultiplyAdd(XMVectorAbs(world.r[2]), XMVectorReplicate(item.Bounds.Extents.z), extents);
+
+		XMFLOAT3 c, e;
+		XMStoreFloat3(&c, center);
+		XMStoreFloat3(&e, extents);
+		mCenterX[i] = c.x;
+		mCenterY[i] = c.y;
+		mCenterZ[i] = c.z;
+		mExtentX[i] = e.x;
+		mExtentY[i] = e.y;
+		mExtentZ[i] = e.z;
+	}
+}
+
+// Stores the world space box of an item at every position as structure-of-arrays; the boxes only
+// differ by their translation, so the item's bounds are transformed once
+void FrustumCuller::stageInstanceBoxes(const RenderItem& item, const XMFLOAT3* positions, size_t count)
+{
+	padBoxes(count);
+
+	XMMATRIX world = XMLoadFloat4x4(&item.World);
+	world.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+
+	XMFLOAT3 c, e;
+	XMStoreFloat3(&c, XMVector3TransformCoord(XMLoadFloat3(&item.Bounds.Center), world));
+	XMVECTOR extents = XMVectorMultiply(XMVectorAbs(world.r[0]), XMVectorReplicate(item.Bounds.Extents.x));
+	extents = XMVectorMultiplyAdd(XMVectorAbs(world.r[1]), XMVectorReplicate(item.Bounds.Extents.y), extents);
+	extents = XMVectorMultiplyAdd(XMVectorAbs(world.r[2]), XMVectorReplicate(item.Bounds.Extents.z), extents);
+	XMStoreFloat3(&e, extents);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		mCenterX[i] = positions[i].x + c.x;
+		mCenterY[i] = positions[i].y + c.y;
+		mCenterZ[i] = positions[i].z + c.z;
+		mExtentX[i] = e.x;
+		mExtentY[i] = e.y;
+		mExtentZ[i] = e.z;
+	}
+}
+
+// Sizes the box arrays for count boxes padded to a multiple of four. Padding lanes hold empty
+// boxes at the origin; their results are never read
+void FrustumCuller::padBoxes(size_t count)
+{
+	const size_t padded = (count + 3) & ~(size_t)3;
+	mCenterX.resize(padded);
+	mCenterY.resize(padded);
+	mCenterZ.resize(padded);
+	mExtentX.resize(padded);
+	mExtentY.resize(padded);
+	mExtentZ.resize(padded);
+
+	for (size_t i = count; i < padded; ++i)
+	{
+		mCenterX[i] = mCenterY[i] = mCenterZ[i] = 0.0f;
+		mExtentX[i] = mExtentY[i] = mExtentZ[i] = 0.0f;
+	}
+}
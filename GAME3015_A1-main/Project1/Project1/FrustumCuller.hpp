@@ -0,0 +1,52 @@
+#pragma once
+#include "../../Common/MathHelper.h"
+
+#include <vector>
+
+struct RenderItem;
+
+// Drops render items whose world space bounds lie outside the view frustum.
+// The six frustum planes are extracted from a camera's view-projection
+// matrix; the items' world boxes are staged as structure-of-arrays so four
+// boxes are tested against a plane with each SIMD instruction.
+class FrustumCuller
+{
+public:
+	struct Stats
+	{
+		UINT Visible = 0;
+		UINT Culled = 0;
+	};
+
+
+public:
+									FrustumCuller();
+
+	void							setViewProj(DirectX::FXMMATRIX viewProj);
+
+	void							cull(const RenderItem* const* items, size_t count, std::vector<UINT8>& visible);
+	void							cullInstances(const RenderItem& item, const DirectX::XMFLOAT3* positions, size_t count,
+										std::vector<UINT8>& visible);
+
+
+private:
+	void							stageBoxes(const RenderItem* const* items, size_t count);
+	void							stageInstanceBoxes(const RenderItem& item, const DirectX::XMFLOAT3* positions, size_t count);
+	void							padBoxes(size_t count);
+	void							testBoxes(size_t count, std::vector<UINT8>& visible) const;
+
+
+private:
+	static const int				PlaneCount = 6;
+
+	// Inward facing, normalized planes (a, b, c, d): inside where ax + by + cz + d >= 0
+	DirectX::XMFLOAT4				mPlanes[PlaneCount];
+
+	// World space box centers and extents, padded to a multiple of four
+	std::vector<float>				mCenterX;
+	std::vector<float>				mCenterY;
+	std::vector<float>				mCenterZ;
+	std::vector<float>				mExtentX;
+	std::vector<float>				mExtentY;
+	std::vector<float>				mExtentZ;
+};
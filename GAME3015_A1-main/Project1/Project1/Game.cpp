@@ -7,7 +7,10 @@
 #include "TitleState.hpp"
 #include "MenuState.h"
 #include "PauseState.h"
+#include "LoadingState.hpp"
 #include "StateIdentifiers.hpp"
+#include "D3D12RenderDevice.hpp"
+#include "D3D12FrameFence.hpp"
 
 const int gNumFrameResources = 3;
 
@@ -16,6 +19,9 @@ Game::Game(HINSTANCE hInstance)
 	: D3DApp(hInstance)
 	, mPlayer()
 	, mStateStack(State::Context(this, &mPlayer))
+	, mScheduler(TaskScheduler::hardwareWorkerCount())
+	, mRenderDevice(std::make_unique<D3D12RenderDevice>(this))
+	, mDrawChunkCount(std::min(mScheduler.getWorkerCount() + 1, 8u))
 {
 }
 
@@ -24,6 +30,8 @@ Game::~Game()
 {
 	if (md3dDevice != nullptr)
 		FlushCommandQueue();
+
+	mReleaseQueue.clear();
 }
 
 // Initializes the game, returns true if successful
@@ -41,6 +49,10 @@ bool Game::Initialize()
 	mCamera.SetPosition(0.0f, 54.0f, 0.0f);
 	mCamera.Pitch(3.14f / 2.0f);
 
+	// Pace the frames in flight on a fence of their own
+	mFrameSync = std::make_unique<FrameSync>(
+		std::make_unique<D3D12FrameFence>(md3dDevice.Get(), mCommandQueue.Get(), mFramesInFlight), mFramesInFlight);
+
 	// Reset command list
 	ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
 
@@ -53,6 +65,7 @@ bool Game::Initialize()
 	BuildShadersAndInputLayout();
 	BuildShapeGeometry();
 	BuildMaterials();
+	BuildFrameResources();
 	RegisterStates();
 	mStateStack.pushState(States::Title);
 	BuildPSOs();
@@ -66,6 +79,27 @@ bool Game::Initialize()
 	return true;
 }
 
+// Sets how many frames the CPU may record ahead of the GPU; only takes effect before Initialize
+void Game::setFramesInFlight(unsigned int count)
+{
+	// Dirty frame masks hold one bit per frame resource
+	mFramesInFlight = std::min(std::max(count, 1u), 32u);
+}
+
+// Replaces the device that receives uploads and draws, e.g. with a RecordingRenderDevice
+void Game::setRenderDevice(std::unique_ptr<RenderDevice> device)
+{
+	// Chunk lists always record through D3D12, so a replacement device gets every draw
+	mRenderDevice = std::move(device);
+	mDrawChunkCount = 1;
+}
+
+// Sets how many command lists the scene draws may be split across; 1 records everything on the main list
+void Game::setDrawChunkCount(unsigned int count)
+{
+	mDrawChunkCount = std::max(count, 1u);
+}
+
 // Called when the window is resized, updates camera lens
 void Game::OnResize()
 {
@@ -76,12 +110,19 @@ void Game::OnResize()
 	mCamera.SetLens(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
 }
 
-// Updates the game, including state stack, camera, and constant buffers
-void Game::Update(const GameTimer& gt)
+// Advances the simulation by one fixed step
+void Game::FixedUpdate(const GameTimer& gt)
 {
+	if (mStateStack.isEmpty())
+		return;
+
 	mStateStack.update(gt);
 	mStateStack.handleRealtimeInput();
+}
 
+// Updates the camera and constant buffers for the frame about to be drawn
+void Game::Update(const GameTimer& gt)
+{
 	// Quit the game if state stack is empty
 	if (mStateStack.isEmpty())
 	{
@@ -89,23 +130,26 @@ void Game::Update(const GameTimer& gt)
 		return;
 	}
 
+	// Place the render items between the last two simulation steps and queue their uploads
+	mStateStack.interpolate(InterpolationAlpha(), mChangedObjects);
+	for (RenderItem* item : mChangedObjects)
+		mFrameConstants.markObjectDirty(item);
+	mChangedObjects.clear();
+
 	UpdateCamera(gt);
 
-	// Get the current frame resource and advance to the next one
-	mCurrFrameResourceIndex = (mCurrFrameResourceIndex + 1) % gNumFrameResources;
+	// Advance to the next frame resource, waiting for the GPU to finish its last frame if necessary
+	mCurrFrameResourceIndex = mFrameSync->beginFrame();
 	mCurrFrameResource = mFrameResources[mCurrFrameResourceIndex].get();
 
-	// Wait for the previous frame resource to complete if necessary
-	if (mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-	{
-		HANDLE eventHandle = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
-		ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-		WaitForSingleObject(eventHandle, INFINITE);
-		CloseHandle(eventHandle);
-	}
+	// Free whatever the GPU has finished with
+	mReleaseQueue.collect(mFrameSync->getCompletedValue());
 
-	UpdateObjectCBs(gt);
-	UpdateMaterialCBs(gt);
+	// The GPU is done with this frame resource, so its transient memory can be reused
+	mCurrFrameResource->FrameAllocator->reset();
+	EnsureObjectCapacity();
+
+	mFrameConstants.upload(mCurrFrameResourceIndex, *mRenderDevice);
 	UpdateMainPassCB(gt);
 }
 
@@ -121,10 +165,6 @@ void Game::Draw(const GameTimer& gt)
 	// Reset the command list with the opaque pipeline state object (PSO)
 	ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mOpaquePSO.Get()));
 
-	// Set the viewport and scissor rectangle
-	mCommandList->RSSetViewports(1, &mScreenViewport);
-	mCommandList->RSSetScissorRects(1, &mScissorRect);
-
 	// Transition the back buffer to the render target state
 	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
 		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
@@ -133,33 +173,49 @@ void Game::Draw(const GameTimer& gt)
 	mCommandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
 	mCommandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
 
-	// Set the render target and depth stencil view
-	mCommandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
+	PrepareCommandList(mCommandList.Get());
 
-	// Set the descriptor heap
-	ID3D12DescriptorHeap* descriptorHeaps[] = { mSrvDescriptorHeap.Get() };
-	mCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+	// Bind the pass constants and the object and instance buffers
+	mRenderDevice->beginPass();
 
-	// Set the root signature
-	mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
+	// Collect the render items of the state stack, drop those outside the view and sort the rest into instanced batches, nearest first
+	mRenderBatcher.setView(mCamera.GetPosition3f(), mCamera.GetLook3f(), mCamera.GetFarZ());
+	mRenderBatcher.clear();
+	mStateStack.draw();
+	mFrustumCuller.setViewProj(XMMatrixMultiply(mCamera.GetView(), mCamera.GetProj()));
+	mCullStats = mRenderBatcher.cull(mFrustumCuller);
+	mRenderBatcher.build();
 
-	// Set the constant buffer view for the pass constant buffer
-	auto passCB = mCurrFrameResource->PassCB->Resource();
-	mCommandList->SetGraphicsRootConstantBufferView(2, passCB->GetGPUVirtualAddress());
+	mSubmitLists.clear();
+	mSubmitLists.push_back(mCommandList.Get());
 
-	// Draw the objects in the state stack
-	mStateStack.draw();
+	std::vector<RenderChunk> chunks = mRenderBatcher.partition(mDrawChunkCount, RenderBatcher::MinBatchesPerChunk);
+	ID3D12GraphicsCommandList* lastList = mCommandList.Get();
+	if (chunks.size() > 1)
+	{
+		// Record the draws on worker threads, one command list per chunk, and finish the frame on the post list
+		mRenderBatcher.uploadInstances(*mRenderDevice);
+		ThrowIfFailed(mCommandList->Close());
+
+		mRenderStateStats = RecordDrawChunks(chunks);
+
+		lastList = mCurrFrameResource->PostCmdList.Get();
+		ThrowIfFailed(lastList->Reset(cmdListAlloc.Get(), nullptr));
+	}
+	else
+	{
+		mRenderStateStats = mRenderBatcher.execute(*mRenderDevice);
+	}
 
 	// Transition the back buffer to the present state
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
+	lastList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
 		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
 
-	// Close the command list
-	ThrowIfFailed(mCommandList->Close());
-
-	// Execute the command list
-	ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
-	mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+	// Close the last command list and execute them all in recording order
+	ThrowIfFailed(lastList->Close());
+	if (lastList != mCommandList.Get())
+		mSubmitLists.push_back(lastList);
+	mCommandQueue->ExecuteCommandLists((UINT)mSubmitLists.size(), mSubmitLists.data());
 
 	// Present the current back buffer to the screen
 	ThrowIfFailed(mSwapChain->Present(0, 0));
@@ -168,8 +224,54 @@ void Game::Draw(const GameTimer& gt)
 	mCurrBackBuffer = (mCurrBackBuffer + 1) % SwapChainBufferCount;
 
 	// Signal the fence value for the current frame resource.
-	mCurrFrameResource->Fence = ++mCurrentFence;
-	mCommandQueue->Signal(mFence.Get(), mCurrentFence);
+	mCurrFrameResource->Fence = mFrameSync->endFrame();
+}
+
+// Sets the viewport, render target, descriptor heap and root signature every scene command list starts with
+void Game::PrepareCommandList(ID3D12GraphicsCommandList* cmdList)
+{
+	cmdList->RSSetViewports(1, &mScreenViewport);
+	cmdList->RSSetScissorRects(1, &mScissorRect);
+	cmdList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
+
+	ID3D12DescriptorHeap* descriptorHeaps[] = { mSrvDescriptorHeap.Get() };
+	cmdList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+	cmdList->SetGraphicsRootSignature(mRootSignature.Get());
+}
+
+// Records the batches of each chunk into its own command list of the current frame resource, in parallel
+RenderStateStats Game::RecordDrawChunks(const std::vector<RenderChunk>& chunks)
+{
+	const UINT chunkCount = (UINT)chunks.size();
+	mCurrFrameResource->EnsureChunkCmdLists(md3dDevice.Get(), chunkCount);
+
+	while (mChunkDevices.size() < chunkCount)
+		mChunkDevices.push_back(std::make_unique<D3D12RenderDevice>(this));
+
+	// Command lists do not inherit state, so each one binds the pass again before its draws
+	mChunkDeviceList.clear();
+	for (UINT i = 0; i < chunkCount; ++i)
+	{
+		ID3D12GraphicsCommandList* cmdList = mCurrFrameResource->ChunkCmdLists[i].Get();
+		ThrowIfFailed(mCurrFrameResource->ChunkCmdListAllocs[i]->Reset());
+		ThrowIfFailed(cmdList->Reset(mCurrFrameResource->ChunkCmdListAllocs[i].Get(), mOpaquePSO.Get()));
+		PrepareCommandList(cmdList);
+
+		D3D12RenderDevice* device = mChunkDevices[i].get();
+		device->setCommandList(cmdList);
+		device->beginPass();
+		device->bindInstanceObjects();
+		mChunkDeviceList.push_back(device);
+	}
+
+	RenderStateStats stats = mRenderBatcher.executeChunks(chunks, mChunkDeviceList, mScheduler);
+
+	for (UINT i = 0; i < chunkCount; ++i)
+	{
+		ThrowIfFailed(mCurrFrameResource->ChunkCmdLists[i]->Close());
+		mSubmitLists.push_back(mCurrFrameResource->ChunkCmdLists[i].Get());
+	}
+	return stats;
 }
 
 void Game::OnMouseDown(WPARAM btnState, int x, int y)
@@ -208,62 +310,6 @@ void Game::AnimateMaterials(const GameTimer& gt)
 {
 
 }
-// Updates the constant buffers for all objects in the current state's render items
-void Game::UpdateObjectCBs(const GameTimer& gt)
-{
-	State* currentState = mStateStack.getCurrentState();
-
-	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
-	for (auto& e : currentState->getRenderItems())
-	{
-		if (e->NumFramesDirty > 0)
-		{
-			// Load the world and texture transform matrices for the render item
-			XMMATRIX world = XMLoadFloat4x4(&e->World);
-			XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
-
-			// Copy the world and texture transform matrices to an object constants struct
-			ObjectConstants objConstants;
-			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-			XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
-
-			// Copy the object constants to the current frame's object constant buffer at the render item's index
-			currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-
-			// Decrement the number of frames dirty for the render item
-			e->NumFramesDirty--;
-		}
-	}
-}
-
-// Updates the constant buffers for all materials in the game
-void Game::UpdateMaterialCBs(const GameTimer& gt)
-{
-	auto currMaterialCB = mCurrFrameResource->MaterialCB.get();
-	for (auto& e : mMaterials)
-	{
-		Material* mat = e.second.get();
-		if (mat->NumFramesDirty > 0)
-		{
-			// Load the material transform matrix for the material
-			XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
-
-			// Copy the material properties to a material constants struct
-			MaterialConstants matConstants;
-			matConstants.DiffuseAlbedo = mat->DiffuseAlbedo;
-			matConstants.FresnelR0 = mat->FresnelR0;
-			matConstants.Roughness = mat->Roughness;
-			XMStoreFloat4x4(&matConstants.MatTransform, XMMatrixTranspose(matTransform));
-
-			// Copy the material constants to the current frame's material constant buffer at the material's index
-			currMaterialCB->CopyData(mat->MatCBIndex, matConstants);
-
-			// Decrement the number of frames dirty for the material
-			mat->NumFramesDirty--;
-		}
-	}
-}
-
 void Game::UpdateMainPassCB(const GameTimer& gt)
 {
 	// Get the camera's view and projection matrices
@@ -303,8 +349,7 @@ void Game::UpdateMainPassCB(const GameTimer& gt)
 	mMainPassCB.Lights[2].Strength = { 0.15f, 0.15f, 0.15f };
 
 	// Copy the data to the current frame resource's pass constant buffer
-	auto currPassCB = mCurrFrameResource->PassCB.get();
-	currPassCB->CopyData(0, mMainPassCB);
+	mRenderDevice->uploadPassConstants(mMainPassCB);
 }
 
 // Load different textures
@@ -390,17 +435,21 @@ void Game::BuildRootSignature()
 	texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
 
 	// Initialize the root parameters for the root signature
-	CD3DX12_ROOT_PARAMETER slotRootParameter[4];
+	// Object data, instance indices and instance positions are root SRVs so one draw can address many objects
+	CD3DX12_ROOT_PARAMETER slotRootParameter[7];
 	slotRootParameter[0].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL);
-	slotRootParameter[1].InitAsConstantBufferView(0);
+	slotRootParameter[1].InitAsShaderResourceView(0, 1);
 	slotRootParameter[2].InitAsConstantBufferView(1);
 	slotRootParameter[3].InitAsConstantBufferView(2);
+	slotRootParameter[4].InitAsShaderResourceView(1, 1);
+	slotRootParameter[5].InitAsConstants(2, 0);
+	slotRootParameter[6].InitAsShaderResourceView(2, 1);
 
 	// Get the static samplers for the root signature
 	auto staticSamplers = GetStaticSamplers();
 
 	// Initialize the root signature descriptor
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(4, slotRootParameter,
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(7, slotRootParameter,
 		(UINT)staticSamplers.size(), staticSamplers.data(),  
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
@@ -516,7 +565,6 @@ void Game::BuildShapeGeometry()
 	boxSubmesh.StartIndexLocation = 0;
 	boxSubmesh.BaseVertexLocation = 0;
 
-
 	// Convert the mesh data into our own custom vertex format
 	// We create a vector of Vertex objects and copy over the position, normal, and texture coordinates from the mesh data
 	std::vector<Vertex> vertices(box.Vertices.size());
@@ -527,6 +575,9 @@ void Game::BuildShapeGeometry()
 		vertices[i].TexC = box.Vertices[i].TexC;
 	}
 
+	// Bound the submesh in object space, so render items can be culled against the view frustum
+	BoundingBox::CreateFromPoints(boxSubmesh.Bounds, vertices.size(), &vertices[0].Pos, sizeof(Vertex));
+
 	// Get the index data for the box mesh
 	// We store the indices as a vector of 16-bit integers
 	std::vector<std::uint16_t> indices = box.GetIndices16();
@@ -615,24 +666,35 @@ void Game::BuildPSOs()
 	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&opaquePsoDesc, IID_PPV_ARGS(&mOpaquePSO)));
 }
 
-void Game::BuildFrameResources(int renderItemCount)
+void Game::BuildFrameResources()
 {
-
-	// Create gNumFrameResources number of unique frame resources
-	for (int i = 0; i < gNumFrameResources; ++i)
+	// Create one frame resource per frame in flight, once for the whole game.
+	// Object buffers start small and grow with the number of object slots in use.
+	for (unsigned int i = 0; i < mFrameSync->getFramesInFlight(); ++i)
 	{
 		mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(),
-			1, (UINT)renderItemCount, (UINT)mMaterials.size()));
-		// Each frame resource consists of one constant buffer and a number of render items
-		// The render item count is passed as a parameter to this function
-		// The number of unique materials is also stored in the frame resource
+			1, 64, (UINT)mMaterials.size()));
 	}
+	mFrameConstants.setFrameCount(mFrameSync->getFramesInFlight());
 }
 
-// Clear the list of frame resources
-void Game::ResetFrameResources()
+// Grows the current frame resource's object buffer to cover every published object slot
+void Game::EnsureObjectCapacity()
 {
-	mFrameResources.clear();
+	const size_t slotCount = mFrameConstants.getPublishedSlotEnd();
+	UINT capacity = mCurrFrameResource->ObjectCapacity;
+	if (slotCount <= capacity)
+		return;
+
+	while (capacity < slotCount)
+		capacity *= 2;
+
+	// Retire the old buffer behind the fence of the last frame that used it
+	mReleaseQueue.release(std::move(mCurrFrameResource->ObjectCB), mCurrFrameResource->Fence);
+	mCurrFrameResource->ResizeObjectCB(md3dDevice.Get(), capacity);
+
+	// The new buffer starts out empty, so every live object has to be uploaded to it
+	mFrameConstants.markAllObjectsDirty(mCurrFrameResourceIndex);
 }
 
 // Create materials with different properties
@@ -662,7 +724,8 @@ void Game::CreateMaterials(std::string Name, XMFLOAT4 DiffuseAlbedo, XMFLOAT3 Fr
 	material->FresnelR0 = FresnelR0;
 	material->Roughness = Roughness;
 
-	// Add the material to the game's collection of materials
+	// Add the material to the game's collection of materials and to the uploads of every frame
+	mFrameConstants.addMaterial(material.get());
 	mMaterials[Name] = std::move(material);
 }
 
@@ -674,6 +737,7 @@ void Game::RegisterStates()
 	mStateStack.registerState<GameState>(States::Game);
 	mStateStack.registerState<MenuState>(States::Menu);
 	mStateStack.registerState<PauseState>(States::Pause);
+	mStateStack.registerState<LoadingState>(States::Loading);
 }
 
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> Game::GetStaticSamplers()
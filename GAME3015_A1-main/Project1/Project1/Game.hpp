@@ -1,6 +1,12 @@
 #include "World.hpp"
 #include "Player.hpp"
 #include "StateStack.hpp"
+#include "TaskScheduler.hpp"
+#include "RenderBatcher.hpp"
+#include "D3D12RenderDevice.hpp"
+#include "DeferredReleaseQueue.hpp"
+#include "FrameSync.hpp"
+#include "FrameConstants.hpp"
 
 class Game : public D3DApp
 {
@@ -14,6 +20,7 @@ public:
 private:
 	virtual void OnResize()override;
 	//void ProcessInput();
+	virtual void FixedUpdate(const GameTimer& gt)override;
 	virtual void Update(const GameTimer& gt)override;
 	virtual void Draw(const GameTimer& gt)override;
 
@@ -25,9 +32,10 @@ private:
 	//void OnKeyboardInput(const GameTimer& gt);
 	void UpdateCamera(const GameTimer& gt);
 	void AnimateMaterials(const GameTimer& gt);
-	void UpdateObjectCBs(const GameTimer& gt);
-	void UpdateMaterialCBs(const GameTimer& gt);
 	void UpdateMainPassCB(const GameTimer& gt);
+
+	void PrepareCommandList(ID3D12GraphicsCommandList* cmdList);
+	RenderStateStats RecordDrawChunks(const std::vector<RenderChunk>& chunks);
 	
 	void CreateTexture(std::string Name, std::wstring FileName);
 	void CreateMaterials(std::string Name, XMFLOAT4 DiffuseAlbedo, XMFLOAT3 FresnelR0, float Roughness);
@@ -37,10 +45,21 @@ private:
 	std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
 public:
+	// Frames the CPU may record ahead of the GPU, and the fence pacing them
+	unsigned int mFramesInFlight = gNumFrameResources;
+	std::unique_ptr<FrameSync> mFrameSync;
 
 	std::vector<std::unique_ptr<FrameResource>> mFrameResources;
 	FrameResource* mCurrFrameResource = nullptr;
 	int mCurrFrameResourceIndex = 0;
+
+	// GPU objects waiting for the fence of their last use before they are freed
+	DeferredReleaseQueue mReleaseQueue;
+
+	// Object constant slots and dirty lists shared by all states, and the material constants.
+	// Declared before the state stack, whose states release their slots on destruction.
+	FrameConstants mFrameConstants;
+
 	int mCurrentMaterialCBIndex = 0; 
 	int mCurrentDiffuseSrvHeapIndex = 0; 
 	UINT mCbvSrvDescriptorSize = 0;
@@ -81,9 +100,28 @@ public:
 	//World mWorld;
 	Player mPlayer;
 	StateStack mStateStack;
+	TaskScheduler mScheduler;
+	RenderBatcher mRenderBatcher;
+	FrustumCuller mFrustumCuller;
+	std::unique_ptr<RenderDevice> mRenderDevice;
+
+	// Scene draws are split across up to this many command lists, recorded on the scheduler
+	unsigned int mDrawChunkCount;
+	std::vector<std::unique_ptr<D3D12RenderDevice>> mChunkDevices;
+	std::vector<RenderDevice*> mChunkDeviceList;
+	std::vector<ID3D12CommandList*> mSubmitLists;
+
+	// Geometry and material binds of the last frame's draws
+	RenderStateStats mRenderStateStats;
+
+	// Render items drawn and culled by the last frame
+	FrustumCuller::Stats mCullStats;
+
+	// Render items written by the last interpolation
+	std::vector<RenderItem*> mChangedObjects;
 	
-	void BuildFrameResources(int renderItemCount);
-	void ResetFrameResources();
+	void BuildFrameResources();
+	void EnsureObjectCapacity();
 	void BuildPSOs();
 	void BuildMaterials();
 	void LoadTextures();
@@ -93,6 +131,17 @@ public:
 	void BuildShapeGeometry();
 public:
 	ID3D12GraphicsCommandList*  getCmdList() { return mCommandList.Get(); }
+	TaskScheduler& getScheduler() { return mScheduler; }
+	RenderBatcher& getRenderBatcher() { return mRenderBatcher; }
+	RenderDevice& getRenderDevice() { return *mRenderDevice; }
+	void setRenderDevice(std::unique_ptr<RenderDevice> device);
+	void setDrawChunkCount(unsigned int count);
+	FrameConstants& getFrameConstants() { return mFrameConstants; }
+	const FrameConstants::UploadStats& getObjectUploadStats() const { return mFrameConstants.getUploadStats(); }
+	const RenderStateStats& getRenderStateStats() const { return mRenderStateStats; }
+	const FrustumCuller::Stats& getCullStats() const { return mCullStats; }
+	void setFramesInFlight(unsigned int count);
+	const FrameSync& getFrameSync() const { return *mFrameSync; }
 	//std::vector<std::unique_ptr<RenderItem>>& getRenderItems() { return mAllRitems; }
 	std::unordered_map<std::string, std::unique_ptr<Material>>& getMaterials() { return mMaterials; }
 	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>>& getGeometries() { return mGeometries; }
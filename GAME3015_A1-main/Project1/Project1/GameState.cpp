@@ -11,12 +11,8 @@ GameState::GameState(StateStack* stack, Context* context)
 	, mWorld(this)
 {
 	mAllRitems.clear();
-	mContext->game->ResetFrameResources();
-	mContext->game->BuildMaterials();
 	
 	mWorld.buildScene();
-	
-	mContext->game->BuildFrameResources(mAllRitems.size());
 }
 
 // Destructor
@@ -43,10 +39,9 @@ bool GameState::update(const GameTimer& gt)
 // Handles events for the game state
 bool GameState::handleEvent(WPARAM btnState)
 {
-	// If the P key is pressed, request to pop the current state and push the pause state onto the stack
+	// If the P key is pressed, push the pause state on top; the game stays alive underneath
 	if (d3dUtil::IsKeyDown('P'))
 	{
-		requestStackPop();
 		requestStackPush(States::Pause);
 	}
 	
@@ -59,6 +54,13 @@ bool GameState::handleRealtimeInput()
 	return true;
 }
 
+// Blends the scene graph and the objects outside it between their last two simulation steps
+void GameState::interpolate(float alpha, std::vector<RenderItem*>& changed)
+{
+	State::interpolate(alpha, changed);
+	mWorld.interpolate(alpha, changed);
+}
+
 // Processes input from the player
 void GameState::ProcessInput()
 {
@@ -14,6 +14,7 @@ public:
     virtual bool update(const GameTimer& gt)override;
     virtual bool handleEvent(WPARAM btnState)override;
     virtual bool handleRealtimeInput()override;
+    virtual void interpolate(float alpha, std::vector<RenderItem*>& changed)override;
 
     void ProcessInput();
 private:
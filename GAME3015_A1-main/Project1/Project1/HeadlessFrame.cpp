@@ -0,0 +1,96 @@
+//***************************************************************************************
+// HeadlessFrame.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "HeadlessFrame.hpp"
+
+using namespace DirectX;
+
+// Constructor, frames cycle through framesInFlight frame resources like Game's do
+HeadlessFrame::HeadlessFrame(RenderDevice& device, unsigned int framesInFlight)
+	: mDevice(device)
+	, mFrameConstants()
+	, mRenderBatcher()
+	, mFrustumCuller()
+	, mPassConstants()
+	, mEyePosition(0.0f, 0.0f, 0.0f)
+	, mLook(0.0f, 0.0f, 1.0f)
+	, mFarZ(0.0f)
+	, mFrameCount(0)
+	, mFrameIndex(0)
+	, mChangedObjects()
+	, mCullStats()
+	, mRenderStateStats()
+{
+	mFrameConstants.setFrameCount(framesInFlight);
+}
+
+// Returns the object slots and materials of the frames; render items are allocated here
+FrameConstants& HeadlessFrame::getFrameConstants()
+{
+	return mFrameConstants;
+}
+
+// Sets the camera of the pass constants, the culling frustum and the depth sort
+void HeadlessFrame::setCamera(FXMMATRIX view, CXMMATRIX proj, const XMFLOAT3& eyePosition, const XMFLOAT3& look, float farZ)
+{
+	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+
+	// Same layout Game::UpdateMainPassCB uploads
+	XMStoreFloat4x4(&mPassConstants.View, XMMatrixTranspose(view));
+	XMStoreFloat4x4(&mPassConstants.InvView, XMMatrixTranspose(XMMatrixInverse(nullptr, view)));
+	XMStoreFloat4x4(&mPassConstants.Proj, XMMatrixTranspose(proj));
+	XMStoreFloat4x4(&mPassConstants.InvProj, XMMatrixTranspose(XMMatrixInverse(nullptr, proj)));
+	XMStoreFloat4x4(&mPassConstants.ViewProj, XMMatrixTranspose(viewProj));
+	XMStoreFloat4x4(&mPassConstants.InvViewProj, XMMatrixTranspose(XMMatrixInverse(nullptr, viewProj)));
+	mPassConstants.EyePosW = eyePosition;
+	mPassConstants.FarZ = farZ;
+
+	mFrustumCuller.setViewProj(viewProj);
+	mEyePosition = eyePosition;
+	mLook = look;
+	mFarZ = farZ;
+}
+
+// Runs one frame in the order Game::Update and Game::Draw do: update, constant uploads, then the batched draws
+void HeadlessFrame::run(const UpdateFunction& update, const SubmitFunction& submit)
+{
+	// Queue the uploads of the render items the update moved
+	update(mChangedObjects);
+	for (RenderItem* item : mChangedObjects)
+		mFrameConstants.markObjectDirty(item);
+	mChangedObjects.clear();
+
+	// Frame resources are used round robin, as FrameSync hands them out
+	mFrameIndex = mFrameCount++ % mFrameConstants.getFrameCount();
+	mFrameConstants.upload(mFrameIndex, mDevice);
+	mDevice.uploadPassConstants(mPassConstants);
+
+	mDevice.beginPass();
+
+	// Collect, cull and batch the items, nearest first
+	mRenderBatcher.setView(mEyePosition, mLook, mFarZ);
+	mRenderBatcher.clear();
+	submit(mRenderBatcher);
+	mCullStats = mRenderBatcher.cull(mFrustumCuller);
+	mRenderBatcher.build();
+	mRenderStateStats = mRenderBatcher.execute(mDevice);
+}
+
+// Returns the frame resource the last frame used
+unsigned int HeadlessFrame::getFrameIndex() const
+{
+	return mFrameIndex;
+}
+
+// Returns the render items drawn and culled by the last frame
+const FrustumCuller::Stats& HeadlessFrame::getCullStats() const
+{
+	return mCullStats;
+}
+
+// Returns the geometry and material binds of the last frame's draws
+const RenderStateStats& HeadlessFrame::getRenderStateStats() const
+{
+	return mRenderStateStats;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "FrameConstants.hpp"
+#include "RenderBatcher.hpp"
+#include "FrustumCuller.hpp"
+
+#include <functional>
+#include <vector>
+
+// Runs the CPU side of Game's frame against any RenderDevice, without a window
+// or Direct3D: the update fills in the render items that moved, their object
+// constants go to the frame resource the frame lands on, then the submitted
+// items are culled, batched and drawn. With a RecordingRenderDevice the whole
+// frame becomes a command stream that tests and benchmarks can inspect.
+class HeadlessFrame
+{
+public:
+	typedef std::function<void(std::vector<RenderItem*>& changed)>	UpdateFunction;
+	typedef std::function<void(RenderBatcher& batcher)>				SubmitFunction;
+
+
+public:
+									HeadlessFrame(RenderDevice& device, unsigned int framesInFlight);
+
+	FrameConstants&					getFrameConstants();
+	void							setCamera(DirectX::FXMMATRIX view, DirectX::CXMMATRIX proj,
+										const DirectX::XMFLOAT3& eyePosition, const DirectX::XMFLOAT3& look, float farZ);
+
+	void							run(const UpdateFunction& update, const SubmitFunction& submit);
+
+	unsigned int					getFrameIndex() const;
+	const FrustumCuller::Stats&		getCullStats() const;
+	const RenderStateStats&			getRenderStateStats() const;
+
+
+private:
+	RenderDevice&					mDevice;
+	FrameConstants					mFrameConstants;
+	RenderBatcher					mRenderBatcher;
+	FrustumCuller					mFrustumCuller;
+
+	PassConstants					mPassConstants;
+	DirectX::XMFLOAT3				mEyePosition;
+	DirectX::XMFLOAT3				mLook;
+	float							mFarZ;
+
+	// Frames run so far, and the frame resource the last one used
+	unsigned int					mFrameCount;
+	unsigned int					mFrameIndex;
+
+	std::vector<RenderItem*>		mChangedObjects;
+	FrustumCuller::Stats			mCullStats;
+	RenderStateStats				mRenderStateStats;
+};
@@ -0,0 +1,71 @@
+//***************************************************************************************
+// LinearAllocator.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "LinearAllocator.hpp"
+
+// Constructor, pages are created on first use
+LinearAllocator::LinearAllocator(ID3D12Device* device, UINT64 pageSize)
+	: mDevice(device)
+	, mPageSize(pageSize)
+	, mPages()
+	, mCurrentPage(0)
+	, mOffset(0)
+	, mUsedBytes(0)
+{
+}
+
+// Returns size bytes of mapped upload memory at the given power-of-two alignment
+LinearAllocator::Allocation LinearAllocator::allocate(UINT64 size, UINT64 alignment)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	// Move on to the next page that fits, adding one if none does
+	UINT64 offset = (mOffset + alignment - 1) & ~(alignment - 1);
+	while (mCurrentPage < mPages.size() && offset + size > mPages[mCurrentPage].size)
+	{
+		mCurrentPage++;
+		offset = 0;
+	}
+
+	if (mCurrentPage == mPages.size())
+	{
+		Page page;
+		page.size = std::max(mPageSize, size);
+		page.buffer = std::make_unique<UploadBuffer<BYTE>>(mDevice, (UINT)page.size, false);
+		mPages.push_back(std::move(page));
+		offset = 0;
+	}
+
+	const Page& page = mPages[mCurrentPage];
+	mOffset = offset + size;
+	mUsedBytes += size;
+
+	Allocation allocation;
+	allocation.cpuAddress = page.buffer->MappedData() + offset;
+	allocation.gpuAddress = page.buffer->Resource()->GetGPUVirtualAddress() + offset;
+	return allocation;
+}
+
+// Makes all pages available again; only call once the GPU has finished reading them
+void LinearAllocator::reset()
+{
+	mCurrentPage = 0;
+	mOffset = 0;
+	mUsedBytes = 0;
+}
+
+// Returns the number of bytes handed out since the last reset
+UINT64 LinearAllocator::getUsedBytes() const
+{
+	return mUsedBytes;
+}
+
+// Returns the total size of all pages
+UINT64 LinearAllocator::getCapacity() const
+{
+	UINT64 capacity = 0;
+	for (const Page& page : mPages)
+		capacity += page.size;
+	return capacity;
+}
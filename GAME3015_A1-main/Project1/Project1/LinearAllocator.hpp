@@ -0,0 +1,49 @@
+#pragma once
+#include "../../Common/UploadBuffer.h"
+
+#include <memory>
+#include <vector>
+
+// Hands out slices of upload memory for data that only lives for one frame.
+// Slices are carved linearly out of pages built on UploadBuffer; a frame that
+// runs out adds a page, and reset() rewinds to the first page once the GPU is
+// done with the frame, so after warm-up nothing is allocated anymore.
+class LinearAllocator
+{
+public:
+	struct Allocation
+	{
+		BYTE*						cpuAddress;
+		D3D12_GPU_VIRTUAL_ADDRESS	gpuAddress;
+	};
+
+
+public:
+									LinearAllocator(ID3D12Device* device, UINT64 pageSize);
+									LinearAllocator(const LinearAllocator&) = delete;
+	LinearAllocator&				operator=(const LinearAllocator&) = delete;
+
+	Allocation						allocate(UINT64 size, UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+	void							reset();
+
+	UINT64							getUsedBytes() const;
+	UINT64							getCapacity() const;
+
+
+private:
+	struct Page
+	{
+		std::unique_ptr<UploadBuffer<BYTE>>	buffer;
+		UINT64						size;
+	};
+
+
+private:
+	ID3D12Device*					mDevice;
+	UINT64							mPageSize;
+
+	std::vector<Page>				mPages;
+	size_t							mCurrentPage;
+	UINT64							mOffset;
+	UINT64							mUsedBytes;
+};
@@ -0,0 +1,55 @@
+//***************************************************************************************
+// LoadingState.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "LoadingState.hpp"
+#include "SpriteNode.h"
+#include "Game.hpp"
+
+// Constructor
+LoadingState::LoadingState(StateStack* stack, Context* context) : State(stack, context)
+{
+    // Clear the render items list
+    mAllRitems.clear();
+
+    // Create a background sprite for the loading screen, reusing the title artwork
+    std::unique_ptr<SpriteNode> backgroundSprite = std::make_unique<SpriteNode>(this);
+    backgroundSprite->SetMatGeoDrawName("Aircrafts_Title", "boxGeo", "box");
+    backgroundSprite->setScale(60, 1.0, 50.0);
+    backgroundSprite->setPosition(0, 0, 0);
+    mSceneGraph->attachChild(std::move(backgroundSprite));
+
+    // Build the scene graph
+    mSceneGraph->build();
+}
+
+// Destructor
+LoadingState::~LoadingState()
+{
+}
+
+// Draw the loading screen
+void LoadingState::draw()
+{
+    mSceneGraph->draw();
+}
+
+// Update the loading screen; the state stack swaps in the awaited state once it is built
+bool LoadingState::update(const GameTimer& gt)
+{
+    mSceneGraph->update(gt);
+    mTransforms.update();
+    return true;
+}
+
+// Input is ignored while loading
+bool LoadingState::handleEvent(WPARAM btnState)
+{
+    return false;
+}
+
+// Input is ignored while loading
+bool LoadingState::handleRealtimeInput()
+{
+    return false;
+}
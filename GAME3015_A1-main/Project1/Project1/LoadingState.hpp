@@ -0,0 +1,14 @@
+#pragma once
+#include "State.hpp"
+
+// Stands in on the stack for a pushed state that is still being built in the background
+class LoadingState : public State
+{
+public:
+    LoadingState(StateStack* stack, Context* context);
+    virtual ~LoadingState();
+    virtual void draw()override;
+    virtual bool update(const GameTimer& gt)override;
+    virtual bool handleEvent(WPARAM btnState)override;
+    virtual bool handleRealtimeInput()override;
+};
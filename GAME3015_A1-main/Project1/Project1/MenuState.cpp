@@ -13,12 +13,6 @@ MenuState::MenuState(StateStack* stack, Context* context) : State(stack, context
     // Clear the render items list
     mAllRitems.clear();
 
-    // Reset the frame resources for the game
-    mContext->game->ResetFrameResources();
-
-    // Build the materials for the game
-    mContext->game->BuildMaterials();
-
     // Create a background sprite for the menu
     std::unique_ptr<SpriteNode> backgroundSprite = std::make_unique<SpriteNode>(this);
     backgroundSprite->SetMatGeoDrawName("Aircrafts_Menu", "boxGeo", "box");
@@ -28,7 +22,12 @@ MenuState::MenuState(StateStack* stack, Context* context) : State(stack, context
 
     // Build the scene graph
     mSceneGraph->build();
-    mContext->game->BuildFrameResources(mAllRitems.size());
+}
+
+// Builds the game world in the background while the menu is shown
+void MenuState::onActivate()
+{
+    requestStatePreload(States::Game);
 }
 
 // Destructor
@@ -47,6 +46,7 @@ void MenuState::draw()
 bool MenuState::update(const GameTimer& gt)
 {
     mSceneGraph->update(gt);
+    mTransforms.update();
     return true;
 }
 
@@ -10,4 +10,7 @@ public:
     virtual bool update(const GameTimer& gt)override;
     virtual bool handleEvent(WPARAM btnState)override;
     virtual bool handleRealtimeInput()override;
+
+protected:
+    virtual void onActivate()override;
 };
\ No newline at end of file
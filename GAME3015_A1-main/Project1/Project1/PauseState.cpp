@@ -12,10 +12,6 @@ PauseState::PauseState(StateStack* stack, Context* context) : State(stack, conte
     // Clear the vector of all render items
     mAllRitems.clear();
 
-    // Reset the frame resources for the game and build the materials
-    mContext->game->ResetFrameResources();
-    mContext->game->BuildMaterials();
-
     // Create a sprite node for the background and set its properties
     std::unique_ptr<SpriteNode> backgroundSprite = std::make_unique<SpriteNode>(this);
     backgroundSprite->SetMatGeoDrawName("Aircrafts_Pause", "boxGeo", "box");
@@ -26,8 +22,6 @@ PauseState::PauseState(StateStack* stack, Context* context) : State(stack, conte
     mSceneGraph->attachChild(std::move(backgroundSprite));
     // Build the scene graph
     mSceneGraph->build();
-    // Build the frame resources with the size of the render item vector
-    mContext->game->BuildFrameResources(mAllRitems.size());
 }
 
 // Destructor
@@ -41,36 +35,37 @@ void PauseState::draw()
     mSceneGraph->draw();
 }
 
-// Updates the scene graph with the given game timer
+// Updates the scene graph with the given game timer; the states below stay frozen
 bool PauseState::update(const GameTimer& gt)
 {
     mSceneGraph->update(gt);
+    mTransforms.update();
 
-    return true;
+    return false;
 }
 
 // Handles events for the PauseState
 bool PauseState::handleEvent(WPARAM btnState)
 {
-    // Check P for Resume
+    // Check P for Resume, uncovering the suspended game
     if (d3dUtil::IsKeyDown('P'))
     {
         requestStackPop();
-        requestStackPush(States::Game);
     } 
 
-    // Check Q for Quit
+    // Check Q for Quit, dropping the suspended game as well
     else if (d3dUtil::IsKeyDown('Q'))
     {
-        requestStackPop();
+        requestStateClear();
         requestStackPush(States::Menu);
     }
 
-    return true;
+    // Keep the input away from the suspended game
+    return false;
 }
 
 // Handles real time input for the PauseState
 bool PauseState::handleRealtimeInput()
 {
-    return true;
+    return false;
 }
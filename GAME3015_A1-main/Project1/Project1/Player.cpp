@@ -50,6 +50,8 @@ Player::Player()
 	mKeyBinding[VK_LEFT] = MoveLeft;
 	mKeyBinding[VK_RIGHT] = MoveRight;
 
+	mKeyBinding[VK_SPACE] = Fire;
+
 	initializeActions();
 
 	for (auto pair : mKeyBinding)
@@ -137,6 +139,7 @@ void Player::initializeActions()
 	mActionBinding[MoveRight].action = derivedAction<Aircraft>(AircraftMover(playerSpeed, 0.f, 0.0f));
 	mActionBinding[MoveUp].action = derivedAction<Aircraft>(AircraftMover(0.f, playerSpeed, 0));
 	mActionBinding[MoveDown].action = derivedAction<Aircraft>(AircraftMover(0.f, -playerSpeed, 0));
+	mActionBinding[Fire].action = derivedAction<Aircraft>([](Aircraft& aircraft, const GameTimer&) { aircraft.setFiring(true); });
 }
 
 // Check if the specified action is real time
@@ -148,6 +151,7 @@ bool Player::isRealtimeAction(Action action)
 	case MoveRight:
 	case MoveDown:
 	case MoveUp:
+	case Fire:
 		return true;
 
 	default:
@@ -17,6 +17,7 @@ public:
 		MoveRight,
 		MoveUp,
 		MoveDown,
+		Fire,
 		ActionCount
 	};
 
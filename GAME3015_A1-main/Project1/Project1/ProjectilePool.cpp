@@ -0,0 +1,148 @@
+//***************************************************************************************
+// ProjectilePool.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "ProjectilePool.hpp"
+
+#include <cstring>
+
+using namespace DirectX;
+
+// Number of float arrays in the pool's allocation
+static const size_t StreamCount = 10;
+
+// Constructor, reserves every array for capacity projectiles
+ProjectilePool::ProjectilePool(size_t capacity)
+	: mCapacity(0)
+	, mCount(0)
+	, mData()
+	, mPositionX(nullptr)
+	, mPositionY(nullptr)
+	, mPositionZ(nullptr)
+	, mPreviousX(nullptr)
+	, mPreviousY(nullptr)
+	, mPreviousZ(nullptr)
+	, mVelocityX(nullptr)
+	, mVelocityY(nullptr)
+	, mVelocityZ(nullptr)
+	, mLifetime(nullptr)
+{
+	allocate(capacity);
+}
+
+// Adds a projectile that flies for lifetime seconds; returns false when the pool is full
+bool ProjectilePool::launch(const XMFLOAT3& position, const XMFLOAT3& velocity, float lifetime)
+{
+	if (mCount == mCapacity)
+		return false;
+
+	const size_t i = mCount++;
+	mPositionX[i] = mPreviousX[i] = position.x;
+	mPositionY[i] = mPreviousY[i] = position.y;
+	mPositionZ[i] = mPreviousZ[i] = position.z;
+	mVelocityX[i] = velocity.x;
+	mVelocityY[i] = velocity.y;
+	mVelocityZ[i] = velocity.z;
+	mLifetime[i] = lifetime;
+	return true;
+}
+
+// Moves every live projectile by one step of dt seconds and recycles the ones whose lifetime ran out
+void ProjectilePool::update(float dt)
+{
+	const size_t count = mCount;
+
+	memcpy(mPreviousX, mPositionX, count * sizeof(float));
+	memcpy(mPreviousY, mPositionY, count * sizeof(float));
+	memcpy(mPreviousZ, mPositionZ, count * sizeof(float));
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		mPositionX[i] += mVelocityX[i] * dt;
+		mPositionY[i] += mVelocityY[i] * dt;
+		mPositionZ[i] += mVelocityZ[i] * dt;
+		mLifetime[i] -= dt;
+	}
+
+	// The last live projectile takes the place of an expired one, keeping the live ones packed
+	size_t i = 0;
+	while (i < mCount)
+	{
+		if (mLifetime[i] <= 0.0f)
+			moveEntry(--mCount, i);
+		else
+			++i;
+	}
+}
+
+// Writes the position of every live projectile between its last two steps to the first getCount() positions
+void ProjectilePool::interpolate(float alpha, XMFLOAT3* positions) const
+{
+	for (size_t i = 0; i < mCount; ++i)
+	{
+		XMFLOAT3& position = positions[i];
+		position.x = mPreviousX[i] + (mPositionX[i] - mPreviousX[i]) * alpha;
+		position.y = mPreviousY[i] + (mPositionY[i] - mPreviousY[i]) * alpha;
+		position.z = mPreviousZ[i] + (mPositionZ[i] - mPreviousZ[i]) * alpha;
+	}
+}
+
+// Grows the pool to hold at least capacity projectiles, keeping the live ones
+void ProjectilePool::reserve(size_t capacity)
+{
+	if (capacity > mCapacity)
+		allocate(capacity);
+}
+
+// Removes every projectile
+void ProjectilePool::clear()
+{
+	mCount = 0;
+}
+
+// Returns the number of live projectiles
+size_t ProjectilePool::getCount() const
+{
+	return mCount;
+}
+
+// Returns the most projectiles that can be alive at once
+size_t ProjectilePool::getCapacity() const
+{
+	return mCapacity;
+}
+
+// Carves the arrays for capacity projectiles from a new allocation and copies the live projectiles over
+void ProjectilePool::allocate(size_t capacity)
+{
+	std::unique_ptr<float[]> data(new float[capacity * StreamCount]);
+	float** streams[StreamCount] = { &mPositionX, &mPositionY, &mPositionZ, &mPreviousX, &mPreviousY, &mPreviousZ,
+		&mVelocityX, &mVelocityY, &mVelocityZ, &mLifetime };
+
+	float* stream = data.get();
+	for (float** array : streams)
+	{
+		if (mCount > 0)
+			memcpy(stream, *array, mCount * sizeof(float));
+		*array = stream;
+		stream += capacity;
+	}
+
+	mData = std::move(data);
+	mCapacity = capacity;
+}
+
+// Copies every array entry of a projectile to another index
+void ProjectilePool::moveEntry(size_t from, size_t to)
+{
+	mPositionX[to] = mPositionX[from];
+	mPositionY[to] = mPositionY[from];
+	mPositionZ[to] = mPositionZ[from];
+	mPreviousX[to] = mPreviousX[from];
+	mPreviousY[to] = mPreviousY[from];
+	mPreviousZ[to] = mPreviousZ[from];
+	mVelocityX[to] = mVelocityX[from];
+	mVelocityY[to] = mVelocityY[from];
+	mVelocityZ[to] = mVelocityZ[from];
+	mLifetime[to] = mLifetime[from];
+}
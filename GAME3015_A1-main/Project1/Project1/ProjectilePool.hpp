@@ -0,0 +1,49 @@
+#pragma once
+#include "../../Common/MathHelper.h"
+
+#include <memory>
+
+// Simulation state of a pool of projectiles, without anything to draw them.
+// Positions, last step positions, velocities, and remaining lifetimes are
+// separate arrays carved from one allocation, made up front and only replaced
+// when reserve() grows the pool, and the live projectiles are always the first
+// getCount() entries: launching appends, and an expired projectile is replaced
+// by the last live one, so the tail of the pool is its free list. A step
+// integrates every live projectile in one pass over the arrays.
+class ProjectilePool
+{
+public:
+	explicit						ProjectilePool(size_t capacity);
+
+	bool							launch(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& velocity, float lifetime);
+	void							update(float dt);
+	void							interpolate(float alpha, DirectX::XMFLOAT3* positions) const;
+	void							reserve(size_t capacity);
+	void							clear();
+
+	size_t							getCount() const;
+	size_t							getCapacity() const;
+
+
+private:
+	void							allocate(size_t capacity);
+	void							moveEntry(size_t from, size_t to);
+
+
+private:
+	size_t							mCapacity;
+	size_t							mCount;
+
+	// Capacity floats per array, in the order they are declared below
+	std::unique_ptr<float[]>		mData;
+	float*							mPositionX;
+	float*							mPositionY;
+	float*							mPositionZ;
+	float*							mPreviousX;
+	float*							mPreviousY;
+	float*							mPreviousZ;
+	float*							mVelocityX;
+	float*							mVelocityY;
+	float*							mVelocityZ;
+	float*							mLifetime;
+};
@@ -0,0 +1,107 @@
+//***************************************************************************************
+// ProjectileSystem.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "ProjectileSystem.hpp"
+#include "Game.hpp"
+#include "State.hpp"
+
+#include <algorithm>
+
+// Constructor, reserves the pool for capacity projectiles
+ProjectileSystem::ProjectileSystem(State* state, size_t capacity)
+	: mState(state)
+	, mPool(capacity)
+	, mRenderItem()
+	, mBuilt(false)
+	, mRenderItemChanged(false)
+	, mPositions()
+{
+}
+
+// Destructor, gives the object slot of the render item back to the game
+ProjectileSystem::~ProjectileSystem()
+{
+	if (mBuilt)
+		mState->getContext()->game->getFrameConstants().releaseObjects(&mRenderItem, 1);
+}
+
+// Creates the render item every projectile is drawn as, with one material and submesh at the given scale
+void ProjectileSystem::build(const std::string& material, const std::string& geometry,
+	const std::string& drawName, const XMFLOAT3& scale)
+{
+	Game* game = mState->getContext()->game;
+
+	XMStoreFloat4x4(&mRenderItem.World, XMMatrixScaling(scale.x, scale.y, scale.z));
+	mRenderItem.Mat = game->getMaterials().at(material).get();
+	mRenderItem.Geo = game->getGeometries().at(geometry).get();
+	mRenderItem.PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	mRenderItem.IndexCount = mRenderItem.Geo->DrawArgs.at(drawName).IndexCount;
+	mRenderItem.StartIndexLocation = mRenderItem.Geo->DrawArgs.at(drawName).StartIndexLocation;
+	mRenderItem.BaseVertexLocation = mRenderItem.Geo->DrawArgs.at(drawName).BaseVertexLocation;
+	mRenderItem.Bounds = mRenderItem.Geo->DrawArgs.at(drawName).Bounds;
+
+	mState->allocateObjects(&mRenderItem, 1);
+	mBuilt = true;
+	mRenderItemChanged = true;
+}
+
+// Adds a projectile that flies for lifetime seconds, doubling the pool when it is full
+void ProjectileSystem::launch(const XMFLOAT3& position, const XMFLOAT3& velocity, float lifetime)
+{
+	if (mPool.getCount() == mPool.getCapacity())
+		mPool.reserve(std::max(mPool.getCapacity() * 2, (size_t)1));
+
+	mPool.launch(position, velocity, lifetime);
+}
+
+// Moves every live projectile by one step and recycles the ones whose lifetime ran out
+void ProjectileSystem::update(const GameTimer& gt)
+{
+	mPool.update(gt.DeltaTime());
+}
+
+// Places the live projectiles between their last two steps; only the render item's first
+// upload goes on changed
+void ProjectileSystem::interpolate(float alpha, std::vector<RenderItem*>& changed)
+{
+	if (!mBuilt)
+		return;
+
+	if (mRenderItemChanged)
+	{
+		changed.push_back(&mRenderItem);
+		mRenderItemChanged = false;
+	}
+
+	mPositions.resize(mPool.getCount());
+	mPool.interpolate(alpha, mPositions.data());
+}
+
+// Queues the live projectiles as one stream of positions
+void ProjectileSystem::draw()
+{
+	if (!mBuilt)
+		return;
+
+	RenderBatcher& batcher = mState->getContext()->game->getRenderBatcher();
+	batcher.submitInstances(&mRenderItem, mPositions.data(), mPositions.size());
+}
+
+// Removes every projectile
+void ProjectileSystem::clear()
+{
+	mPool.clear();
+}
+
+// Returns the number of live projectiles
+size_t ProjectileSystem::getCount() const
+{
+	return mPool.getCount();
+}
+
+// Returns the projectiles the pool holds before it has to grow
+size_t ProjectileSystem::getCapacity() const
+{
+	return mPool.getCapacity();
+}
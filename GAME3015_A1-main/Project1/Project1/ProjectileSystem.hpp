@@ -0,0 +1,46 @@
+#pragma once
+#include "SceneNode.hpp"
+#include "ProjectilePool.hpp"
+
+#include <string>
+#include <vector>
+
+class State;
+
+// Pool of projectiles kept outside the scene graph. The simulation state
+// lives in a ProjectilePool, which grows when a launch finds it full. All
+// projectiles are drawn from one render item: every frame only their
+// interpolated positions are written, and the batcher streams them as the
+// instances of one position draw, so a projectile has no object constants or
+// dirty list entry of its own.
+class ProjectileSystem
+{
+public:
+	explicit						ProjectileSystem(State* state, size_t capacity);
+									~ProjectileSystem();
+
+	void							build(const std::string& material, const std::string& geometry,
+										const std::string& drawName, const XMFLOAT3& scale);
+	void							launch(const XMFLOAT3& position, const XMFLOAT3& velocity, float lifetime);
+	void							update(const GameTimer& gt);
+	void							interpolate(float alpha, std::vector<RenderItem*>& changed);
+	void							draw();
+	void							clear();
+
+	size_t							getCount() const;
+	size_t							getCapacity() const;
+
+
+private:
+	State*							mState;
+	ProjectilePool					mPool;
+
+	// Item every projectile is drawn as, at the origin; its object slot is held from build() on,
+	// and its constants wait for the next interpolate() to be queued for upload
+	RenderItem						mRenderItem;
+	bool							mBuilt;
+	bool							mRenderItemChanged;
+
+	// Position of every live projectile in the frame being drawn
+	std::vector<XMFLOAT3>			mPositions;
+};
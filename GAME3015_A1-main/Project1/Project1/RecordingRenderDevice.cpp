@@ -0,0 +1,140 @@
+//***************************************************************************************
+// RecordingRenderDevice.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "RecordingRenderDevice.hpp"
+#include "RenderItem.hpp"
+#include "ShaderConstants.hpp"
+#include "../../Common/Material.h"
+
+#include <algorithm>
+
+// Constructor, capture selects between the recording and the null backend
+RecordingRenderDevice::RecordingRenderDevice(bool capture)
+	: mCapture(capture)
+	, mCommands()
+	, mUploadData()
+	, mCallCounts(RenderCommand::Draw + 1, 0)
+{
+}
+
+// Records an upload of the constants of count objects with consecutive indices
+void RecordingRenderDevice::uploadObjectConstants(unsigned int firstIndex, const ObjectConstants* constants, unsigned int count)
+{
+	record(RenderCommand::UploadObject, nullptr, firstIndex, count, 0, 0, 0, constants, count * sizeof(ObjectConstants));
+}
+
+// Records a material constant upload
+void RecordingRenderDevice::uploadMaterialConstants(unsigned int index, const MaterialConstants& constants)
+{
+	record(RenderCommand::UploadMaterial, nullptr, index, 0, 0, 0, 0, &constants, sizeof(constants));
+}
+
+// Records a pass constant upload
+void RecordingRenderDevice::uploadPassConstants(const PassConstants& constants)
+{
+	record(RenderCommand::UploadPass, nullptr, 0, 0, 0, 0, 0, &constants, sizeof(constants));
+}
+
+// Records the upload of the instance object indices
+void RecordingRenderDevice::uploadInstanceObjects(const std::vector<unsigned int>& objects)
+{
+	record(RenderCommand::UploadInstances, nullptr, (unsigned int)objects.size(), 0, 0, 0, 0,
+		objects.data(), objects.size() * sizeof(unsigned int));
+}
+
+// Records the upload of the instance positions
+void RecordingRenderDevice::uploadInstancePositions(const DirectX::XMFLOAT3* positions, unsigned int count)
+{
+	record(RenderCommand::UploadPositions, nullptr, count, 0, 0, 0, 0, positions, count * sizeof(DirectX::XMFLOAT3));
+}
+
+// Records the binding of the uploaded instance indices and positions
+void RecordingRenderDevice::bindInstanceObjects()
+{
+	record(RenderCommand::BindInstances, nullptr, 0, 0, 0, 0, 0, nullptr, 0);
+}
+
+// Records the start of a pass
+void RecordingRenderDevice::beginPass()
+{
+	record(RenderCommand::BeginPass, nullptr, 0, 0, 0, 0, 0, nullptr, 0);
+}
+
+// Records a geometry change
+void RecordingRenderDevice::setGeometry(const RenderItem& item)
+{
+	record(RenderCommand::SetGeometry, item.Geo, (unsigned int)item.PrimitiveType, 0, 0, 0, 0, nullptr, 0);
+}
+
+// Records a material change
+void RecordingRenderDevice::setMaterial(const Material& material)
+{
+	record(RenderCommand::SetMaterial, &material, (unsigned int)material.MatCBIndex,
+		(unsigned int)material.DiffuseSrvHeapIndex, 0, 0, 0, nullptr, 0);
+}
+
+// Records the instance and position bases of the next draw
+void RecordingRenderDevice::setInstanceBase(unsigned int base, unsigned int positionBase)
+{
+	record(RenderCommand::SetInstanceBase, nullptr, base, positionBase, 0, 0, 0, nullptr, 0);
+}
+
+// Records a draw
+void RecordingRenderDevice::drawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount,
+	unsigned int startIndexLocation, int baseVertexLocation)
+{
+	record(RenderCommand::Draw, nullptr, indexCount, instanceCount, startIndexLocation, 0,
+		baseVertexLocation, nullptr, 0);
+}
+
+// Drops the recorded stream and resets the counters
+void RecordingRenderDevice::clear()
+{
+	mCommands.clear();
+	mUploadData.clear();
+	std::fill(mCallCounts.begin(), mCallCounts.end(), 0);
+}
+
+// Returns the recorded calls, in call order
+const std::vector<RenderCommand>& RecordingRenderDevice::getCommands() const
+{
+	return mCommands;
+}
+
+// Returns the bytes of every recorded upload, referenced by RenderCommand::dataOffset
+const std::vector<unsigned char>& RecordingRenderDevice::getUploadData() const
+{
+	return mUploadData;
+}
+
+// Returns how often a call was made since the last clear, also when not capturing
+size_t RecordingRenderDevice::getCallCount(RenderCommand::Type type) const
+{
+	return mCallCounts[type];
+}
+
+// Counts a call and, when capturing, appends it and its payload to the stream
+void RecordingRenderDevice::record(RenderCommand::Type type, const void* resource,
+	unsigned int arg0, unsigned int arg1, unsigned int arg2, unsigned int arg3,
+	int baseVertexLocation, const void* data, size_t dataSize)
+{
+	mCallCounts[type]++;
+	if (!mCapture)
+		return;
+
+	RenderCommand command;
+	command.type = type;
+	command.resource = resource;
+	command.args[0] = arg0;
+	command.args[1] = arg1;
+	command.args[2] = arg2;
+	command.args[3] = arg3;
+	command.baseVertexLocation = baseVertexLocation;
+	command.dataOffset = mUploadData.size();
+	command.dataSize = dataSize;
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	mUploadData.insert(mUploadData.end(), bytes, bytes + dataSize);
+	mCommands.push_back(command);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "RenderDevice.hpp"
+
+#include <cstddef>
+
+// One captured RenderDevice call
+struct RenderCommand
+{
+	enum Type
+	{
+		UploadObject,
+		UploadMaterial,
+		UploadPass,
+		UploadInstances,
+		UploadPositions,
+		BindInstances,
+		BeginPass,
+		SetGeometry,
+		SetMaterial,
+		SetInstanceBase,
+		Draw,
+	};
+
+	Type							type;
+
+	// Geometry or material bound by SetGeometry / SetMaterial
+	const void*						resource;
+
+	// Slot index, instance and position bases or draw parameters, depending on the type
+	unsigned int					args[4];
+	int								baseVertexLocation;
+
+	// Bytes of the upload within RecordingRenderDevice::getUploadData()
+	size_t							dataOffset;
+	size_t							dataSize;
+};
+
+// Headless RenderDevice that appends every call to an in-memory stream instead
+// of talking to a GPU. With capture disabled it only counts calls and serves as
+// the null backend.
+class RecordingRenderDevice : public RenderDevice
+{
+public:
+	explicit						RecordingRenderDevice(bool capture = true);
+
+	virtual void					uploadObjectConstants(unsigned int firstIndex, const ObjectConstants* constants, unsigned int count) override;
+	virtual void					uploadMaterialConstants(unsigned int index, const MaterialConstants& constants) override;
+	virtual void					uploadPassConstants(const PassConstants& constants) override;
+	virtual void					uploadInstanceObjects(const std::vector<unsigned int>& objects) override;
+	virtual void					uploadInstancePositions(const DirectX::XMFLOAT3* positions, unsigned int count) override;
+	virtual void					bindInstanceObjects() override;
+
+	virtual void					beginPass() override;
+	virtual void					setGeometry(const RenderItem& item) override;
+	virtual void					setMaterial(const Material& material) override;
+	virtual void					setInstanceBase(unsigned int base, unsigned int positionBase) override;
+	virtual void					drawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount,
+										unsigned int startIndexLocation, int baseVertexLocation) override;
+
+	void							clear();
+
+	const std::vector<RenderCommand>&	getCommands() const;
+	const std::vector<unsigned char>&	getUploadData() const;
+	size_t							getCallCount(RenderCommand::Type type) const;
+
+
+private:
+	void							record(RenderCommand::Type type, const void* resource,
+										unsigned int arg0, unsigned int arg1, unsigned int arg2, unsigned int arg3,
+										int baseVertexLocation, const void* data, size_t dataSize);
+
+
+private:
+	bool							mCapture;
+	std::vector<RenderCommand>		mCommands;
+	std::vector<unsigned char>		mUploadData;
+	std::vector<size_t>				mCallCounts;
+};
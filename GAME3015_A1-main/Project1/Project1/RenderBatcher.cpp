@@ -0,0 +1,435 @@
+//***************************************************************************************
+// RenderBatcher.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "RenderBatcher.hpp"
+#include "TaskScheduler.hpp"
+#include "../../Common/Material.h"
+
+#include <algorithm>
+
+using namespace DirectX;
+
+// Bits of the geometry field holding the submesh id; the rest hold the geometry id
+static const unsigned int SubmeshBits = 8;
+
+// Adds the binds of another recording
+RenderStateStats& RenderStateStats::operator+=(const RenderStateStats& other)
+{
+	GeometryBinds += other.GeometryBinds;
+	GeometrySkipped += other.GeometrySkipped;
+	MaterialBinds += other.MaterialBinds;
+	MaterialSkipped += other.MaterialSkipped;
+	return *this;
+}
+
+// Constructor, without a view every item sorts at depth 0
+RenderBatcher::RenderBatcher()
+	: mItems()
+	, mSortScratch()
+	, mCullItems()
+	, mVisible()
+	, mBatches()
+	, mGeometryIds()
+	, mEyePosition(0.0f, 0.0f, 0.0f)
+	, mLook(0.0f, 0.0f, 1.0f)
+	, mFarZ(0.0f)
+	, mInstanceObjects()
+	, mInstancePositions()
+	, mStreams()
+{
+}
+
+// Sets the camera the depth field of the sort keys is measured from
+void RenderBatcher::setView(const XMFLOAT3& eyePosition, const XMFLOAT3& look, float farZ)
+{
+	mEyePosition = eyePosition;
+	mLook = look;
+	mFarZ = farZ;
+}
+
+// Forgets the items and batches of the previous frame, keeping the allocations
+void RenderBatcher::clear()
+{
+	mItems.clear();
+	mBatches.clear();
+	mInstanceObjects.clear();
+	mInstancePositions.clear();
+	mStreams.clear();
+}
+
+// Queues a render item for this frame and stores its sort key on it
+void RenderBatcher::submit(RenderItem* item)
+{
+	// Everything is drawn in the one opaque pass with the one opaque PSO for now
+	item->SortKey = makeSortKey(0, 0, (UINT)item->Mat->MatCBIndex, getGeometryId(*item), getDepth(*item));
+
+	SortEntry entry;
+	entry.key = item->SortKey;
+	entry.item = item;
+	entry.stream = NoStream;
+	mItems.push_back(entry);
+}
+
+// Queues count copies of a render item for this frame, each with its translation replaced by one of the
+// positions; they are culled one by one and drawn as one position draw with the item's object constants
+void RenderBatcher::submitInstances(RenderItem* item, const XMFLOAT3* positions, size_t count)
+{
+	if (count == 0)
+		return;
+
+	// The copies are spread out, so the stream sorts by state alone
+	item->SortKey = makeSortKey(0, 0, (UINT)item->Mat->MatCBIndex, getGeometryId(*item), 0);
+
+	PositionStream stream;
+	stream.first = (UINT)mInstancePositions.size();
+	stream.count = (UINT)count;
+	mInstancePositions.insert(mInstancePositions.end(), positions, positions + count);
+
+	SortEntry entry;
+	entry.key = item->SortKey;
+	entry.item = item;
+	entry.stream = (UINT)mStreams.size();
+	mStreams.push_back(stream);
+	mItems.push_back(entry);
+}
+
+// Removes the submitted items and stream positions outside the culler's frustum, keeping the others in
+// submission order; a stream left without positions is removed too
+FrustumCuller::Stats RenderBatcher::cull(FrustumCuller& culler)
+{
+	FrustumCuller::Stats stats;
+
+	// Each stream keeps its visible positions at the front of its range
+	for (const SortEntry& entry : mItems)
+	{
+		if (entry.stream == NoStream)
+			continue;
+
+		PositionStream& stream = mStreams[entry.stream];
+		XMFLOAT3* positions = mInstancePositions.data() + stream.first;
+		culler.cullInstances(*entry.item, positions, stream.count, mVisible);
+
+		UINT kept = 0;
+		for (UINT i = 0; i < stream.count; ++i)
+		{
+			if (mVisible[i])
+				positions[kept++] = positions[i];
+		}
+		stats.Visible += kept;
+		stats.Culled += stream.count - kept;
+		stream.count = kept;
+	}
+
+	mCullItems.clear();
+	for (const SortEntry& entry : mItems)
+	{
+		if (entry.stream == NoStream)
+			mCullItems.push_back(entry.item);
+	}
+
+	culler.cull(mCullItems.data(), mCullItems.size(), mVisible);
+
+	// The single items were culled in order, so the next result belongs to the next single item
+	size_t kept = 0;
+	size_t item = 0;
+	for (size_t i = 0; i < mItems.size(); ++i)
+	{
+		const SortEntry& entry = mItems[i];
+		if (entry.stream != NoStream)
+		{
+			if (mStreams[entry.stream].count > 0)
+				mItems[kept++] = entry;
+		}
+		else if (mVisible[item++])
+		{
+			mItems[kept++] = entry;
+			stats.Visible++;
+		}
+		else
+		{
+			stats.Culled++;
+		}
+	}
+	mItems.resize(kept);
+	return stats;
+}
+
+// Groups the submitted items into instanced batches
+void RenderBatcher::build()
+{
+	mBatches.clear();
+	mInstanceObjects.clear();
+
+	sortItems();
+
+	for (const SortEntry& entry : mItems)
+	{
+		const RenderItem* item = entry.item;
+
+		// A stream is a batch of its own with a single object index for all of its instances
+		if (entry.stream != NoStream)
+		{
+			RenderBatch batch;
+			batch.item = item;
+			batch.instanceOffset = (UINT)mInstanceObjects.size();
+			batch.instanceCount = mStreams[entry.stream].count;
+			batch.positionOffset = mStreams[entry.stream].first;
+			mBatches.push_back(batch);
+
+			mInstanceObjects.push_back(item->ObjCBIndex);
+			continue;
+		}
+
+		if (mBatches.empty() || mBatches.back().positionOffset != RenderDevice::NoInstancePositions
+			|| !isSameBatch(*mBatches.back().item, *item))
+		{
+			RenderBatch batch;
+			batch.item = item;
+			batch.instanceOffset = (UINT)mInstanceObjects.size();
+			batch.instanceCount = 0;
+			batch.positionOffset = RenderDevice::NoInstancePositions;
+			mBatches.push_back(batch);
+		}
+
+		mInstanceObjects.push_back(item->ObjCBIndex);
+		mBatches.back().instanceCount++;
+	}
+}
+
+// Uploads the instance indices and issues one instanced draw per batch
+RenderStateStats RenderBatcher::execute(RenderDevice& device) const
+{
+	if (mBatches.empty())
+		return RenderStateStats();
+
+	uploadInstances(device);
+
+	RenderChunk all;
+	all.firstBatch = 0;
+	all.batchCount = (UINT)mBatches.size();
+	return executeChunk(device, all);
+}
+
+// Splits the batches into at most maxChunks consecutive ranges of near equal size,
+// without going below minBatchesPerChunk batches per range
+std::vector<RenderChunk> RenderBatcher::partition(unsigned int maxChunks, unsigned int minBatchesPerChunk) const
+{
+	std::vector<RenderChunk> chunks;
+	const UINT batchCount = (UINT)mBatches.size();
+	if (batchCount == 0)
+		return chunks;
+
+	UINT chunkCount = std::min(std::max(maxChunks, 1u), batchCount / std::max(minBatchesPerChunk, 1u));
+	chunkCount = std::max(chunkCount, 1u);
+
+	// The first batchCount % chunkCount chunks take one batch more than the rest
+	UINT first = 0;
+	for (UINT i = 0; i < chunkCount; ++i)
+	{
+		RenderChunk chunk;
+		chunk.firstBatch = first;
+		chunk.batchCount = batchCount / chunkCount + (i < batchCount % chunkCount ? 1 : 0);
+		chunks.push_back(chunk);
+		first += chunk.batchCount;
+	}
+	return chunks;
+}
+
+// Uploads the object index of every instance and the stream positions; devices recording chunks bind them
+// with bindInstanceObjects()
+void RenderBatcher::uploadInstances(RenderDevice& device) const
+{
+	device.uploadInstanceObjects(mInstanceObjects);
+	if (!mStreams.empty())
+		device.uploadInstancePositions(mInstancePositions.data(), (unsigned int)mInstancePositions.size());
+}
+
+// Issues one instanced draw per batch of a chunk, binding geometry and material only when they change
+RenderStateStats RenderBatcher::executeChunk(RenderDevice& device, const RenderChunk& chunk) const
+{
+	RenderStateStats stats;
+	const RenderItem* bound = nullptr;
+
+	for (UINT i = chunk.firstBatch; i < chunk.firstBatch + chunk.batchCount; ++i)
+	{
+		const RenderBatch& batch = mBatches[i];
+		const RenderItem& item = *batch.item;
+
+		// Vertex and index buffers and topology
+		if (bound == nullptr || bound->Geo != item.Geo || bound->PrimitiveType != item.PrimitiveType)
+		{
+			device.setGeometry(item);
+			stats.GeometryBinds++;
+		}
+		else
+		{
+			stats.GeometrySkipped++;
+		}
+
+		// Texture table and material constants
+		if (bound == nullptr || bound->Mat != item.Mat)
+		{
+			device.setMaterial(*item.Mat);
+			stats.MaterialBinds++;
+		}
+		else
+		{
+			stats.MaterialSkipped++;
+		}
+
+		bound = &item;
+		device.setInstanceBase(batch.instanceOffset, batch.positionOffset);
+		device.drawIndexedInstanced(item.IndexCount, batch.instanceCount, item.StartIndexLocation, item.BaseVertexLocation);
+	}
+	return stats;
+}
+
+// Records every chunk into the device of the same index, in parallel; returns once all are recorded
+RenderStateStats RenderBatcher::executeChunks(const std::vector<RenderChunk>& chunks,
+	const std::vector<RenderDevice*>& devices, TaskScheduler& scheduler) const
+{
+	if (chunks.empty())
+		return RenderStateStats();
+
+	std::vector<RenderStateStats> chunkStats(chunks.size());
+	for (size_t i = 1; i < chunks.size(); ++i)
+	{
+		RenderDevice* device = devices[i];
+		const RenderChunk chunk = chunks[i];
+		RenderStateStats* stats = &chunkStats[i];
+		scheduler.schedule([this, device, chunk, stats]() { *stats = executeChunk(*device, chunk); });
+	}
+
+	// The calling thread takes the first chunk and helps with the rest while waiting
+	chunkStats[0] = executeChunk(*devices[0], chunks[0]);
+	scheduler.wait();
+
+	RenderStateStats stats;
+	for (const RenderStateStats& chunkStat : chunkStats)
+		stats += chunkStat;
+	return stats;
+}
+
+// Packs the fields of a sort key; each field is clamped to its bit width
+UINT64 RenderBatcher::makeSortKey(UINT pass, UINT pso, UINT material, UINT geometry, UINT depth)
+{
+	auto field = [](UINT value, unsigned int bits) { return (UINT64)std::min(value, (1u << bits) - 1); };
+
+	UINT64 key = field(pass, PassBits);
+	key = (key << PsoBits) | field(pso, PsoBits);
+	key = (key << MaterialBits) | field(material, MaterialBits);
+	key = (key << GeometryBits) | field(geometry, GeometryBits);
+	key = (key << DepthBits) | field(depth, DepthBits);
+	return key;
+}
+
+// Returns the batches built for this frame
+const std::vector<RenderBatch>& RenderBatcher::getBatches() const
+{
+	return mBatches;
+}
+
+// Returns the object constant index of every instance, in batch order
+const std::vector<UINT>& RenderBatcher::getInstanceObjects() const
+{
+	return mInstanceObjects;
+}
+
+// Returns the positions of the streams submitted this frame, culled ones removed once cull() ran
+const std::vector<XMFLOAT3>& RenderBatcher::getInstancePositions() const
+{
+	return mInstancePositions;
+}
+
+// Returns the id of the item's geometry and submesh, assigning new ones on first sight
+UINT RenderBatcher::getGeometryId(const RenderItem& item)
+{
+	auto found = mGeometryIds.find(item.Geo);
+	if (found == mGeometryIds.end())
+	{
+		GeometryIds ids;
+		ids.id = (UINT)mGeometryIds.size();
+		found = mGeometryIds.emplace(item.Geo, ids).first;
+	}
+
+	std::vector<Submesh>& submeshes = found->second.submeshes;
+	UINT submesh = 0;
+	while (submesh < submeshes.size()
+		&& !(submeshes[submesh].indexCount == item.IndexCount
+			&& submeshes[submesh].startIndexLocation == item.StartIndexLocation
+			&& submeshes[submesh].baseVertexLocation == item.BaseVertexLocation
+			&& submeshes[submesh].primitiveType == item.PrimitiveType))
+	{
+		++submesh;
+	}
+
+	if (submesh == submeshes.size())
+	{
+		Submesh added;
+		added.indexCount = item.IndexCount;
+		added.startIndexLocation = item.StartIndexLocation;
+		added.baseVertexLocation = item.BaseVertexLocation;
+		added.primitiveType = item.PrimitiveType;
+		submeshes.push_back(added);
+	}
+
+	return (found->second.id << SubmeshBits) | std::min(submesh, (1u << SubmeshBits) - 1);
+}
+
+// Returns the item's distance along the view direction, quantized so nearer items sort first
+UINT RenderBatcher::getDepth(const RenderItem& item) const
+{
+	if (mFarZ <= 0.0f)
+		return 0;
+
+	const float depth = (item.World._41 - mEyePosition.x) * mLook.x
+		+ (item.World._42 - mEyePosition.y) * mLook.y
+		+ (item.World._43 - mEyePosition.z) * mLook.z;
+
+	const float maxDepth = (float)((1u << DepthBits) - 1);
+	return (UINT)(std::min(std::max(depth / mFarZ, 0.0f), 1.0f) * maxDepth);
+}
+
+// Sorts the items by key with a stable LSD radix sort, one byte per pass.
+// Passes whose byte is the same for every key are skipped.
+void RenderBatcher::sortItems()
+{
+	const size_t count = mItems.size();
+	mSortScratch.resize(count);
+
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		size_t offsets[256] = {};
+		for (const SortEntry& entry : mItems)
+			offsets[(entry.key >> shift) & 0xFF]++;
+
+		if (count == 0 || offsets[(mItems[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		// Turn the histogram into the first output position of each byte value
+		size_t total = 0;
+		for (size_t& offset : offsets)
+		{
+			const size_t bucket = offset;
+			offset = total;
+			total += bucket;
+		}
+
+		for (const SortEntry& entry : mItems)
+			mSortScratch[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+
+		mItems.swap(mSortScratch);
+	}
+}
+
+// Returns true if two items can be drawn by the same instanced draw call
+bool RenderBatcher::isSameBatch(const RenderItem& a, const RenderItem& b)
+{
+	return a.Geo == b.Geo
+		&& a.IndexCount == b.IndexCount
+		&& a.StartIndexLocation == b.StartIndexLocation
+		&& a.BaseVertexLocation == b.BaseVertexLocation
+		&& a.PrimitiveType == b.PrimitiveType
+		&& a.Mat == b.Mat;
+}
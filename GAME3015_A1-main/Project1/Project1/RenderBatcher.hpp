@@ -0,0 +1,158 @@
+#pragma once
+#include "RenderItem.hpp"
+#include "RenderDevice.hpp"
+#include "FrustumCuller.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+class TaskScheduler;
+
+// One instanced draw: every instance shares the geometry, submesh, and material of item.
+// A position draw reads the object constants of item for every instance and takes the
+// translations from positionOffset on; other draws have RenderDevice::NoInstancePositions.
+struct RenderBatch
+{
+	const RenderItem*		item;
+	UINT					instanceOffset;
+	UINT					instanceCount;
+	UINT					positionOffset;
+};
+
+// Pipeline state binds a recording issued, and those it skipped because the
+// previous batch had already bound the same state
+struct RenderStateStats
+{
+	UINT					GeometryBinds = 0;
+	UINT					GeometrySkipped = 0;
+	UINT					MaterialBinds = 0;
+	UINT					MaterialSkipped = 0;
+
+	RenderStateStats&		operator+=(const RenderStateStats& other);
+};
+
+// Consecutive range of batches recorded into one command list
+struct RenderChunk
+{
+	UINT					firstBatch;
+	UINT					batchCount;
+};
+
+// Collects the render items submitted while drawing the scene graph and groups
+// them by (geometry, submesh, material) so each group becomes one instanced draw.
+// Items outside the view frustum can be culled before the batches are built.
+// Every item gets a 64-bit sort key of (pass, PSO, material, geometry, depth);
+// radix sorting on it makes batches adjacent and keeps batches sharing a
+// material or geometry next to each other, so their binds can be skipped.
+// Many copies of one item that only differ by position, such as projectiles, are
+// submitted as a position stream instead: one item and an array of positions,
+// culled per position and drawn as one position draw without object constants
+// of their own.
+// The batches can be split into chunks recorded on several threads, each into
+// its own device; submitting the chunks in order reproduces the sequential draw.
+// Only talks to the GPU through a RenderDevice, so the grouping can be checked
+// headless against a RecordingRenderDevice.
+class RenderBatcher
+{
+public:
+	// Bit fields of the sort key, from the most significant
+	static const unsigned int		PassBits = 4;
+	static const unsigned int		PsoBits = 8;
+	static const unsigned int		MaterialBits = 16;
+	static const unsigned int		GeometryBits = 20;
+	static const unsigned int		DepthBits = 16;
+
+	// Fewest instanced draws worth a command list of their own. A scene is only a
+	// handful of batches, so anything higher would never split it.
+	static const unsigned int		MinBatchesPerChunk = 2;
+
+
+public:
+									RenderBatcher();
+
+	void							setView(const DirectX::XMFLOAT3& eyePosition, const DirectX::XMFLOAT3& look, float farZ);
+	void							clear();
+	void							submit(RenderItem* item);
+	void							submitInstances(RenderItem* item, const DirectX::XMFLOAT3* positions, size_t count);
+	FrustumCuller::Stats			cull(FrustumCuller& culler);
+	void							build();
+	RenderStateStats				execute(RenderDevice& device) const;
+
+	std::vector<RenderChunk>		partition(unsigned int maxChunks, unsigned int minBatchesPerChunk) const;
+	void							uploadInstances(RenderDevice& device) const;
+	RenderStateStats				executeChunk(RenderDevice& device, const RenderChunk& chunk) const;
+	RenderStateStats				executeChunks(const std::vector<RenderChunk>& chunks,
+										const std::vector<RenderDevice*>& devices, TaskScheduler& scheduler) const;
+
+	static UINT64					makeSortKey(UINT pass, UINT pso, UINT material, UINT geometry, UINT depth);
+
+	const std::vector<RenderBatch>&	getBatches() const;
+	const std::vector<UINT>&		getInstanceObjects() const;
+	const std::vector<DirectX::XMFLOAT3>&	getInstancePositions() const;
+
+
+private:
+	// Index of the position stream of an entry, or NoStream for a single item
+	static const UINT				NoStream = 0xFFFFFFFF;
+
+	struct SortEntry
+	{
+		UINT64						key;
+		const RenderItem*			item;
+		UINT						stream;
+	};
+
+	// Positions of one submitInstances() call, a range of mInstancePositions
+	struct PositionStream
+	{
+		UINT						first;
+		UINT						count;
+	};
+
+	// Draw range and topology of an item within its geometry
+	struct Submesh
+	{
+		UINT						indexCount;
+		UINT						startIndexLocation;
+		int							baseVertexLocation;
+		UINT						primitiveType;
+	};
+
+	// Submeshes of one geometry, in the order they were first seen
+	struct GeometryIds
+	{
+		UINT						id;
+		std::vector<Submesh>		submeshes;
+	};
+
+
+private:
+	UINT							getGeometryId(const RenderItem& item);
+	UINT							getDepth(const RenderItem& item) const;
+	void							sortItems();
+
+	static bool						isSameBatch(const RenderItem& a, const RenderItem& b);
+
+
+private:
+	std::vector<SortEntry>			mItems;
+	std::vector<SortEntry>			mSortScratch;
+	std::vector<const RenderItem*>	mCullItems;
+	std::vector<UINT8>				mVisible;
+	std::vector<RenderBatch>		mBatches;
+
+	// Dense ids for the geometry and submesh fields of the sort key, kept across frames
+	std::unordered_map<const MeshGeometry*, GeometryIds>	mGeometryIds;
+
+	// Camera used for the depth field of the sort key
+	DirectX::XMFLOAT3				mEyePosition;
+	DirectX::XMFLOAT3				mLook;
+	float							mFarZ;
+
+	// Object constant index of every instance, contiguous per batch; one per position draw
+	std::vector<UINT>				mInstanceObjects;
+
+	// Positions of every stream submitted this frame, and the range of each stream
+	std::vector<DirectX::XMFLOAT3>	mInstancePositions;
+	std::vector<PositionStream>		mStreams;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+
+struct RenderItem;
+struct Material;
+struct ObjectConstants;
+struct MaterialConstants;
+struct PassConstants;
+
+namespace DirectX { struct XMFLOAT3; }
+
+// Everything the frame logic asks of the GPU: constant uploads, pipeline state
+// changes and draws. Game talks to the D3D12 implementation; a recording
+// implementation lets the same frame run headless.
+class RenderDevice
+{
+public:
+	// Position base of a draw whose instances take their whole world matrix from the object data
+	static const unsigned int		NoInstancePositions = 0xFFFFFFFF;
+
+
+public:
+	virtual							~RenderDevice() {}
+
+	virtual void					uploadObjectConstants(unsigned int firstIndex, const ObjectConstants* constants, unsigned int count) = 0;
+	virtual void					uploadMaterialConstants(unsigned int index, const MaterialConstants& constants) = 0;
+	virtual void					uploadPassConstants(const PassConstants& constants) = 0;
+	virtual void					uploadInstanceObjects(const std::vector<unsigned int>& objects) = 0;
+
+	// Uploads world positions that replace the translation of the instances of position draws
+	virtual void					uploadInstancePositions(const DirectX::XMFLOAT3* positions, unsigned int count) = 0;
+
+	// Binds the instance indices and positions uploaded for this frame, on devices that did not upload them
+	virtual void					bindInstanceObjects() = 0;
+
+	// Binds the per-frame pass and object buffers
+	virtual void					beginPass() = 0;
+	virtual void					setGeometry(const RenderItem& item) = 0;
+	virtual void					setMaterial(const Material& material) = 0;
+	// Offsets of the next draw into the instance indices and, unless NoInstancePositions, the positions
+	virtual void					setInstanceBase(unsigned int base, unsigned int positionBase) = 0;
+	virtual void					drawIndexedInstanced(unsigned int indexCount, unsigned int instanceCount,
+										unsigned int startIndexLocation, int baseVertexLocation) = 0;
+};
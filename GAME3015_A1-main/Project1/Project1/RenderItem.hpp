@@ -0,0 +1,46 @@
+#pragma once
+#include "../../Common/MathHelper.h"
+
+#include <DirectXCollision.h>
+
+struct Material;
+struct MeshGeometry;
+
+// Lightweight structure stores parameters to draw a shape.  This will
+// vary from app-to-app.
+struct RenderItem
+{
+	RenderItem() = default;
+
+	// World matrix of the shape that describes the object's local space
+	// relative to the world space, which defines the position, orientation,
+	// and scale of the object in the world.
+	DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
+
+	DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+
+	// Bit i is set while the item waits on the dirty list of frame resource i.
+	// Because we have an object cbuffer for each FrameResource, a change has to
+	// be queued on every FrameResource; see FrameConstants::markObjectDirty.
+	unsigned int DirtyFrames = 0;
+
+	// Index into GPU constant buffer corresponding to the ObjectCB for this render item.
+	UINT ObjCBIndex = -1;
+
+	// Draw order of the item this frame; see RenderBatcher::makeSortKey.
+	UINT64 SortKey = 0;
+
+	Material* Mat = nullptr;
+	MeshGeometry* Geo = nullptr;
+
+	// Primitive topology, a D3D_PRIMITIVE_TOPOLOGY value; 4 is D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST.
+	UINT PrimitiveType = 4;
+
+	// DrawIndexedInstanced parameters.
+	UINT IndexCount = 0;
+	UINT StartIndexLocation = 0;
+	int BaseVertexLocation = 0;
+
+	// Object space bounds of the submesh, used for frustum culling.
+	DirectX::BoundingBox Bounds;
+};
@@ -4,23 +4,40 @@
 //***************************************************************************************
 #include "SceneNode.hpp"
 #include "Game.hpp"
+#include "State.hpp"
 
 // Constructor
 SceneNode::SceneNode(State* state)
 	: mChildren()
 	, mParent(nullptr)
 	, mState(state)
+	, renderer(nullptr)
+	, mTransforms(&state->getTransforms())
+	, mSubtreeCategories(Category::None)
 {
-	// Initialize world position, scaling, and rotation to default values
-	mWorldPosition = XMFLOAT3(0, 0, 0);
-	mWorldScaling = XMFLOAT3(1, 1, 1);
-	mWorldRotation = XMFLOAT3(0, 0, 0);
+	// Allocate a slot in the state's transform store, initialized to identity
+	mTransformHandle = mTransforms->create();
+}
+
+// Destructor
+SceneNode::~SceneNode()
+{
+	mTransforms->destroy(mTransformHandle);
 }
 
 // Attach a child SceneNode to the current SceneNode
 void SceneNode::attachChild(Ptr child)
 {
+	assert(child->mTransforms == mTransforms);
+
 	child->mParent = this;
+	mTransforms->setParent(child->mTransformHandle, mTransformHandle);
+
+	// Fold the child's categories into the masks of every ancestor
+	child->mSubtreeCategories |= child->getCategory();
+	for (SceneNode* node = this; node != nullptr; node = node->mParent)
+		node->mSubtreeCategories |= node->getCategory() | child->mSubtreeCategories;
+
 	mChildren.push_back(std::move(child));
 }
 
@@ -32,7 +49,13 @@ SceneNode::Ptr SceneNode::detachChild(const SceneNode& node)
 
 	Ptr result = std::move(*found);
 	result->mParent = nullptr;
+	mTransforms->setParent(result->mTransformHandle, TransformStore::InvalidHandle);
 	mChildren.erase(found);
+
+	// Removing categories cannot be done with an OR, so rebuild the masks up the chain
+	for (SceneNode* node = this; node != nullptr; node = node->mParent)
+		node->refreshSubtreeCategories();
+
 	return result;
 }
 
@@ -84,6 +107,11 @@ void SceneNode::drawChildren() const
 void SceneNode::build()
 {
 	buildCurrent();
+
+	// Let the transform store keep the render item's world matrix in sync
+	if (renderer != nullptr)
+		mTransforms->setRenderItem(mTransformHandle, renderer, this);
+
 	buildChildren();
 }
 
@@ -105,85 +133,78 @@ void SceneNode::buildChildren()
 // Get the world position of the current SceneNode
 XMFLOAT3 SceneNode::getWorldPosition() const
 {
-	return mWorldPosition;
+	return mTransforms->getPosition(mTransformHandle);
 }
 
 // Set the current position
 void SceneNode::setPosition(float x, float y, float z)
 {
-	mWorldPosition = XMFLOAT3(x, y, z);
+	mTransforms->setPosition(mTransformHandle, x, y, z);
 }
 
 // Returns the world rotation of the scene node
 XMFLOAT3 SceneNode::getWorldRotation() const
 {
-	return mWorldRotation;
+	return mTransforms->getRotation(mTransformHandle);
 }
 
 // Sets the world rotation of the scene node with the given X, Y, and Z values
 void SceneNode::setWorldRotation(float x, float y, float z)
 {
-	mWorldRotation = XMFLOAT3(x, y, z);
+	mTransforms->setRotation(mTransformHandle, x, y, z);
 }
 
 // Returns the world scaling of the scene node
 XMFLOAT3 SceneNode::getWorldScale() const
 {
-	return mWorldScaling;
+	return mTransforms->getScale(mTransformHandle);
 }
 
 // Sets the world scaling of the scene node with the given X, Y, and Z values
 void SceneNode::setScale(float x, float y, float z)
 {
-	mWorldScaling = XMFLOAT3(x, y, z);
+	mTransforms->setScale(mTransformHandle, x, y, z);
 }
 
-// Calculates the world transform of the scene node by combining the transforms of all parent nodes
+// Returns the world transform of the scene node, resolved from the transform store
 XMFLOAT4X4 SceneNode::getWorldTransform() const
 {
-	XMFLOAT4X4 transform = MathHelper::Identity4x4();
-	XMMATRIX T = XMLoadFloat4x4(&transform);
-
-	// Traverse the parent nodes and multiply their transforms with the current transform
-	for (const SceneNode* node = this; node != nullptr; node = node->mParent)
-	{
-		XMMATRIX Tp = XMLoadFloat4x4(&node->getTransform());
-		T = Tp * T;
-	}
-	XMStoreFloat4x4(&transform, T);
-
-	return transform;
+	return mTransforms->getWorldTransform(mTransformHandle);
 }
 
-// Calculates the local transform of the scene node based on its position, rotation, and scaling
+// Returns the local transform of the scene node based on its position, rotation, and scaling
 XMFLOAT4X4 SceneNode::getTransform() const
 {
-	XMFLOAT4X4 transform;
-	XMStoreFloat4x4(&transform, XMMatrixScaling(mWorldScaling.x, mWorldScaling.y, mWorldScaling.z) *
-		XMMatrixRotationX(mWorldRotation.x) *
-		XMMatrixRotationY(mWorldRotation.y) *
-		XMMatrixRotationZ(mWorldRotation.z) *
-		XMMatrixTranslation(mWorldPosition.x, mWorldPosition.y, mWorldPosition.z));
-	return transform;
+	return mTransforms->getTransform(mTransformHandle);
 }
 
 // Moves the scene node by the given X, Y, and Z values
 void SceneNode::move(float x, float y, float z)
 {
-	mWorldPosition.x += x;
-	mWorldPosition.y += y;
-	mWorldPosition.z += z;
+	mTransforms->move(mTransformHandle, x, y, z);
 }
 
+// Executes the command on every matching node, skipping subtrees that contain no node of the command's category
 void SceneNode::onCommand(const Command& command, const GameTimer& gt)
 {
 	// Executes the given command on the current node if its category matches
 	if (command.category & getCategory())
 		command.action(*this, gt);
 
-	// Executes the command on all child nodes
+	// Executes the command on the child subtrees that contain a matching node
 	for (Ptr& child : mChildren)
-		child->onCommand(command, gt);
+	{
+		if (command.category & child->mSubtreeCategories)
+			child->onCommand(command, gt);
+	}
+}
+
+// Recomputes the category mask of this node from its own category and its children's masks
+void SceneNode::refreshSubtreeCategories()
+{
+	mSubtreeCategories = getCategory();
+	for (const Ptr& child : mChildren)
+		mSubtreeCategories |= child->mSubtreeCategories;
 }
 
 // Returns the category of the scene node
@@ -5,6 +5,8 @@
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
 #include "FrameResource.h"
+#include "RenderItem.hpp"
+#include "TransformStore.hpp"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -13,40 +15,6 @@ using namespace DirectX::PackedVector;
 #pragma comment(lib, "d3dcompiler.lib")
 #pragma comment(lib, "D3D12.lib")
 
-// Lightweight structure stores parameters to draw a shape.  This will
-// vary from app-to-app.
-struct RenderItem
-{
-	RenderItem() = default;
-
-	// World matrix of the shape that describes the object's local space
-	// relative to the world space, which defines the position, orientation,
-	// and scale of the object in the world.
-	XMFLOAT4X4 World = MathHelper::Identity4x4();
-
-	XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
-
-	// Dirty flag indicating the object data has changed and we need to update the constant buffer.
-	// Because we have an object cbuffer for each FrameResource, we have to apply the
-	// update to each FrameResource.  Thus, when we modify obect data we should set 
-	// NumFramesDirty = gNumFrameResources so that each frame resource gets the update.
-	int NumFramesDirty = gNumFrameResources;
-
-	// Index into GPU constant buffer corresponding to the ObjectCB for this render item.
-	UINT ObjCBIndex = -1;
-
-	Material* Mat = nullptr;
-	MeshGeometry* Geo = nullptr;
-
-	// Primitive topology.
-	D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-
-	// DrawIndexedInstanced parameters.
-	UINT IndexCount = 0;
-	UINT StartIndexLocation = 0;
-	int BaseVertexLocation = 0;
-};
-
 class State;
 struct Command;
 
@@ -58,6 +26,7 @@ public:
 
 public:
 	SceneNode(State* state);
+	virtual					~SceneNode();
 
 	void					attachChild(Ptr child);
 	Ptr						detachChild(const SceneNode& node);
@@ -90,14 +59,17 @@ private:
 	virtual void			buildCurrent();
 	void					buildChildren();
 
+	void					refreshSubtreeCategories();
+
 protected:
 	State*					mState;
 	RenderItem*				renderer;
 private:
-	XMFLOAT3				mWorldPosition;
-	XMFLOAT3				mWorldRotation;
-	XMFLOAT3				mWorldScaling;
+	TransformStore*			mTransforms;
+	TransformStore::Handle	mTransformHandle;
 	std::vector<Ptr>		mChildren;
 	SceneNode*				mParent;
-};
 
+	// OR of the categories of this node and all of its descendants, kept up to date by attachChild/detachChild
+	unsigned int			mSubtreeCategories;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include "../../Common/MathHelper.h"
+#include "../../Common/Material.h"
+
+// Padded to the 256-byte constant buffer stride, so a run of objects with
+// consecutive indices uploads with one memcpy.
+struct ObjectConstants
+{
+    DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
+	DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 Pad0 = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 Pad1 = MathHelper::Identity4x4();
+};
+
+struct PassConstants
+{
+    DirectX::XMFLOAT4X4 View = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 InvView = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 Proj = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 InvProj = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 ViewProj = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 InvViewProj = MathHelper::Identity4x4();
+    DirectX::XMFLOAT3 EyePosW = { 0.0f, 0.0f, 0.0f };
+    float cbPerObjectPad1 = 0.0f;
+    DirectX::XMFLOAT2 RenderTargetSize = { 0.0f, 0.0f };
+    DirectX::XMFLOAT2 InvRenderTargetSize = { 0.0f, 0.0f };
+    float NearZ = 0.0f;
+    float FarZ = 0.0f;
+    float TotalTime = 0.0f;
+    float DeltaTime = 0.0f;
+
+    DirectX::XMFLOAT4 AmbientLight = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+    // Indices [0, NUM_DIR_LIGHTS) are directional lights;
+    // indices [NUM_DIR_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHTS) are point lights;
+    // indices [NUM_DIR_LIGHTS+NUM_POINT_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHT+NUM_SPOT_LIGHTS)
+    // are spot lights for a maximum of MaxLights per object.
+    Light Lights[MaxLights];
+};
@@ -34,11 +34,32 @@ SamplerState gsamPointWrap : register(s0);
 
 
 
-// Constant data that varies per object.
-cbuffer cbPerObject : register(b0)
+// Data that varies per object. Mirrors ObjectConstants, padded to the
+// 256-byte constant buffer stride of the object buffer it is read from.
+struct ObjectData
 {
-    float4x4 gWorld;
-    float4x4 gTexTransform;
+    float4x4 World;
+    float4x4 TexTransform;
+    float4x4 Pad0;
+    float4x4 Pad1;
+};
+
+StructuredBuffer<ObjectData> gObjectData : register(t0, space1);
+
+// Object index of every instance, grouped per instanced draw.
+StructuredBuffer<uint> gInstanceObjects : register(t1, space1);
+
+// World position of every instance of a position draw; see RenderBatcher::submitInstances.
+StructuredBuffer<float3> gInstancePositions : register(t2, space1);
+
+// gPositionBase of draws whose instances read their whole world matrix from the object data.
+#define NO_INSTANCE_POSITIONS 0xFFFFFFFF
+
+// Constant data that varies per draw call.
+cbuffer cbInstance : register(b0)
+{
+    uint gInstanceBase;
+    uint gPositionBase;
 };
 
 // Constant data that varies per frame.
@@ -93,16 +114,29 @@ struct VertexOut
 	float2 TexC    : TEXCOORD;
 };
 
-VertexOut VS(VertexIn vin)
+VertexOut VS(VertexIn vin, uint instanceID : SV_InstanceID)
 {
 	VertexOut vout = (VertexOut)0.0f;
+
+    // Fetch the object this instance draws. The instances of a position draw share one
+    // object and only replace its translation.
+    ObjectData obj;
+    if (gPositionBase == NO_INSTANCE_POSITIONS)
+    {
+        obj = gObjectData[gInstanceObjects[gInstanceBase + instanceID]];
+    }
+    else
+    {
+        obj = gObjectData[gInstanceObjects[gInstanceBase]];
+        obj.World[3].xyz = gInstancePositions[gPositionBase + instanceID];
+    }
 	
     // Transform to world space.
-    float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+    float4 posW = mul(float4(vin.PosL, 1.0f), obj.World);
     vout.PosW = posW.xyz;
 
     // Assumes nonuniform scaling; otherwise, need to use inverse-transpose of world matrix.
-    vout.NormalW = mul(vin.NormalL, (float3x3)gWorld);
+    vout.NormalW = mul(vin.NormalL, (float3x3)obj.World);
 
     // Transform to homogeneous clip space.
     vout.PosH = mul(posW, gViewProj);
@@ -114,7 +148,7 @@ VertexOut VS(VertexIn vin)
     //We use two separate texture transformation matrices gTexTransform and gMatTransform .
     //Because sometimes it makes more sense for the material to transform the textures (for animated materials like water), but sometimes it makes more sense for the texture transform to be a property of the object.
 
-    float4 texC = mul(float4(vin.TexC, 0.0f, 1.0f), gTexTransform);
+    float4 texC = mul(float4(vin.TexC, 0.0f, 1.0f), obj.TexTransform);
 
     //Hooman1 - From Class Video
     vout.TexC = mul(texC, gMatTransform).xy;
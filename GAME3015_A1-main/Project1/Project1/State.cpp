@@ -21,13 +21,14 @@ State::State(StateStack* stack, Context* context)
 	, mContext(context)
 	, mCameraPos(0.f, 0.f, 0.f)
 	, mSceneGraph(std::make_unique<SceneNode>(this))
+	, mActive(false)
 {
 }
 
-// Destructor
+// Destructor, frees the object constant slots of the state's render items
 State::~State()
 {
-
+	mContext->game->getFrameConstants().releaseObjects(mAllRitems);
 }
 
 // Returns a pointer to the Context object
@@ -36,6 +37,50 @@ State::Context* State::getContext() const
 	return mContext;
 }
 
+// Blends the state's transforms between its last two simulation steps
+void State::interpolate(float alpha, std::vector<RenderItem*>& changed)
+{
+	mTransforms.interpolate(alpha, changed);
+}
+
+// Publishes the render items allocated so far; from now on new ones are published right away
+void State::activate()
+{
+	if (mActive)
+		return;
+
+	FrameConstants& frameConstants = mContext->game->getFrameConstants();
+	for (const auto& run : mUnpublishedObjects)
+		frameConstants.publishObjects(run.first, run.second);
+	mUnpublishedObjects.clear();
+	mActive = true;
+
+	onActivate();
+}
+
+// Reserves an object constant slot for a render item and returns its index
+UINT State::allocateObject(RenderItem* item)
+{
+	allocateObjects(item, 1);
+	return item->ObjCBIndex;
+}
+
+// Reserves consecutive object constant slots for an array of render items.
+// A state under construction may be on a background thread, so its items wait for activate().
+void State::allocateObjects(RenderItem* items, size_t count)
+{
+	FrameConstants& frameConstants = mContext->game->getFrameConstants();
+	if (count == 1)
+		frameConstants.allocateObject(items);
+	else
+		frameConstants.allocateObjects(items, count);
+
+	if (mActive)
+		frameConstants.publishObjects(items, count);
+	else
+		mUnpublishedObjects.push_back(std::make_pair(items, count));
+}
+
 // Adds a new state to the stack
 void State::requestStackPush(States::ID stateID)
 {
@@ -54,4 +99,16 @@ void State::requestStateClear()
 	mStack->clearStates();
 }
 
+// Starts building a state in the background, so a later push of it does not hitch;
+// the stack drops it again if this state leaves the stack without pushing it
+void State::requestStatePreload(States::ID stateID)
+{
+	mStack->preloadState(stateID, this);
+}
+
+// Does nothing by default
+void State::onActivate()
+{
+}
+
 
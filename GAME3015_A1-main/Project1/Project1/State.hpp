@@ -6,6 +6,8 @@
 
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -35,17 +37,36 @@ public:
 	virtual bool handleEvent(WPARAM btnState) = 0;
 	virtual bool handleRealtimeInput() = 0;
 
+	// States that leave part of the screen uncovered return false, so the states below are drawn too
+	virtual bool isOpaque() const { return true; }
+
+	// Places the render items between the last two simulation steps, collecting the ones that changed
+	virtual void interpolate(float alpha, std::vector<RenderItem*>& changed);
+
+	// Called by the stack when the state is put on it; publishes the render items built so far
+	void activate();
+
+	// Reserves object constant slots for render items; they are published once the state is active
+	UINT allocateObject(RenderItem* item);
+	void allocateObjects(RenderItem* items, size_t count);
+
 
 	XMFLOAT3 getCameraPos() { return mCameraPos; }
 	XMFLOAT3 getTargetPos() { return mTargetPos; }
 
 	std::vector<std::unique_ptr<RenderItem>>& getRenderItems() { return mAllRitems; }
+	TransformStore& getTransforms() { return mTransforms; }
 	Context* getContext() const;
 
 protected:
 	void requestStackPush(States::ID stateID);
 	void requestStackPop();
 	void requestStateClear();
+	void requestStatePreload(States::ID stateID);
+
+	// Called once the state is on the stack; a state built in the background must not start preloads before
+	// that, or a preload the player never asked for would build the next state too
+	virtual void onActivate();
 
 protected:
 	StateStack* mStack;
@@ -54,8 +75,14 @@ protected:
 	XMFLOAT3 mCameraPos;
 	XMFLOAT3 mTargetPos;
 
+	// Declared before the scene graph so it outlives every node holding a slot in it
+	TransformStore mTransforms;
 	std::unique_ptr<SceneNode> mSceneGraph;
 
 	std::vector<std::unique_ptr<RenderItem>> mAllRitems;
+
+	// Render items allocated while the state may still be building in the background
+	bool mActive;
+	std::vector<std::pair<RenderItem*, size_t>> mUnpublishedObjects;
 };
 
@@ -7,6 +7,7 @@ namespace States
 		Title,
 		Menu,
 		Game,
-		Pause
+		Pause,
+		Loading
 	};
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #include "StateStack.hpp"
 #include <cassert>
+#include <algorithm>
+#include <chrono>
 #include "Game.hpp"
 
 // Constructor for StateStack
@@ -13,26 +15,69 @@ StateStack::StateStack(State::Context context)
 	, mPendingList()
 	, mContext(context)
 	, mFactories()
+	, mFrozenCount(0)
+	, mLastTransitionMs(0.f)
+	, mMaxTransitionMs(0.f)
+	, mPreloadMutex()
+	, mPreloads()
+	, mDroppedPreloads()
+	, mLoadingState(nullptr)
+	, mAwaitedState(States::None)
 {
 }
 
-// Iterates over the stack and calls update method of each state
+// Destructor, waits for the background preloads, including the dropped ones
+StateStack::~StateStack()
+{
+	std::map<States::ID, Preload> preloads;
+	{
+		std::lock_guard<std::mutex> lock(mPreloadMutex);
+		preloads.swap(mPreloads);
+	}
+
+	for (auto& preload : preloads)
+		preload.second.state.wait();
+	for (auto& preload : mDroppedPreloads)
+		preload.wait();
+}
+
+// Iterates over the stack and calls update method of each state, until one keeps the states below it frozen
 void StateStack::update(const GameTimer& gt)
 {
-	for (auto itr = mStack.rbegin(); itr != mStack.rend(); ++itr)
+	mFrozenCount = 0;
+	for (size_t i = mStack.size(); i > 0; --i)
 	{
-		if (!(*itr)->update(gt))
+		if (!mStack[i - 1]->update(gt))
+		{
+			mFrozenCount = i - 1;
 			break;
+		}
 	}
 
+	swapInPreloadedState();
 	applyPendingChanges();
+	collectDroppedPreloads();
 }
 
-// Iterates over the stack and calls draw method of each state
+// Draws the topmost opaque state and everything above it
 void StateStack::draw()
 {
-	for (State::StatePtr& state : mStack)
-		state->draw();
+	size_t first = mStack.size();
+	while (first > 0 && !mStack[first - 1]->isOpaque())
+		--first;
+	if (first > 0)
+		--first;
+
+	for (size_t i = first; i < mStack.size(); ++i)
+		mStack[i]->draw();
+}
+
+// Blends every state between its last two simulation steps, collecting the render items that changed
+void StateStack::interpolate(float alpha, std::vector<RenderItem*>& changed)
+{
+	// Frozen states did not step, so they show their last step as is
+	for (size_t i = 0; i < mStack.size(); ++i)
+		mStack[i]->interpolate(i < mFrozenCount ? 1.f : alpha, changed);
 }
 
 // Iterates over the stack and calls handleEvent method of each state
@@ -73,6 +118,21 @@ void StateStack::clearStates()
 	mPendingList.push_back(PendingChange(Clear));
 }
 
+// Starts constructing a state on a background thread for a state on the stack; pushing it later picks up the result
+void StateStack::preloadState(States::ID stateID, const State* requester)
+{
+	std::lock_guard<std::mutex> lock(mPreloadMutex);
+	if (mPreloads.count(stateID) != 0)
+		return;
+
+	Preload& preload = mPreloads[stateID];
+	preload.requester = requester;
+	preload.state = std::async(std::launch::async, [this, stateID]()
+	{
+		return createState(stateID);
+	});
+}
+
 // Returns true if the stack is empty, false otherwise
 bool StateStack::isEmpty() const
 {
@@ -105,6 +165,18 @@ State* StateStack::getCurrentState()
 	return mStack.back().get();
 }
 
+// Returns how long the last batch of state changes took to apply, in milliseconds
+float StateStack::getLastTransitionMs() const
+{
+	return mLastTransitionMs;
+}
+
+// Returns the longest batch of state changes so far, in milliseconds
+float StateStack::getMaxTransitionMs() const
+{
+	return mMaxTransitionMs;
+}
+
 // Creates a new state with the given state ID using the corresponding factory method
 State::StatePtr StateStack::createState(States::ID stateID)
 {
@@ -113,17 +185,84 @@ State::StatePtr StateStack::createState(States::ID stateID)
 	return found->second();
 }
 
+// Returns true if a state is being or has been built in the background
+bool StateStack::hasPreload(States::ID stateID)
+{
+	std::lock_guard<std::mutex> lock(mPreloadMutex);
+	return mPreloads.count(stateID) != 0;
+}
+
+// Takes a preloaded state if it is fully built; returns nullptr otherwise
+State::StatePtr StateStack::takePreloadedState(States::ID stateID)
+{
+	std::future<State::StatePtr> preload;
+	{
+		std::lock_guard<std::mutex> lock(mPreloadMutex);
+		auto found = mPreloads.find(stateID);
+		if (found == mPreloads.end())
+			return nullptr;
+		if (found->second.state.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return nullptr;
+
+		preload = std::move(found->second.state);
+		mPreloads.erase(found);
+	}
+	return preload.get();
+}
+
+// Replaces the loading state with the state it waits for, once that one is built
+void StateStack::swapInPreloadedState()
+{
+	if (mLoadingState == nullptr)
+		return;
+
+	State::StatePtr state = takePreloadedState(mAwaitedState);
+	if (state == nullptr)
+		return;
+
+	auto start = std::chrono::steady_clock::now();
+
+	state->activate();
+	mStack.back() = std::move(state);
+	mLoadingState = nullptr;
+	mAwaitedState = States::None;
+	mFrozenCount = 0;
+
+	mLastTransitionMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	mMaxTransitionMs = std::max(mMaxTransitionMs, mLastTransitionMs);
+}
+
 // Apply any pending changes to the state stack
 void StateStack::applyPendingChanges()
 {
+	if (mPendingList.empty())
+		return;
+
+	auto start = std::chrono::steady_clock::now();
+
 	// Depending on the change type, push, pop, or clear the stack
 	for (PendingChange change : mPendingList)
 	{
 		switch (change.action)
 		{
 		case Push:
-			mStack.push_back(createState(change.stateID));
+		{
+			// A preloaded state is swapped in once built; until then a loading state stands in
+			State::StatePtr state = takePreloadedState(change.stateID);
+			if (state == nullptr && mAwaitedState == States::None && hasPreload(change.stateID))
+			{
+				state = createState(States::Loading);
+				mLoadingState = state.get();
+				mAwaitedState = change.stateID;
+			}
+			else if (state == nullptr)
+			{
+				state = createState(change.stateID);
+			}
+			state->activate();
+			mStack.push_back(std::move(state));
 			break;
+		}
 		case Pop:
 			mStack.pop_back();
 			break;
@@ -133,8 +272,54 @@ void StateStack::applyPendingChanges()
 		}
 	}
 
+	// Stop waiting if the loading state was removed again
+	if (mLoadingState != nullptr && (mStack.empty() || mStack.back().get() != mLoadingState))
+	{
+		mLoadingState = nullptr;
+		mAwaitedState = States::None;
+	}
+
 	// Clear the list of pending changes
 	mPendingList.clear();
+
+	dropStalePreloads();
+
+	// The stack changed, so nothing is known to be frozen until the next update
+	mFrozenCount = 0;
+
+	mLastTransitionMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	mMaxTransitionMs = std::max(mMaxTransitionMs, mLastTransitionMs);
+}
+
+// Drops the preloads whose requester is no longer on the stack, unless a loading state waits for them
+void StateStack::dropStalePreloads()
+{
+	std::lock_guard<std::mutex> lock(mPreloadMutex);
+	for (auto found = mPreloads.begin(); found != mPreloads.end();)
+	{
+		const State* requester = found->second.requester;
+		const bool requesterOnStack = std::any_of(mStack.begin(), mStack.end(),
+			[requester](const State::StatePtr& state) { return state.get() == requester; });
+
+		if (requesterOnStack || found->first == mAwaitedState)
+		{
+			++found;
+			continue;
+		}
+
+		mDroppedPreloads.push_back(std::move(found->second.state));
+		found = mPreloads.erase(found);
+	}
+}
+
+// Destroys the dropped preloads that finished building; the others are looked at again next update
+void StateStack::collectDroppedPreloads()
+{
+	mDroppedPreloads.erase(std::remove_if(mDroppedPreloads.begin(), mDroppedPreloads.end(),
+		[](std::future<State::StatePtr>& preload)
+		{
+			return preload.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}), mDroppedPreloads.end());
 }
 
 // Constructor for a pending change
@@ -7,6 +7,8 @@
 #include <utility>
 #include <functional>
 #include <map>
+#include <future>
+#include <mutex>
 
 class StateStack
 {
@@ -19,27 +21,39 @@ public:
 	};
 public:
 	explicit StateStack(State::Context context);
+	~StateStack();
 	
 	template <typename T>
 	void registerState(States::ID stateID);
 
 	void update(const GameTimer& gt);
 	void draw();
+	void interpolate(float alpha, std::vector<RenderItem*>& changed);
 	void handleEvent(WPARAM btnState);
 	void handleRealtimeInput();
 
 	void pushState(States::ID stateID);
 	void popState();
 	void clearStates();
+	void preloadState(States::ID stateID, const State* requester);
 
 	bool isEmpty() const;
 
 	XMFLOAT3 getCameraPos();
 	XMFLOAT3 getTargetPos();
 	State* getCurrentState();
+
+	// Time spent applying the last batch of pushes and pops, and the longest one so far
+	float getLastTransitionMs() const;
+	float getMaxTransitionMs() const;
 private:
 	State::StatePtr createState(States::ID stateID);
+	bool hasPreload(States::ID stateID);
+	State::StatePtr takePreloadedState(States::ID stateID);
+	void swapInPreloadedState();
 	void applyPendingChanges();
+	void dropStalePreloads();
+	void collectDroppedPreloads();
 
 private:
 	struct PendingChange
@@ -50,12 +64,37 @@ private:
 		States::ID			stateID;
 	};
 
+	// A state being built in the background, and the state on the stack that asked for it
+	struct Preload
+	{
+		std::future<State::StatePtr>	state;
+		const State*		requester;
+	};
+
 private:
 	std::vector<State::StatePtr>	mStack;
 	std::vector<PendingChange>	mPendingList;
 
 	State::Context	mContext;
 	std::map<States::ID, std::function<State::StatePtr()>> mFactories;
+
+	// Number of states at the bottom of the stack that were not updated last time
+	size_t			mFrozenCount;
+
+	float			mLastTransitionMs;
+	float			mMaxTransitionMs;
+
+	// States being built on background threads, requested by states on the
+	// stack. A preload whose requester left the stack is dropped: it finishes
+	// building in mDroppedPreloads and is destroyed once done, without blocking.
+	// The mutex is declared first so it outlives the futures' destructors.
+	std::mutex		mPreloadMutex;
+	std::map<States::ID, Preload> mPreloads;
+	std::vector<std::future<State::StatePtr>> mDroppedPreloads;
+
+	// Loading state standing in for a pushed state whose preload is not done yet
+	State*			mLoadingState;
+	States::ID		mAwaitedState;
 };
 
 
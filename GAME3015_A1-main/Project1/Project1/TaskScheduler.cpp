@@ -0,0 +1,176 @@
+//***************************************************************************************
+// TaskScheduler.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "TaskScheduler.hpp"
+
+#include <algorithm>
+
+// Identifies the scheduler and deque owned by the current worker thread
+static thread_local const TaskScheduler* sOwner = nullptr;
+static thread_local unsigned int sWorkerIndex = 0;
+
+// Constructor, starts the worker threads
+TaskScheduler::TaskScheduler(unsigned int workerCount)
+	: mPending(0)
+	, mQueued(0)
+	, mNextWorker(0)
+	, mError()
+	, mStopping(false)
+{
+	for (unsigned int i = 0; i < workerCount + 1; ++i)
+		mWorkers.push_back(std::make_unique<Worker>());
+
+	for (unsigned int i = 0; i < workerCount; ++i)
+		mThreads.emplace_back(&TaskScheduler::run, this, i);
+}
+
+// Destructor, finishes outstanding work and joins the worker threads; exceptions of unwaited tasks are dropped
+TaskScheduler::~TaskScheduler()
+{
+	runUntilIdle();
+
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mStopping = true;
+	}
+	mWake.notify_all();
+
+	for (std::thread& thread : mThreads)
+		thread.join();
+}
+
+// Queues a task; tasks scheduled from a worker go to that worker's own deque
+void TaskScheduler::schedule(Task task)
+{
+	unsigned int index;
+	if (sOwner == this)
+		index = sWorkerIndex;
+	else if (mThreads.empty())
+		index = (unsigned int)mWorkers.size() - 1;
+	else
+		index = mNextWorker++ % (unsigned int)mThreads.size();
+
+	mPending++;
+	{
+		std::lock_guard<std::mutex> lock(mWorkers[index]->mutex);
+		mWorkers[index]->tasks.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mQueued++;
+	}
+	mWake.notify_one();
+}
+
+// Blocks until every scheduled task has finished, running tasks on the calling thread meanwhile;
+// then rethrows the first exception a task threw, if any
+void TaskScheduler::wait()
+{
+	runUntilIdle();
+
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(mErrorMutex);
+		std::swap(error, mError);
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
+
+// Runs tasks on the calling thread until none are pending
+void TaskScheduler::runUntilIdle()
+{
+	const unsigned int index = sOwner == this ? sWorkerIndex : (unsigned int)mWorkers.size() - 1;
+
+	while (mPending > 0)
+	{
+		if (!runOneTask(index))
+			std::this_thread::yield();
+	}
+}
+
+// Returns the number of worker threads, not counting the thread that calls wait()
+unsigned int TaskScheduler::getWorkerCount() const
+{
+	return (unsigned int)mThreads.size();
+}
+
+// Returns one worker per hardware thread, leaving one for the main thread
+unsigned int TaskScheduler::hardwareWorkerCount()
+{
+	return std::max(1u, std::thread::hardware_concurrency()) - 1;
+}
+
+// Worker loop: run local or stolen work, sleep when there is none
+void TaskScheduler::run(unsigned int index)
+{
+	sOwner = this;
+	sWorkerIndex = index;
+
+	while (true)
+	{
+		if (runOneTask(index))
+			continue;
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mWake.wait(lock, [this]() { return mStopping || mQueued > 0; });
+		if (mStopping && mQueued == 0)
+			return;
+	}
+}
+
+// Runs a single task from the given deque or a stolen one; returns false if none was found
+bool TaskScheduler::runOneTask(unsigned int index)
+{
+	Task task;
+	if (!popTask(index, task) && !stealTask(index, task))
+		return false;
+
+	// A throwing task must still count as done, or wait() would spin forever
+	mQueued--;
+	try
+	{
+		task();
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(mErrorMutex);
+		if (!mError)
+			mError = std::current_exception();
+	}
+	mPending--;
+	return true;
+}
+
+// Takes the most recently queued task of a deque
+bool TaskScheduler::popTask(unsigned int index, Task& task)
+{
+	Worker& worker = *mWorkers[index];
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.tasks.empty())
+		return false;
+
+	task = std::move(worker.tasks.back());
+	worker.tasks.pop_back();
+	return true;
+}
+
+// Takes the oldest task of another deque
+bool TaskScheduler::stealTask(unsigned int thief, Task& task)
+{
+	const unsigned int count = (unsigned int)mWorkers.size();
+	for (unsigned int offset = 1; offset < count; ++offset)
+	{
+		Worker& victim = *mWorkers[(thief + offset) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.tasks.empty())
+			continue;
+
+		task = std::move(victim.tasks.front());
+		victim.tasks.pop_front();
+		return true;
+	}
+	return false;
+}
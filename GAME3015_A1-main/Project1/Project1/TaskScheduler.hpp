@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a task deque: it takes its own
+// work from the back and, when idle, steals from the front of the others.
+// The thread calling wait() helps out until all scheduled tasks are done.
+// A task that throws still counts as done; wait() rethrows the first
+// exception thrown since the previous wait().
+class TaskScheduler
+{
+public:
+	typedef std::function<void()> Task;
+
+
+public:
+	explicit						TaskScheduler(unsigned int workerCount);
+									~TaskScheduler();
+									TaskScheduler(const TaskScheduler&) = delete;
+	TaskScheduler&					operator=(const TaskScheduler&) = delete;
+
+	void							schedule(Task task);
+	void							wait();
+	unsigned int					getWorkerCount() const;
+
+	static unsigned int				hardwareWorkerCount();
+
+private:
+	struct Worker
+	{
+		std::mutex					mutex;
+		std::deque<Task>			tasks;
+	};
+
+private:
+	void							run(unsigned int index);
+	void							runUntilIdle();
+	bool							runOneTask(unsigned int index);
+	bool							popTask(unsigned int index, Task& task);
+	bool							stealTask(unsigned int thief, Task& task);
+
+
+private:
+	// One deque per worker plus one for the thread that calls wait()
+	std::vector<std::unique_ptr<Worker>>	mWorkers;
+	std::vector<std::thread>		mThreads;
+
+	std::atomic<int>				mPending;
+	std::atomic<int>				mQueued;
+	std::atomic<unsigned int>		mNextWorker;
+
+	// First exception a task threw since the last wait()
+	std::exception_ptr				mError;
+	std::mutex						mErrorMutex;
+
+	std::mutex						mSleepMutex;
+	std::condition_variable			mWake;
+	bool							mStopping;
+};
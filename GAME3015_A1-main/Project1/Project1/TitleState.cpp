@@ -11,10 +11,8 @@
 TitleState::TitleState(StateStack* stack, Context* context)
     : State(stack, context)
 {
-    // Clear all rendering items, reset frame resources, and build materials
+    // Clear all rendering items
     mAllRitems.clear();
-    mContext->game->ResetFrameResources();
-    mContext->game->BuildMaterials();
 
     // Create background sprite and set its properties
     std::unique_ptr<SpriteNode> backgroundSprite = std::make_unique<SpriteNode>(this);
@@ -23,9 +21,14 @@ TitleState::TitleState(StateStack* stack, Context* context)
     backgroundSprite->setPosition(0, 0, 0);
     mSceneGraph->attachChild(std::move(backgroundSprite));
     
-    // Build the scene graph and frame resources
+    // Build the scene graph
     mSceneGraph->build();
-    mContext->game->BuildFrameResources(mAllRitems.size());
+}
+
+// Builds the menu in the background while the title is shown
+void TitleState::onActivate()
+{
+    requestStatePreload(States::Menu);
 }
 
 // Destructor
@@ -43,6 +46,7 @@ void TitleState::draw()
 bool TitleState::update(const GameTimer& gt)
 {
     mSceneGraph->update(gt);
+    mTransforms.update();
     return true;
 }
 
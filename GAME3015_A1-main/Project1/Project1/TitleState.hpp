@@ -11,5 +11,8 @@ public:
     virtual bool handleEvent(WPARAM btnState)override;
     virtual bool handleRealtimeInput()override;
 
+protected:
+    virtual void onActivate()override;
+
 };
 
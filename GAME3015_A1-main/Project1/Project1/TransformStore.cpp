@@ -0,0 +1,577 @@
+//***************************************************************************************
+// TransformStore.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "TransformStore.hpp"
+#include "RenderItem.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+// Reorders a column so that slot k holds the element previously at order[k]
+template <typename T>
+static void permute(std::vector<T>& column, const std::vector<int>& order)
+{
+	std::vector<T> result;
+	result.reserve(order.size());
+	for (int index : order)
+		result.push_back(column[index]);
+	column.swap(result);
+}
+
+// Loads up to four consecutive floats of a column into the lanes of a vector
+static XMVECTOR loadLanes(const std::vector<float>& column, int first, int lanes, float pad)
+{
+	if (lanes == 4)
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&column[first]));
+
+	float values[4] = { pad, pad, pad, pad };
+	for (int lane = 0; lane < lanes; ++lane)
+		values[lane] = column[first + lane];
+	return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(values));
+}
+
+// Constructor
+TransformStore::TransformStore()
+	: mOrderDirty(false)
+	, mSpatialTree(nullptr)
+{
+}
+
+// Allocates a slot with an identity transform and returns its handle
+TransformStore::Handle TransformStore::create()
+{
+	Handle handle;
+	if (!mFreeHandles.empty())
+	{
+		handle = mFreeHandles.back();
+		mFreeHandles.pop_back();
+	}
+	else
+	{
+		handle = (Handle)mIndices.size();
+		mIndices.push_back(-1);
+	}
+
+	// New slots are roots, so appending them keeps the parent-before-child order
+	mIndices[handle] = (int)mParent.size();
+
+	mPositionX.push_back(0.f);
+	mPositionY.push_back(0.f);
+	mPositionZ.push_back(0.f);
+	mRotationX.push_back(0.f);
+	mRotationY.push_back(0.f);
+	mRotationZ.push_back(0.f);
+	mScaleX.push_back(1.f);
+	mScaleY.push_back(1.f);
+	mScaleZ.push_back(1.f);
+
+	mParent.push_back(-1);
+	mHandles.push_back(handle);
+	mAlive.push_back(1);
+	mTransformDirty.push_back(1);
+	mWorldTransformDirty.push_back(1);
+
+	mWorldVersion.push_back(0);
+	mParentVersion.push_back(0);
+	mRenderVersion.push_back(0);
+	mRenderItems.push_back(nullptr);
+	mNodes.push_back(nullptr);
+	mProxies.push_back(DynamicAabbTree::NullNode);
+	mProxyVersion.push_back(0);
+
+	mTransforms.push_back(MathHelper::Identity4x4());
+	mWorldTransforms.push_back(MathHelper::Identity4x4());
+	mPreviousWorldTransforms.push_back(MathHelper::Identity4x4());
+	mSteppedWorldTransforms.push_back(MathHelper::Identity4x4());
+	mStepped.push_back(0);
+
+	return handle;
+}
+
+// Releases a slot; the handle is recycled the next time the store is compacted
+void TransformStore::destroy(Handle handle)
+{
+	int index = mIndices[handle];
+	assert(index >= 0 && mAlive[index]);
+
+	mAlive[index] = 0;
+	destroyProxy(index);
+	mRenderItems[index] = nullptr;
+	mNodes[index] = nullptr;
+	mReleasedHandles.push_back(handle);
+	mOrderDirty = true;
+}
+
+// Links a slot to its parent slot, or detaches it when parent is InvalidHandle
+void TransformStore::setParent(Handle handle, Handle parent)
+{
+	int index = mIndices[handle];
+	int parentIndex = parent != InvalidHandle ? mIndices[parent] : -1;
+
+	mParent[index] = parentIndex;
+	mWorldTransformDirty[index] = 1;
+
+	// A parent stored after its child breaks the single sweep, so reorder before the next one
+	if (parentIndex > index)
+		mOrderDirty = true;
+}
+
+// Associates a render item whose World matrix follows this slot's world transform; node is reported by spatial queries
+void TransformStore::setRenderItem(Handle handle, RenderItem* renderItem, SceneNode* node)
+{
+	int index = mIndices[handle];
+	destroyProxy(index);
+	mRenderItems[index] = renderItem;
+	mNodes[index] = node;
+	mRenderVersion[index] = mWorldVersion[index] - 1;
+}
+
+// Attaches the tree that update() keeps the render items' world bounds in; it must outlive the store
+void TransformStore::setSpatialTree(DynamicAabbTree* tree)
+{
+	mSpatialTree = tree;
+}
+
+// Returns the local position of a slot
+XMFLOAT3 TransformStore::getPosition(Handle handle) const
+{
+	int index = mIndices[handle];
+	return XMFLOAT3(mPositionX[index], mPositionY[index], mPositionZ[index]);
+}
+
+// Sets the local position of a slot
+void TransformStore::setPosition(Handle handle, float x, float y, float z)
+{
+	int index = mIndices[handle];
+	mPositionX[index] = x;
+	mPositionY[index] = y;
+	mPositionZ[index] = z;
+	mTransformDirty[index] = 1;
+	mWorldTransformDirty[index] = 1;
+}
+
+// Offsets the local position of a slot
+void TransformStore::move(Handle handle, float x, float y, float z)
+{
+	int index = mIndices[handle];
+	mPositionX[index] += x;
+	mPositionY[index] += y;
+	mPositionZ[index] += z;
+	mTransformDirty[index] = 1;
+	mWorldTransformDirty[index] = 1;
+}
+
+// Returns the local Euler rotation of a slot
+XMFLOAT3 TransformStore::getRotation(Handle handle) const
+{
+	int index = mIndices[handle];
+	return XMFLOAT3(mRotationX[index], mRotationY[index], mRotationZ[index]);
+}
+
+// Sets the local Euler rotation of a slot
+void TransformStore::setRotation(Handle handle, float x, float y, float z)
+{
+	int index = mIndices[handle];
+	mRotationX[index] = x;
+	mRotationY[index] = y;
+	mRotationZ[index] = z;
+	mTransformDirty[index] = 1;
+	mWorldTransformDirty[index] = 1;
+}
+
+// Returns the local scaling of a slot
+XMFLOAT3 TransformStore::getScale(Handle handle) const
+{
+	int index = mIndices[handle];
+	return XMFLOAT3(mScaleX[index], mScaleY[index], mScaleZ[index]);
+}
+
+// Sets the local scaling of a slot
+void TransformStore::setScale(Handle handle, float x, float y, float z)
+{
+	int index = mIndices[handle];
+	mScaleX[index] = x;
+	mScaleY[index] = y;
+	mScaleZ[index] = z;
+	mTransformDirty[index] = 1;
+	mWorldTransformDirty[index] = 1;
+}
+
+// Returns the local transform of a slot, rebuilding it if dirty
+const XMFLOAT4X4& TransformStore::getTransform(Handle handle)
+{
+	int index = mIndices[handle];
+	if (mTransformDirty[index])
+		computeTransform(index);
+
+	return mTransforms[index];
+}
+
+// Returns the world transform of a slot, resolving only the stale part of its parent chain
+const XMFLOAT4X4& TransformStore::getWorldTransform(Handle handle)
+{
+	int index = mIndices[handle];
+	resolve(index);
+
+	return mWorldTransforms[index];
+}
+
+// Resolves every stale world transform in one parent-before-child sweep and commits them as a simulation step
+void TransformStore::update()
+{
+	// The step committed last time becomes the start of the interpolation
+	mPreviousWorldTransforms.swap(mSteppedWorldTransforms);
+
+	commitStep();
+}
+
+// Folds slots moved since update() into the step it committed, e.g. entities moved by collision
+// response; the step before it is kept as the start of the interpolation
+void TransformStore::amendStep()
+{
+	commitStep();
+}
+
+// Resolves every stale world transform and writes it as the current step
+void TransformStore::commitStep()
+{
+	if (mOrderDirty)
+		rebuildOrder();
+
+	const int count = (int)mParent.size();
+
+	// Local transforms have no dependencies, so rebuild them four slots at a time
+	for (int first = 0; first < count; first += 4)
+	{
+		const int last = std::min(first + 4, count);
+		if (std::find(mTransformDirty.begin() + first, mTransformDirty.begin() + last, 1) != mTransformDirty.begin() + last)
+			computeTransformBlock(first);
+	}
+
+	// World transforms depend on the parent, which is always stored earlier
+	for (int i = 0; i < count; ++i)
+	{
+		if (isWorldTransformStale(i))
+			computeWorldTransform(i);
+
+		mSteppedWorldTransforms[i] = mWorldTransforms[i];
+
+		// A new slot has no earlier step to come from, so it starts where it is
+		if (!mStepped[i])
+		{
+			mPreviousWorldTransforms[i] = mWorldTransforms[i];
+			mStepped[i] = 1;
+		}
+	}
+
+	if (mSpatialTree != nullptr)
+		updateSpatialTree();
+}
+
+// Writes the world transforms of the render items, alpha of the way from the previous step
+// to the last one, and appends every item it wrote to changed
+void TransformStore::interpolate(float alpha, std::vector<RenderItem*>& changed)
+{
+	const int count = (int)mParent.size();
+	for (int i = 0; i < count; ++i)
+	{
+		RenderItem* renderItem = mRenderItems[i];
+		if (renderItem == nullptr || !mStepped[i])
+			continue;
+
+		const XMFLOAT4X4& previous = mPreviousWorldTransforms[i];
+		const XMFLOAT4X4& stepped = mSteppedWorldTransforms[i];
+		bool moving = memcmp(&previous, &stepped, sizeof(XMFLOAT4X4)) != 0;
+
+		if (moving && alpha < 1.f)
+		{
+			XMVECTOR previousScale, previousRotation, previousTranslation;
+			XMVECTOR steppedScale, steppedRotation, steppedTranslation;
+			if (XMMatrixDecompose(&previousScale, &previousRotation, &previousTranslation, XMLoadFloat4x4(&previous)) &&
+				XMMatrixDecompose(&steppedScale, &steppedRotation, &steppedTranslation, XMLoadFloat4x4(&stepped)))
+			{
+				XMMATRIX blended =
+					XMMatrixScalingFromVector(XMVectorLerp(previousScale, steppedScale, alpha)) *
+					XMMatrixRotationQuaternion(XMQuaternionSlerp(previousRotation, steppedRotation, alpha)) *
+					XMMatrixTranslationFromVector(XMVectorLerp(previousTranslation, steppedTranslation, alpha));
+				XMStoreFloat4x4(&renderItem->World, blended);
+			}
+			else
+			{
+				renderItem->World = stepped;
+			}
+			changed.push_back(renderItem);
+
+			// Not the exact step, so write it again once the slot comes to rest
+			mRenderVersion[i] = mWorldVersion[i] - 1;
+		}
+		else if (mRenderVersion[i] != mWorldVersion[i])
+		{
+			renderItem->World = stepped;
+			changed.push_back(renderItem);
+			mRenderVersion[i] = mWorldVersion[i];
+		}
+	}
+}
+
+// Returns the number of slots, including released ones not yet compacted
+size_t TransformStore::size() const
+{
+	return mParent.size();
+}
+
+// Compacts released slots and restores depth-first hierarchy order
+void TransformStore::rebuildOrder()
+{
+	const int count = (int)mParent.size();
+
+	// Bucket live slots by parent, keeping sibling order
+	std::vector<int> childOffsets(count + 1, 0);
+	std::vector<int> roots;
+	for (int i = 0; i < count; ++i)
+	{
+		if (!mAlive[i])
+			continue;
+
+		int parent = mParent[i];
+		if (parent >= 0 && mAlive[parent])
+			childOffsets[parent + 1]++;
+		else
+			roots.push_back(i);
+	}
+	for (int i = 0; i < count; ++i)
+		childOffsets[i + 1] += childOffsets[i];
+
+	std::vector<int> children(childOffsets[count]);
+	std::vector<int> cursor(childOffsets.begin(), childOffsets.end() - 1);
+	for (int i = 0; i < count; ++i)
+	{
+		int parent = mParent[i];
+		if (mAlive[i] && parent >= 0 && mAlive[parent])
+			children[cursor[parent]++] = i;
+	}
+
+	// Depth-first pre-order, so every subtree ends up contiguous after its root
+	std::vector<int> order;
+	order.reserve(count);
+	std::vector<int> stack(roots.rbegin(), roots.rend());
+	while (!stack.empty())
+	{
+		int index = stack.back();
+		stack.pop_back();
+		order.push_back(index);
+
+		for (int c = childOffsets[index + 1] - 1; c >= childOffsets[index]; --c)
+			stack.push_back(children[c]);
+	}
+
+	std::vector<int> remap(count, -1);
+	for (int i = 0; i < (int)order.size(); ++i)
+		remap[order[i]] = i;
+
+	std::vector<int> parents;
+	parents.reserve(order.size());
+	for (int index : order)
+	{
+		int parent = mParent[index];
+		parents.push_back(parent >= 0 ? remap[parent] : -1);
+	}
+	mParent.swap(parents);
+
+	permute(mPositionX, order);
+	permute(mPositionY, order);
+	permute(mPositionZ, order);
+	permute(mRotationX, order);
+	permute(mRotationY, order);
+	permute(mRotationZ, order);
+	permute(mScaleX, order);
+	permute(mScaleY, order);
+	permute(mScaleZ, order);
+	permute(mHandles, order);
+	permute(mAlive, order);
+	permute(mTransformDirty, order);
+	permute(mWorldTransformDirty, order);
+	permute(mWorldVersion, order);
+	permute(mParentVersion, order);
+	permute(mRenderVersion, order);
+	permute(mRenderItems, order);
+	permute(mNodes, order);
+	permute(mProxies, order);
+	permute(mProxyVersion, order);
+	permute(mTransforms, order);
+	permute(mWorldTransforms, order);
+	permute(mPreviousWorldTransforms, order);
+	permute(mSteppedWorldTransforms, order);
+	permute(mStepped, order);
+
+	for (int i = 0; i < (int)mHandles.size(); ++i)
+		mIndices[mHandles[i]] = i;
+
+	for (Handle handle : mReleasedHandles)
+	{
+		mIndices[handle] = -1;
+		mFreeHandles.push_back(handle);
+	}
+	mReleasedHandles.clear();
+
+	mOrderDirty = false;
+}
+
+// Brings a slot's world transform up to date, resolving its ancestors first
+void TransformStore::resolve(int index)
+{
+	int parent = mParent[index];
+	if (parent >= 0)
+		resolve(parent);
+
+	if (isWorldTransformStale(index))
+		computeWorldTransform(index);
+}
+
+// Rebuilds the local transform of a slot through the batch kernel of its block
+void TransformStore::computeTransform(int index)
+{
+	computeTransformBlock(index & ~3);
+}
+
+// Rebuilds the local transforms of four consecutive slots, one slot per SIMD lane.
+// Expands Scaling * RotationX * RotationY * RotationZ * Translation in closed form
+// so every matrix element is a single vector expression across the four slots.
+void TransformStore::computeTransformBlock(int first)
+{
+	const int lanes = std::min(4, (int)mParent.size() - first);
+
+	XMVECTOR sinX, cosX, sinY, cosY, sinZ, cosZ;
+	XMVectorSinCos(&sinX, &cosX, loadLanes(mRotationX, first, lanes, 0.f));
+	XMVectorSinCos(&sinY, &cosY, loadLanes(mRotationY, first, lanes, 0.f));
+	XMVectorSinCos(&sinZ, &cosZ, loadLanes(mRotationZ, first, lanes, 0.f));
+
+	XMVECTOR scaleX = loadLanes(mScaleX, first, lanes, 1.f);
+	XMVECTOR scaleY = loadLanes(mScaleY, first, lanes, 1.f);
+	XMVECTOR scaleZ = loadLanes(mScaleZ, first, lanes, 1.f);
+
+	XMVECTOR sinXsinY = XMVectorMultiply(sinX, sinY);
+	XMVECTOR cosXsinY = XMVectorMultiply(cosX, sinY);
+
+	// Element columns: each vector holds the same matrix element for all four slots
+	XMMATRIX row0(
+		XMVectorMultiply(scaleX, XMVectorMultiply(cosY, cosZ)),
+		XMVectorMultiply(scaleX, XMVectorMultiply(cosY, sinZ)),
+		XMVectorMultiply(scaleX, XMVectorNegate(sinY)),
+		XMVectorZero());
+	XMMATRIX row1(
+		XMVectorMultiply(scaleY, XMVectorSubtract(XMVectorMultiply(sinXsinY, cosZ), XMVectorMultiply(cosX, sinZ))),
+		XMVectorMultiply(scaleY, XMVectorAdd(XMVectorMultiply(sinXsinY, sinZ), XMVectorMultiply(cosX, cosZ))),
+		XMVectorMultiply(scaleY, XMVectorMultiply(sinX, cosY)),
+		XMVectorZero());
+	XMMATRIX row2(
+		XMVectorMultiply(scaleZ, XMVectorAdd(XMVectorMultiply(cosXsinY, cosZ), XMVectorMultiply(sinX, sinZ))),
+		XMVectorMultiply(scaleZ, XMVectorSubtract(XMVectorMultiply(cosXsinY, sinZ), XMVectorMultiply(sinX, cosZ))),
+		XMVectorMultiply(scaleZ, XMVectorMultiply(cosX, cosY)),
+		XMVectorZero());
+	XMMATRIX row3(
+		loadLanes(mPositionX, first, lanes, 0.f),
+		loadLanes(mPositionY, first, lanes, 0.f),
+		loadLanes(mPositionZ, first, lanes, 0.f),
+		XMVectorSplatOne());
+
+	// Transposing turns the element columns back into one row per slot
+	row0 = XMMatrixTranspose(row0);
+	row1 = XMMatrixTranspose(row1);
+	row2 = XMMatrixTranspose(row2);
+	row3 = XMMatrixTranspose(row3);
+
+	for (int lane = 0; lane < lanes; ++lane)
+	{
+		const int index = first + lane;
+		XMStoreFloat4x4(&mTransforms[index], XMMATRIX(row0.r[lane], row1.r[lane], row2.r[lane], row3.r[lane]));
+		mTransformDirty[index] = 0;
+
+#if defined(DEBUG) | defined(_DEBUG)
+		// The kernel must agree with the per-node DirectXMath chain it replaces
+		XMFLOAT4X4 reference;
+		XMStoreFloat4x4(&reference, XMMatrixScaling(mScaleX[index], mScaleY[index], mScaleZ[index]) *
+			XMMatrixRotationX(mRotationX[index]) *
+			XMMatrixRotationY(mRotationY[index]) *
+			XMMatrixRotationZ(mRotationZ[index]) *
+			XMMatrixTranslation(mPositionX[index], mPositionY[index], mPositionZ[index]));
+		for (int r = 0; r < 4; ++r)
+			for (int c = 0; c < 4; ++c)
+				assert(fabsf(reference.m[r][c] - mTransforms[index].m[r][c]) <= 1e-3f * (1.f + fabsf(reference.m[r][c])));
+#endif
+	}
+}
+
+// Rebuilds the world transform of a slot from its local transform and its parent's world transform
+void TransformStore::computeWorldTransform(int index)
+{
+	if (mTransformDirty[index])
+		computeTransform(index);
+
+	XMMATRIX T = XMLoadFloat4x4(&mTransforms[index]);
+
+	int parent = mParent[index];
+	if (parent >= 0)
+	{
+		T = T * XMLoadFloat4x4(&mWorldTransforms[parent]);
+		mParentVersion[index] = mWorldVersion[parent];
+	}
+
+	XMStoreFloat4x4(&mWorldTransforms[index], T);
+	mWorldTransformDirty[index] = 0;
+	mWorldVersion[index]++;
+}
+
+// Returns true if a slot or its parent changed since its world transform was built
+bool TransformStore::isWorldTransformStale(int index) const
+{
+	int parent = mParent[index];
+	return mWorldTransformDirty[index] || (parent >= 0 && mParentVersion[index] != mWorldVersion[parent]);
+}
+
+// Places the world bounds of every render item that moved in the spatial tree, then refits it in one pass
+void TransformStore::updateSpatialTree()
+{
+	bool changed = false;
+	const int count = (int)mParent.size();
+	for (int i = 0; i < count; ++i)
+	{
+		if (!mAlive[i] || mRenderItems[i] == nullptr)
+			continue;
+
+		if (mProxies[i] == DynamicAabbTree::NullNode)
+		{
+			const Aabb aabb = Aabb::fromBoundingBox(mRenderItems[i]->Bounds, mWorldTransforms[i]);
+			mProxies[i] = mSpatialTree->createProxy(aabb, mNodes[i]);
+			mProxyVersion[i] = mWorldVersion[i];
+		}
+		else if (mProxyVersion[i] != mWorldVersion[i])
+		{
+			const Aabb aabb = Aabb::fromBoundingBox(mRenderItems[i]->Bounds, mWorldTransforms[i]);
+			changed |= mSpatialTree->updateProxy(mProxies[i], aabb);
+			mProxyVersion[i] = mWorldVersion[i];
+		}
+	}
+
+	if (!changed)
+		return;
+
+	mSpatialTree->refit();
+	if (mSpatialTree->isDegraded())
+		mSpatialTree->rebuild();
+}
+
+// Removes a slot's proxy from the spatial tree, if it has one
+void TransformStore::destroyProxy(int index)
+{
+	if (mProxies[index] == DynamicAabbTree::NullNode)
+		return;
+
+	mSpatialTree->destroyProxy(mProxies[index]);
+	mProxies[index] = DynamicAabbTree::NullNode;
+}
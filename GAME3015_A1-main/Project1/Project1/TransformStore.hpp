@@ -0,0 +1,106 @@
+#pragma once
+#include "../../Common/MathHelper.h"
+#include "DynamicAabbTree.hpp"
+
+#include <vector>
+
+struct RenderItem;
+class SceneNode;
+
+// Structure-of-arrays storage for the transforms of every scene node in a state.
+// Slots are kept in hierarchy order (parent before child), so world transforms
+// are resolved with one linear sweep instead of a walk over the node tree.
+// update() commits one simulation step; interpolate() blends the last two
+// committed steps into the render items. amendStep() folds moves made after
+// update() into the step it committed, without starting a new one. With a
+// spatial tree attached, update() also keeps a proxy per render item at the
+// item's world bounds.
+class TransformStore
+{
+public:
+	typedef int Handle;
+	static const Handle InvalidHandle = -1;
+
+
+public:
+	TransformStore();
+
+	Handle							create();
+	void							destroy(Handle handle);
+	void							setParent(Handle handle, Handle parent);
+	void							setRenderItem(Handle handle, RenderItem* renderItem, SceneNode* node);
+	void							setSpatialTree(DynamicAabbTree* tree);
+
+	DirectX::XMFLOAT3				getPosition(Handle handle) const;
+	void							setPosition(Handle handle, float x, float y, float z);
+	void							move(Handle handle, float x, float y, float z);
+	DirectX::XMFLOAT3				getRotation(Handle handle) const;
+	void							setRotation(Handle handle, float x, float y, float z);
+	DirectX::XMFLOAT3				getScale(Handle handle) const;
+	void							setScale(Handle handle, float x, float y, float z);
+
+	const DirectX::XMFLOAT4X4&		getTransform(Handle handle);
+	const DirectX::XMFLOAT4X4&		getWorldTransform(Handle handle);
+
+	void							update();
+	void							amendStep();
+	void							interpolate(float alpha, std::vector<RenderItem*>& changed);
+	size_t							size() const;
+
+private:
+	void							commitStep();
+	void							rebuildOrder();
+	void							resolve(int index);
+	void							computeTransform(int index);
+	void							computeTransformBlock(int first);
+	void							computeWorldTransform(int index);
+	bool							isWorldTransformStale(int index) const;
+	void							updateSpatialTree();
+	void							destroyProxy(int index);
+
+
+private:
+	// Per-slot columns, indexed by position in hierarchy order
+	std::vector<float>				mPositionX;
+	std::vector<float>				mPositionY;
+	std::vector<float>				mPositionZ;
+	std::vector<float>				mRotationX;
+	std::vector<float>				mRotationY;
+	std::vector<float>				mRotationZ;
+	std::vector<float>				mScaleX;
+	std::vector<float>				mScaleY;
+	std::vector<float>				mScaleZ;
+
+	std::vector<int>				mParent;
+	std::vector<Handle>				mHandles;
+	std::vector<unsigned char>		mAlive;
+	std::vector<unsigned char>		mTransformDirty;
+	std::vector<unsigned char>		mWorldTransformDirty;
+
+	// A world transform is stale when its parent's version moved on since it was built
+	std::vector<unsigned int>		mWorldVersion;
+	std::vector<unsigned int>		mParentVersion;
+	std::vector<unsigned int>		mRenderVersion;
+	std::vector<RenderItem*>		mRenderItems;
+
+	// Node owning the render item, and its proxy in the spatial tree with the world version it was placed at
+	std::vector<SceneNode*>			mNodes;
+	std::vector<int>				mProxies;
+	std::vector<unsigned int>		mProxyVersion;
+
+	std::vector<DirectX::XMFLOAT4X4>	mTransforms;
+	std::vector<DirectX::XMFLOAT4X4>	mWorldTransforms;
+
+	// World transforms as committed by the last two calls to update()
+	std::vector<DirectX::XMFLOAT4X4>	mPreviousWorldTransforms;
+	std::vector<DirectX::XMFLOAT4X4>	mSteppedWorldTransforms;
+	std::vector<unsigned char>		mStepped;
+
+	// Handle -> slot indirection, so slots can be reordered without touching the nodes
+	std::vector<int>				mIndices;
+	std::vector<Handle>				mFreeHandles;
+	std::vector<Handle>				mReleasedHandles;
+	bool							mOrderDirty;
+
+	DynamicAabbTree*				mSpatialTree;
+};
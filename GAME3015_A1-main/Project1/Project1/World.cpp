@@ -5,26 +5,32 @@
 
 #define NOMINMAX
 #include "World.hpp"
+#include "Game.hpp"
 
 // Constructor for World class
 World::World(State* state)
 	: mSceneGraph(new SceneNode(state))
 	, mState(state)
 	, mPlayerAircraft(nullptr)
-	, mBackground(nullptr)
+	, mBackground()
 	, mWorldBounds(-4.25f, 4.25f, -3.0f, 3.0f) //Left, Right, Down, Up
 	, mSpawnPosition(0.f, 0.f)
 	, mScrollSpeed(1.0f)
+	, mProjectiles(state, projectileCapacity)
 {
 }
 
 // Processes commands in the command queue, updates the scene graph, and handles entity movements and rotations
 void World::update(const GameTimer& gt)
 {
-	// Reset player velocity to 0 before processing new commands
+	// Reset player velocity to 0 and stop firing before processing new commands
 	mPlayerAircraft->setVelocity(0, 0, 0);
+	mPlayerAircraft->setFiring(false);
 
 
+	// Pull in the commands pushed from other threads since the last frame in one batch
+	mConcurrentCommandQueue.drain(mCommandQueue);
+
 	// Process all commands in the command queue
 	while (!mCommandQueue.isEmpty())
 		mSceneGraph->onCommand(mCommandQueue.pop(), gt);
@@ -55,43 +61,177 @@ void World::update(const GameTimer& gt)
 			mEnemy[i]->setWorldRotation(0, 0, 0);
 	}
 
-	// Handle player and enemy movements and bounds checking
-	if (mPlayerAircraft->getWorldPosition().x < -maxWidth)
-		mPlayerAircraft->setPosition(-maxWidth, mPlayerAircraft->getWorldPosition().y, mPlayerAircraft->getWorldPosition().z);
+	// Move the aircraft, holding the player inside the bounds and turning back the enemies that left them
+	stepAircraft(gt);
+
+	// Move the projectiles and the component store objects in bulk, then add the projectiles fired this step
+	mProjectiles.update(gt);
+	mComponents.integrate(gt.DeltaTime());
+	launchProjectiles();
 
-	else if (mPlayerAircraft->getWorldPosition().x > maxWidth)
-		mPlayerAircraft->setPosition(maxWidth, mPlayerAircraft->getWorldPosition().y, mPlayerAircraft->getWorldPosition().z);
+	// Resolve the world transforms touched this frame and refresh the render items
+	mState->getTransforms().update();
 
-	if (mPlayerAircraft->getWorldPosition().y < minHeight)
-		mPlayerAircraft->setPosition(mPlayerAircraft->getWorldPosition().x, minHeight, mPlayerAircraft->getWorldPosition().z);
+	// Find the aircraft that overlap; they react when the contact commands are processed next step
+	detectCollisions();
+}
 
-	else if (mPlayerAircraft->getWorldPosition().y > maxHeight)
-		mPlayerAircraft->setPosition(mPlayerAircraft->getWorldPosition().x, maxHeight, mPlayerAircraft->getWorldPosition().z);
+// Steps every aircraft in one pass over the kernel, which holds their positions and velocities,
+// and writes the new positions to the transforms
+void World::stepAircraft(const GameTimer& gt)
+{
+	mAircraftKernel.step(gt.DeltaTime());
+
+	for (size_t lane = 0; lane < mAircraft.size(); ++lane)
+	{
+		const XMFLOAT3 position = mAircraftKernel.getPosition(lane);
+		mAircraft[lane]->setPosition(position.x, position.y, position.z);
+	}
+}
+
+// Enters an entity's collision box into the grid, thickened along its local y axis to the flight band.
+// Entities flagged as fast, or that moved further than their box is thin, are swept over the step.
+void World::addCollider(Entity* entity)
+{
+	BoundingOrientedBox box;
+	if (!entity->getCollisionBox(box))
+		return;
+
+	box.Extents.y = std::max(box.Extents.y, (maxHeight - minHeight) * 0.5f);
+
+	const XMFLOAT3 displacement = entity->getDisplacement();
+	const float distance = std::sqrt(displacement.x * displacement.x + displacement.y * displacement.y + displacement.z * displacement.z);
+	if (entity->isFast() || distance > std::min(std::min(box.Extents.x, box.Extents.y), box.Extents.z))
+		mCollisionGrid.add(entity, box, displacement);
+	else
+		mCollisionGrid.add(entity, box);
+}
 
+// Queues one command per entity of every contact, addressed to that entity and carrying the other one.
+// Entities that hit something during the step are moved back to where they first touched.
+void World::detectCollisions()
+{
+	mCollisionGrid.clear();
+	addCollider(mPlayerAircraft);
 	for (int i = 0; i < totalEnemies; i++)
+		addCollider(mEnemy[i]);
+
+	mCollisionGrid.findContacts(mContacts);
+
+	// The step is already committed; amend it so the previous step stays the start of the interpolation
+	if (CollisionGrid::resolveContacts(mContacts, mRewound))
+		mState->getTransforms().amendStep();
+
+	// Only entities are added to the grid, and they live as long as the scene graph, so the pointers
+	// are still valid when the commands run
+	for (const CollisionContact& contact : mContacts)
 	{
-		if (mEnemy[i]->getWorldPosition().x < -maxWidth || mEnemy[i]->getWorldPosition().x > maxWidth)
+		Entity* first = static_cast<Entity*>(contact.first);
+		Entity* second = static_cast<Entity*>(contact.second);
+
+		Command hitFirst;
+		hitFirst.category = first->getCategory();
+		hitFirst.action = [first, second](SceneNode& node, const GameTimer& gt)
 		{
-			mEnemy[i]->setVelocity(-mEnemy[i]->getVelocity().x, mEnemy[i]->getVelocity().y, mEnemy[i]->getVelocity().z);
-		}
+			if (&node == first)
+				first->onCollision(*second, gt);
+		};
+		mCommandQueue.push(std::move(hitFirst));
 
-		if (mEnemy[i]->getWorldPosition().y < minHeight || mEnemy[i]->getWorldPosition().y > maxHeight)
+		Command hitSecond;
+		hitSecond.category = second->getCategory();
+		hitSecond.action = [first, second](SceneNode& node, const GameTimer& gt)
 		{
-			mEnemy[i]->setVelocity(mEnemy[i]->getVelocity().x, -mEnemy[i]->getVelocity().y, mEnemy[i]->getVelocity().z);
-		}
+			if (&node == second)
+				second->onCollision(*first, gt);
+		};
+		mCommandQueue.push(std::move(hitSecond));
 	}
 }
 
+// Fires a projectile from the player towards the enemies while the fire key is held
+void World::launchProjectiles()
+{
+	if (!mPlayerAircraft->isFiring())
+		return;
+
+	const XMFLOAT3 position = mPlayerAircraft->getWorldPosition();
+	mProjectiles.launch(position, XMFLOAT3(0.0f, 0.0f, 30.0f), 2.0f);
+}
+
+// Returns the projectiles of the world
+ProjectileSystem& World::getProjectiles()
+{
+	return mProjectiles;
+}
+
+// Returns the store for gameplay objects kept outside the scene graph; their render items belong to the state
+ComponentStore& World::getComponents()
+{
+	return mComponents;
+}
+
+// Returns the colliders, candidate pairs, and contacts of the last update
+const CollisionGrid::Stats& World::getCollisionStats() const
+{
+	return mCollisionGrid.getStats();
+}
+
 // Returns the command queue for the world
 CommandQueue& World::getCommandQueue()
 {
 	return mCommandQueue;
 }
 
-// Draws the world by drawing the scene graph
+// Returns the command queue that input, AI, or network threads can push to concurrently
+ConcurrentCommandQueue& World::getConcurrentCommandQueue()
+{
+	return mConcurrentCommandQueue;
+}
+
+// Draws the world by drawing the scene graph, the projectiles, and the component store objects
 void World::draw()
 {
 	mSceneGraph->draw();
+	mProjectiles.draw();
+	mComponents.draw(mState->getContext()->game->getRenderBatcher());
+}
+
+// Places the projectiles and the component store objects between their last two simulation steps
+void World::interpolate(float alpha, std::vector<RenderItem*>& changed)
+{
+	mProjectiles.interpolate(alpha, changed);
+	mComponents.interpolate(alpha, changed);
+}
+
+// Creates the background object in the component store, with a render item owned by the state
+void World::buildBackground()
+{
+	Game* game = mState->getContext()->game;
+	const SubmeshGeometry& box = game->getGeometries().at("boxGeo")->DrawArgs.at("box");
+
+	std::unique_ptr<RenderItem> render(new RenderItem());
+	XMStoreFloat4x4(&render->TexTransform, XMMatrixScaling(1.0f, 1.0f, 1.0f));
+	render->Mat = game->getMaterials().at("Desert").get();
+	render->Geo = game->getGeometries().at("boxGeo").get();
+	render->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	render->IndexCount = box.IndexCount;
+	render->StartIndexLocation = box.StartIndexLocation;
+	render->BaseVertexLocation = box.BaseVertexLocation;
+	render->Bounds = box.Bounds;
+	mState->allocateObject(render.get());
+
+	mBackground = mComponents.create(Component::Transform | Component::Velocity | Component::Render | Component::Category);
+	TransformComponent& transform = *mComponents.getTransform(mBackground);
+	transform.position = XMFLOAT3(0.0f, -30.0f, 0.0f);
+	transform.previousPosition = transform.position;
+	transform.rotation = XMFLOAT3(20.0f, 0.0f, 0.0f);
+	transform.scale = XMFLOAT3(200.0f, 1.0f, 200.0f);
+	*mComponents.getVelocity(mBackground) = XMFLOAT3(0.0f, 0.0f, -mScrollSpeed);
+	*mComponents.getRenderItem(mBackground) = render.get();
+	*mComponents.getCategory(mBackground) = Category::Scene;
+
+	mState->getRenderItems().push_back(std::move(render));
 }
 
 // Builds the scene by creating game objects and adding them to the scene graph
@@ -116,16 +256,27 @@ void World::buildScene()
 		mSceneGraph->attachChild(std::move(enemy1));
 	}
 
-	// Creates a background sprite object, sets its properties, and adds it to the scene graph
-	std::unique_ptr<SpriteNode> backgroundSprite(new SpriteNode(mState));
-	backgroundSprite->SetMatGeoDrawName("Desert", "boxGeo", "box");
-	mBackground = backgroundSprite.get();
-	mBackground->setPosition(0, -30.0, 0.0);
-	mBackground->setScale(200.0, 1.0, 200.0);
-	mBackground->setVelocity(0, 0, -mScrollSpeed);
-	mBackground->setWorldRotation(20.0, 0.0, 0.0);
-	mSceneGraph->attachChild(std::move(backgroundSprite));
+	// The aircraft are integrated by the world's kernel rather than by their own updates
+	mAircraftKernel.clear();
+	mAircraftKernel.setBounds(-maxWidth, maxWidth, minHeight, maxHeight);
+	mAircraft.clear();
+
+	mAircraftKernel.add(AircraftKernel::Response::Clamp);
+	mAircraft.push_back(mPlayerAircraft);
+	for (int i = 0; i < totalEnemies; i++)
+	{
+		mAircraftKernel.add(AircraftKernel::Response::Reflect);
+		mAircraft.push_back(mEnemy[i]);
+	}
+	for (size_t lane = 0; lane < mAircraft.size(); ++lane)
+		mAircraft[lane]->bindKernel(&mAircraftKernel, lane);
+
+	// Creates the scrolling background; it has no children and only moves at its velocity, so it lives in the component store
+	buildBackground();
 
 	// Builds the scene graph hierarchy
 	mSceneGraph->build();
+
+	// Projectiles are small copies of the player's sprite; there is no separate bullet texture
+	mProjectiles.build("Eagle", "boxGeo", "box", XMFLOAT3(0.5f, 0.5f, 0.5f));
 }
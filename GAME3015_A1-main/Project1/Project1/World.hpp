@@ -1,9 +1,13 @@
 #pragma once
 #include "SceneNode.hpp"
 #include "Aircraft.hpp"
-#include "SpriteNode.h"
 #include "CommandQueue.hpp"
+#include "ConcurrentCommandQueue.hpp"
 #include "Command.hpp"
+#include "CollisionGrid.hpp"
+#include "ProjectileSystem.hpp"
+#include "ComponentStore.hpp"
+#include "AircraftKernel.hpp"
 
 
 class World
@@ -12,16 +16,27 @@ public:
 	explicit							World(State* state);
 	void								update(const GameTimer& gt);
 	void								draw();
+	void								interpolate(float alpha, std::vector<RenderItem*>& changed);
 	//void								loadTextures();
 	void								buildScene();
 
 	CommandQueue& getCommandQueue();
+	ConcurrentCommandQueue& getConcurrentCommandQueue();
+	const CollisionGrid::Stats&			getCollisionStats() const;
+	ProjectileSystem&					getProjectiles();
+	ComponentStore&						getComponents();
 
 private:
 	CommandQueue						mCommandQueue;
+	ConcurrentCommandQueue				mConcurrentCommandQueue;
 
 	void								adaptPlayerPosition();
 	void								adaptPlayerVelocity();
+	void								buildBackground();
+	void								addCollider(Entity* entity);
+	void								detectCollisions();
+	void								launchProjectiles();
+	void								stepAircraft(const GameTimer& gt);
 
 
 private:
@@ -47,10 +62,27 @@ private:
 	const static int maxWidth = 15;
 	const static int minWidth = 5;
 
+	// Two seconds of one shot per 60 Hz tick, the most the player keeps alive; the pool grows past it
+	const static int projectileCapacity = 128;
+
 	XMFLOAT4							mWorldBounds;
 	XMFLOAT2		    				mSpawnPosition;
 	float								mScrollSpeed;
 	Aircraft* mPlayerAircraft;
-	SpriteNode* mBackground;
+	ComponentStore::Handle				mBackground;
 	Aircraft* mEnemy[totalEnemies];
+
+	// Aircraft sprites are flat; their collision boxes are thickened to cover the flight band
+	CollisionGrid						mCollisionGrid;
+	std::vector<CollisionContact>		mContacts;
+	std::vector<Collidable*>			mRewound;
+
+	ProjectileSystem					mProjectiles;
+
+	// Gameplay objects without hierarchy, updated by systems over packed columns instead of the scene graph
+	ComponentStore						mComponents;
+
+	// The aircraft are moved and kept in bounds together; mAircraft holds them in kernel lane order
+	AircraftKernel						mAircraftKernel;
+	std::vector<Aircraft*>				mAircraft;
 };
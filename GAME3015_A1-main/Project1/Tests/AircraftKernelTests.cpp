@@ -0,0 +1,123 @@
+//***************************************************************************************
+// AircraftKernelTests.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+#include "../Project1/AircraftKernel.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+// Positions and velocities every lane of the special case test goes through, for each response
+static std::vector<float> getSpecialValues()
+{
+	const float inf = std::numeric_limits<float>::infinity();
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	return { 0.0f, -0.0f, 1.0f, -1.0f, 5.0f, -5.0f, 5.5f, -5.5f, 100.0f, -100.0f, inf, -inf, nan,
+		std::numeric_limits<float>::min(), std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max() };
+}
+
+// Returns a kernel with the bounds the world uses and one lane per position and velocity pair, for both responses;
+// the lane count is not a multiple of four, so the padded tail is stepped too
+static AircraftKernel makeSpecialKernel()
+{
+	const std::vector<float> values = getSpecialValues();
+
+	AircraftKernel kernel;
+	kernel.setBounds(-5.0f, 5.0f, -5.0f, 5.0f);
+	for (AircraftKernel::Response response : { AircraftKernel::Response::Clamp, AircraftKernel::Response::Reflect })
+	{
+		for (float position : values)
+		{
+			for (float velocity : values)
+			{
+				const size_t lane = kernel.add(response);
+				kernel.setState(lane, XMFLOAT3(position, -position, position), XMFLOAT3(velocity, -velocity, velocity));
+			}
+		}
+	}
+	kernel.add(AircraftKernel::Response::Clamp);
+	return kernel;
+}
+
+// Returns true if a float is -0
+static bool isNegativeZero(float value)
+{
+	const float negativeZero = -0.0f;
+	return memcmp(&value, &negativeZero, sizeof(float)) == 0;
+}
+
+// The vector path matches the scalar one to the bit on in-bounds, out-of-bounds, signed zero, infinite,
+// and NaN lanes, over several steps so the responses feed back into the next one
+TEST(AircraftKernelSpecialValues)
+{
+	AircraftKernel vector = makeSpecialKernel();
+	AircraftKernel scalar = makeSpecialKernel();
+	CHECK(vector.size() % 4 != 0);
+
+	for (float dt : { 1.0f / 60.0f, 0.5f, 0.0f, 1.0f / 60.0f })
+	{
+		vector.step(dt);
+		scalar.stepScalar(dt);
+		CHECK(vector.matches(scalar));
+	}
+}
+
+// Clamped lanes stop at the bounds; reflected lanes turn back, flipping the sign of a zero velocity too
+TEST(AircraftKernelResponses)
+{
+	AircraftKernel kernel;
+	kernel.setBounds(-5.0f, 5.0f, -5.0f, 5.0f);
+	const size_t clamped = kernel.add(AircraftKernel::Response::Clamp);
+	const size_t reflected = kernel.add(AircraftKernel::Response::Reflect);
+	const size_t resting = kernel.add(AircraftKernel::Response::Reflect);
+	kernel.setState(clamped, XMFLOAT3(4.0f, -4.0f, 0.0f), XMFLOAT3(120.0f, -120.0f, 3.0f));
+	kernel.setState(reflected, XMFLOAT3(4.0f, 0.0f, 0.0f), XMFLOAT3(120.0f, 1.0f, 0.0f));
+	kernel.setState(resting, XMFLOAT3(6.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f));
+
+	kernel.step(1.0f / 60.0f);
+
+	CHECK(kernel.getPosition(clamped).x == 5.0f);
+	CHECK(kernel.getPosition(clamped).y == -5.0f);
+	CHECK(kernel.getVelocity(clamped).x == 120.0f);
+	CHECK(kernel.getStep(clamped).z == 3.0f * (1.0f / 60.0f));
+
+	CHECK(kernel.getPosition(reflected).x == 4.0f + 2.0f);
+	CHECK(kernel.getVelocity(reflected).x == -120.0f);
+	CHECK(kernel.getVelocity(reflected).y == 1.0f);
+
+	CHECK(isNegativeZero(kernel.getVelocity(resting).x));
+	CHECK(!isNegativeZero(kernel.getVelocity(resting).y));
+}
+
+// Random lanes of both responses, many of them outside the bounds, match over a thousand steps
+TEST(AircraftKernelRandomLanes)
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> velocity(-50.0f, 50.0f);
+
+	AircraftKernel vector;
+	vector.setBounds(-15.0f, 15.0f, 5.0f, 15.0f);
+	for (int i = 0; i < 1001; ++i)
+	{
+		const size_t lane = vector.add(i % 3 == 0 ? AircraftKernel::Response::Clamp : AircraftKernel::Response::Reflect);
+		vector.setState(lane, XMFLOAT3(position(random), position(random), position(random)),
+			XMFLOAT3(velocity(random), velocity(random), velocity(random)));
+	}
+	AircraftKernel scalar = vector;
+
+	bool matched = true;
+	for (int step = 0; step < 1000; ++step)
+	{
+		vector.step(1.0f / 60.0f);
+		scalar.stepScalar(1.0f / 60.0f);
+		matched = matched && vector.matches(scalar);
+	}
+	CHECK(matched);
+}
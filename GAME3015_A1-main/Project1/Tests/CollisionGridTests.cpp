@@ -0,0 +1,214 @@
+//***************************************************************************************
+// CollisionGridTests.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+#include "../Project1/CollisionGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+
+// Stand-in for an entity: a box moved by its velocity each step, which the collision response can
+// move back or push aside
+struct Body : public Collidable
+{
+	XMFLOAT3 position;
+	XMFLOAT3 velocity;
+	XMFLOAT3 displacement;
+	XMFLOAT4 orientation;
+
+	Body()
+		: position(0.0f, 0.0f, 0.0f)
+		, velocity(0.0f, 0.0f, 0.0f)
+		, displacement(0.0f, 0.0f, 0.0f)
+		, orientation(0.0f, 0.0f, 0.0f, 1.0f)
+	{
+	}
+
+	virtual XMFLOAT3 getDisplacement() const override
+	{
+		return displacement;
+	}
+
+	virtual void rewind(float time) override
+	{
+		const float back = 1.0f - time;
+		displace(-displacement.x * back, -displacement.y * back, -displacement.z * back);
+		displacement = XMFLOAT3(displacement.x * time, displacement.y * time, displacement.z * time);
+	}
+
+	virtual void displace(float x, float y, float z) override
+	{
+		position.x += x;
+		position.y += y;
+		position.z += z;
+	}
+};
+
+// Extent of every body's box on each axis
+static const float BodyExtent = 0.5f;
+
+// A low tick rate, so fast bodies cover many box lengths per step
+static const float StepTime = 0.1f;
+
+// Advances every body one step, sweeps them through the grid and responds to the contacts with
+// World's response, then every body touching another turns away from it like an aircraft
+static void step(CollisionGrid& grid, std::vector<Body>& bodies, std::vector<CollisionContact>& contacts)
+{
+	grid.clear();
+	for (Body& body : bodies)
+	{
+		body.displacement = XMFLOAT3(body.velocity.x * StepTime, body.velocity.y * StepTime, body.velocity.z * StepTime);
+		body.displace(body.displacement.x, body.displacement.y, body.displacement.z);
+
+		BoundingOrientedBox box(body.position, XMFLOAT3(BodyExtent, BodyExtent, BodyExtent), body.orientation);
+		grid.add(&body, box, body.displacement);
+	}
+
+	grid.findContacts(contacts);
+	std::vector<Collidable*> rewound;
+	CollisionGrid::resolveContacts(contacts, rewound);
+
+	for (const CollisionContact& contact : contacts)
+	{
+		for (int i = 0; i < 2; ++i)
+		{
+			Body& body = *static_cast<Body*>(i == 0 ? contact.first : contact.second);
+			const Body& other = *static_cast<Body*>(i == 0 ? contact.second : contact.first);
+			if (body.velocity.x * (other.position.x - body.position.x) > 0)
+				body.velocity.x = -body.velocity.x;
+		}
+	}
+}
+
+// A body crossing fifty box lengths per step stops at a wall halfway along its path instead of passing it
+TEST(CollisionGridFastBodyDoesNotTunnel)
+{
+	CollisionGrid grid(1.0f);
+	std::vector<CollisionContact> contacts;
+
+	std::vector<Body> bodies(2);
+	bodies[0].position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	bodies[0].velocity = XMFLOAT3(500.0f, 0.0f, 0.0f);
+	bodies[1].position = XMFLOAT3(25.0f, 0.0f, 0.0f);
+	bodies[1].velocity = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+	step(grid, bodies, contacts);
+	CHECK(contacts.size() == 1);
+	if (contacts.size() == 1)
+		CHECK(contacts[0].time > 0.0f && contacts[0].time < 1.0f);
+	CHECK(bodies[0].position.x <= 25.0f - 2.0f * BodyExtent + 0.01f);
+	CHECK(bodies[0].position.x >= 25.0f - 2.0f * BodyExtent - 2.0f * BodyExtent);
+	CHECK(bodies[0].velocity.x < 0.0f);
+}
+
+// A fast body passing just above the corner of a wall turned 45 degrees hits the wall's sloped
+// face, a little after their bounding boxes meet, so the sweep has to step the oriented boxes
+TEST(CollisionGridFastBodyStopsAtRotatedWall)
+{
+	CollisionGrid grid(1.0f);
+	std::vector<CollisionContact> contacts;
+
+	std::vector<Body> bodies(2);
+	bodies[0].position = XMFLOAT3(0.0f, 0.6f, 0.0f);
+	bodies[0].velocity = XMFLOAT3(500.0f, 0.0f, 0.0f);
+	bodies[1].position = XMFLOAT3(25.0f, 0.0f, 0.0f);
+	XMStoreFloat4(&bodies[1].orientation, XMQuaternionRotationRollPitchYaw(0.0f, 0.0f, 0.25f * XM_PI));
+
+	step(grid, bodies, contacts);
+	CHECK(contacts.size() == 1);
+	if (contacts.size() == 1)
+		CHECK(contacts[0].time > 0.0f && contacts[0].time < 1.0f);
+
+	// The body's lower face is 0.1 above the corner, where the face is 0.1 behind it
+	const float bounds = 25.0f - std::sqrt(2.0f) * BodyExtent - BodyExtent;
+	const float face = bounds + 0.1f;
+	CHECK(bodies[0].position.x <= face + 0.01f);
+	CHECK(bodies[0].position.x >= face - 0.02f);
+	CHECK(bodies[0].velocity.x < 0.0f);
+	CHECK(bodies[1].position.x == 25.0f);
+}
+
+// After bouncing off a wall, a fast body starts the next step touching it; that contact is at 0
+// and must not hold the body in place, so it keeps moving away on every later step
+TEST(CollisionGridBounceDoesNotStick)
+{
+	CollisionGrid grid(1.0f);
+	std::vector<CollisionContact> contacts;
+
+	std::vector<Body> bodies(2);
+	bodies[0].position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	bodies[0].velocity = XMFLOAT3(500.0f, 0.0f, 0.0f);
+	bodies[1].position = XMFLOAT3(25.0f, 0.0f, 0.0f);
+	bodies[1].velocity = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+	step(grid, bodies, contacts);
+	const float bounced = bodies[0].position.x;
+
+	step(grid, bodies, contacts);
+	for (const CollisionContact& contact : contacts)
+		CHECK(contact.time == 0.0f);
+	CHECK(std::fabs(bodies[0].position.x - (bounced - 50.0f)) < 0.01f);
+
+	step(grid, bodies, contacts);
+	CHECK(contacts.empty());
+	CHECK(std::fabs(bodies[0].position.x - (bounced - 100.0f)) < 0.01f);
+	CHECK(bodies[1].position.x == 25.0f);
+}
+
+// Two fast bodies overlapping when the step begins are pushed apart instead of moved back,
+// so they keep travelling side by side
+TEST(CollisionGridOverlapAtStartSeparates)
+{
+	CollisionGrid grid(1.0f);
+	std::vector<CollisionContact> contacts;
+
+	std::vector<Body> bodies(2);
+	bodies[0].position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	bodies[0].velocity = XMFLOAT3(0.0f, 500.0f, 0.0f);
+	bodies[1].position = XMFLOAT3(0.6f, 0.0f, 0.0f);
+	bodies[1].velocity = XMFLOAT3(0.0f, 500.0f, 0.0f);
+
+	step(grid, bodies, contacts);
+	CHECK(contacts.size() == 1);
+	if (contacts.size() == 1)
+	{
+		CHECK(contacts[0].time == 0.0f);
+		CHECK(std::fabs(contacts[0].separation.x - 0.4f) < 0.001f);
+		CHECK(contacts[0].separation.y == 0.0f && contacts[0].separation.z == 0.0f);
+	}
+	CHECK(bodies[1].position.x - bodies[0].position.x >= 2.0f * BodyExtent - 0.001f);
+
+	for (int i = 0; i < 4; ++i)
+		step(grid, bodies, contacts);
+	CHECK(std::fabs(bodies[0].position.y - 250.0f) < 0.01f);
+	CHECK(std::fabs(bodies[1].position.y - 250.0f) < 0.01f);
+	CHECK(bodies[1].position.x - bodies[0].position.x >= 2.0f * BodyExtent - 0.001f);
+}
+
+// A thin stick sweeping across a thin diagonal one only overlaps it for a sliver of the step,
+// far less than the interval in which their bounding boxes overlap; the sweep still finds it
+TEST(CollisionGridThinRotatedBoxesDoNotTunnel)
+{
+	CollisionGrid grid(1.0f);
+	std::vector<CollisionContact> contacts;
+	std::vector<Body> bodies(2);
+
+	XMFLOAT4 diagonal;
+	XMStoreFloat4(&diagonal, XMQuaternionRotationRollPitchYaw(0.0f, 0.0f, 0.25f * XM_PI));
+	grid.add(&bodies[0],
+		BoundingOrientedBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(5.0f, 0.01f, 0.01f), diagonal));
+
+	// Crosses the diagonal at x = 0.5, a 0.07 wide window in a 12 unit step
+	grid.add(&bodies[1],
+		BoundingOrientedBox(XMFLOAT3(6.0f, 0.5f, 0.0f), XMFLOAT3(0.01f, 0.01f, 5.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f)),
+		XMFLOAT3(12.0f, 0.0f, 0.0f));
+
+	grid.findContacts(contacts);
+	CHECK(contacts.size() == 1);
+	if (contacts.size() == 1)
+		CHECK(std::fabs(contacts[0].time - 6.5f / 12.0f) < 0.004f);
+}
@@ -0,0 +1,132 @@
+//***************************************************************************************
+// ConcurrentCommandQueueTests.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+#include "../Project1/ConcurrentCommandQueue.hpp"
+#include "../Project1/CommandQueue.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Bits of a stress test command's category holding its sequence number; the rest hold its producer
+static const unsigned int SequenceBits = 24;
+
+// Returns a command tagged with a value in its category and carrying a non-empty action
+static Command makeCommand(unsigned int tag)
+{
+	Command command;
+	command.category = tag;
+	command.action = [tag](SceneNode&, const GameTimer&) { (void)tag; };
+	return command;
+}
+
+// The capacity rounds up to a power of two, a full queue refuses pushes, and popping frees a cell
+TEST(ConcurrentCommandQueueFull)
+{
+	ConcurrentCommandQueue queue(5);
+	CHECK(queue.getCapacity() == 8);
+
+	for (unsigned int i = 0; i < 8; ++i)
+		CHECK(queue.tryPush(makeCommand(i)));
+	CHECK(!queue.tryPush(makeCommand(8)));
+
+	Command command;
+	CHECK(queue.tryPop(command));
+	CHECK(command.category == 0);
+	CHECK(static_cast<bool>(command.action));
+	CHECK(queue.tryPush(makeCommand(8)));
+}
+
+// Draining moves every published command into the frame queue in push order
+TEST(ConcurrentCommandQueueDrain)
+{
+	ConcurrentCommandQueue queue(16);
+	CommandQueue commands;
+
+	for (unsigned int i = 0; i < 20; ++i)
+	{
+		queue.tryPush(makeCommand(i));
+		if (i == 9)
+			CHECK(queue.drain(commands) == 10);
+	}
+	CHECK(queue.drain(commands) == 10);
+
+	for (unsigned int i = 0; i < 20; ++i)
+	{
+		CHECK(!commands.isEmpty());
+		CHECK(commands.pop().category == i);
+	}
+	CHECK(commands.isEmpty());
+}
+
+// Several producers push through a small queue while the consumer pops. Every command must
+// arrive exactly once, and each producer's commands in the order it pushed them.
+TEST(ConcurrentCommandQueueStress)
+{
+	const unsigned int producerCount = 4;
+	const unsigned int commandsPerProducer = 200000;
+
+	// Small enough that producers keep finding it full
+	ConcurrentCommandQueue queue(64);
+	std::atomic<unsigned int> fullPushes(0);
+	std::atomic<bool> start(false);
+
+	std::vector<std::thread> producers;
+	for (unsigned int producer = 0; producer < producerCount; ++producer)
+	{
+		producers.emplace_back([&queue, &fullPushes, &start, producer, commandsPerProducer]()
+		{
+			while (!start.load())
+				std::this_thread::yield();
+
+			for (unsigned int sequence = 0; sequence < commandsPerProducer; ++sequence)
+			{
+				Command command = makeCommand((producer << SequenceBits) | sequence);
+				while (!queue.tryPush(std::move(command)))
+				{
+					fullPushes++;
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::vector<unsigned int> nextSequence(producerCount, 0);
+	unsigned int received = 0;
+	unsigned int outOfOrder = 0;
+	unsigned int emptyActions = 0;
+
+	start.store(true);
+	Command command;
+	while (received < producerCount * commandsPerProducer)
+	{
+		if (!queue.tryPop(command))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		const unsigned int producer = command.category >> SequenceBits;
+		const unsigned int sequence = command.category & ((1u << SequenceBits) - 1);
+		if (producer >= producerCount || sequence != nextSequence[producer])
+			outOfOrder++;
+		else
+			nextSequence[producer]++;
+
+		if (!command.action)
+			emptyActions++;
+		received++;
+	}
+
+	for (std::thread& producer : producers)
+		producer.join();
+
+	CHECK(outOfOrder == 0);
+	CHECK(emptyActions == 0);
+	for (unsigned int producer = 0; producer < producerCount; ++producer)
+		CHECK(nextSequence[producer] == commandsPerProducer);
+	CHECK(!queue.tryPop(command));
+	CHECK(fullPushes.load() > 0);
+}
@@ -0,0 +1,179 @@
+//***************************************************************************************
+// FrameConstantsTests.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+#include "../Project1/FrameConstants.hpp"
+#include "../Project1/RecordingRenderDevice.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Allocation sets the item's index, and a replaced buffer only re-uploads published items
+TEST(FrameConstantsPublish)
+{
+	FrameConstants constants;
+	constants.setFrameCount(2);
+
+	RenderItem items[3];
+	CHECK(constants.allocateObject(&items[0]) == 0);
+	constants.allocateObjects(&items[1], 2);
+	CHECK(items[0].ObjCBIndex == 0);
+	CHECK(items[1].ObjCBIndex == 1);
+	CHECK(items[2].ObjCBIndex == 2);
+	CHECK(constants.getObjectSlotCount() == 3);
+
+	RecordingRenderDevice device;
+	constants.markAllObjectsDirty(0);
+	constants.upload(0, device);
+	CHECK(device.getCallCount(RenderCommand::UploadObject) == 0);
+
+	constants.publishObjects(&items[1], 2);
+	constants.markAllObjectsDirty(0);
+	constants.upload(0, device);
+	CHECK(device.getCallCount(RenderCommand::UploadObject) == 1);
+	CHECK(device.getCommands().back().args[0] == 1);
+	CHECK(device.getCommands().back().args[1] == 2);
+	CHECK(constants.getUploadStats().Uploaded == 2);
+	CHECK(constants.getUploadStats().Skipped == 0);
+
+	// An unpublished item can be released like a published one, and its slot is reused
+	std::vector<std::unique_ptr<RenderItem>> owned;
+	owned.push_back(std::unique_ptr<RenderItem>(new RenderItem()));
+	constants.allocateObject(owned.back().get());
+	CHECK(owned.back()->ObjCBIndex == 3);
+	constants.releaseObjects(owned);
+	RenderItem reused;
+	CHECK(constants.allocateObject(&reused) == 3);
+}
+
+// A state building on another thread allocates while the main thread grows and re-uploads the
+// object buffer; the main thread never reads an item before it is published
+TEST(FrameConstantsBackgroundAllocation)
+{
+	const size_t ItemCount = 20000;
+
+	FrameConstants constants;
+	constants.setFrameCount(3);
+	std::unique_ptr<RenderItem[]> items(new RenderItem[ItemCount]);
+	std::atomic<bool> built(false);
+
+	std::thread builder([&]()
+	{
+		for (size_t i = 0; i < ItemCount; ++i)
+		{
+			constants.allocateObject(&items[i]);
+			items[i].World._41 = (float)i;
+		}
+		built = true;
+	});
+
+	RecordingRenderDevice device(false);
+	unsigned int frame = 0;
+	while (!built)
+	{
+		constants.markAllObjectsDirty(frame % 3);
+		constants.upload(frame % 3, device);
+		++frame;
+	}
+	builder.join();
+	CHECK(device.getCallCount(RenderCommand::UploadObject) == 0);
+
+	// Published on the main thread, as StateStack does when it puts the state on the stack
+	constants.publishObjects(items.get(), ItemCount);
+	CHECK(constants.getObjectSlotCount() == ItemCount);
+
+	RecordingRenderDevice recorded;
+	constants.markAllObjectsDirty(0);
+	constants.upload(0, recorded);
+	CHECK(constants.getUploadStats().Uploaded == ItemCount);
+	CHECK(recorded.getCallCount(RenderCommand::UploadObject) == 1);
+
+	bool indexed = true;
+	for (size_t i = 0; i < ItemCount; ++i)
+		indexed = indexed && items[i].ObjCBIndex == i;
+	CHECK(indexed);
+}
+
+// Leaving the game for the menu and starting it again, many times, reuses the slots of the released
+// projectile run instead of growing the object buffer, and the reused run still uploads as one copy
+TEST(FrameConstantsReuseReleasedRun)
+{
+	const size_t RunSize = 5000;
+
+	FrameConstants constants;
+	constants.setFrameCount(2);
+
+	RenderItem menu[4];
+	for (RenderItem& item : menu)
+		constants.allocateObject(&item);
+
+	for (int cycle = 0; cycle < 8; ++cycle)
+	{
+		// A game state: a few scene nodes, then the projectile pool's run
+		std::vector<std::unique_ptr<RenderItem>> nodes;
+		for (int i = 0; i < 3; ++i)
+		{
+			nodes.push_back(std::unique_ptr<RenderItem>(new RenderItem()));
+			constants.allocateObject(nodes.back().get());
+		}
+
+		std::unique_ptr<RenderItem[]> projectiles(new RenderItem[RunSize]);
+		constants.allocateObjects(projectiles.get(), RunSize);
+		constants.publishObjects(projectiles.get(), RunSize);
+
+		bool consecutive = true;
+		for (size_t i = 1; i < RunSize; ++i)
+			consecutive = consecutive && projectiles[i].ObjCBIndex == projectiles[0].ObjCBIndex + i;
+		CHECK(consecutive);
+		CHECK(constants.getObjectSlotCount() <= 4 + 3 + RunSize);
+
+		RecordingRenderDevice device;
+		constants.markAllObjectsDirty(0);
+		constants.upload(0, device);
+		CHECK(device.getCallCount(RenderCommand::UploadObject) == 1);
+
+		constants.releaseObjects(projectiles.get(), RunSize);
+		constants.releaseObjects(nodes);
+	}
+
+	// A run longer than any free one extends the free run at the end of the buffer
+	std::unique_ptr<RenderItem[]> larger(new RenderItem[2 * RunSize]);
+	constants.allocateObjects(larger.get(), 2 * RunSize);
+	CHECK(constants.getObjectSlotCount() <= 4 + 2 * RunSize + 3);
+	CHECK(larger[2 * RunSize - 1].ObjCBIndex == larger[0].ObjCBIndex + 2 * RunSize - 1);
+}
+
+// Object buffers are sized by the published slots only, so a state building in the background
+// does not grow them before it is on the stack
+TEST(FrameConstantsPublishedSlotEnd)
+{
+	const size_t RunSize = 1000;
+
+	FrameConstants constants;
+	constants.setFrameCount(2);
+
+	RenderItem live[2];
+	constants.allocateObjects(live, 2);
+	constants.publishObjects(live, 2);
+	CHECK(constants.getPublishedSlotEnd() == 2);
+
+	std::unique_ptr<RenderItem[]> preloaded(new RenderItem[RunSize]);
+	constants.allocateObjects(preloaded.get(), RunSize);
+	CHECK(constants.getObjectSlotCount() == 2 + RunSize);
+	CHECK(constants.getPublishedSlotEnd() == 2);
+
+	// A dropped preload never counts
+	constants.releaseObjects(preloaded.get(), RunSize);
+	CHECK(constants.getPublishedSlotEnd() == 2);
+
+	constants.allocateObjects(preloaded.get(), RunSize);
+	constants.publishObjects(preloaded.get(), RunSize);
+	CHECK(constants.getPublishedSlotEnd() == 2 + RunSize);
+
+	// Releasing the highest published run shrinks the end back to the highest slot still published
+	constants.releaseObjects(preloaded.get(), RunSize);
+	CHECK(constants.getPublishedSlotEnd() == 2);
+}
@@ -0,0 +1,231 @@
+//***************************************************************************************
+// FrameSyncTests.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+#include "../Project1/FrameSync.hpp"
+#include "../Project1/CpuFrameFence.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+// Frames in flight the pacing tests run with: none ahead, the game's default, and a deep ring
+static const unsigned int FrameCounts[] = { 1, 3, 6 };
+
+// Returns a CPU fence for a frame sync to own
+static std::unique_ptr<FrameFence> makeFence(bool immediate)
+{
+	return std::unique_ptr<FrameFence>(new CpuFrameFence(immediate));
+}
+
+// Returns the CPU fence a frame sync made with makeFence() paces on
+static CpuFrameFence& getFence(FrameSync& sync)
+{
+	return static_cast<CpuFrameFence&>(sync.getFence());
+}
+
+// Plays the GPU: completes one signalled frame about every millisecond until stopped
+class GpuThread
+{
+public:
+	explicit GpuThread(CpuFrameFence& fence)
+		: mStop(false)
+		, mThread([this, &fence]()
+		{
+			while (!mStop)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				fence.retire(1);
+			}
+		})
+	{
+	}
+
+	~GpuThread()
+	{
+		mStop = true;
+		mThread.join();
+	}
+
+private:
+	std::atomic<bool> mStop;
+	std::thread mThread;
+};
+
+// Signalled values complete in order and only when retired; retire() stops at the last one signalled
+TEST(CpuFrameFenceRetire)
+{
+	CpuFrameFence fence;
+	fence.signal(1);
+	fence.signal(2);
+	fence.signal(3);
+	CHECK(fence.getCompletedValue() == 0);
+	CHECK(fence.getPendingCount() == 3);
+
+	CHECK(fence.retire(2) == 2);
+	CHECK(fence.getCompletedValue() == 2);
+	CHECK(fence.retire(5) == 1);
+	CHECK(fence.getCompletedValue() == 3);
+	CHECK(fence.retire() == 0);
+	CHECK(fence.getPendingCount() == 0);
+
+	// Completed values return at once
+	fence.wait(3, 0);
+
+	CpuFrameFence immediate(true);
+	immediate.signal(4);
+	CHECK(immediate.getCompletedValue() == 4);
+	CHECK(immediate.getPendingCount() == 0);
+	immediate.wait(4, 0);
+}
+
+// A wait on another thread returns once retire() reaches its value, not before
+TEST(CpuFrameFenceWaitWakesOnRetire)
+{
+	CpuFrameFence fence;
+	fence.signal(1);
+	fence.signal(2);
+
+	std::atomic<bool> done(false);
+	std::thread waiter([&fence, &done]()
+	{
+		fence.wait(2, 0);
+		done = true;
+	});
+
+	fence.retire(1);
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	CHECK(!done);
+
+	fence.retire(1);
+	waiter.join();
+	CHECK(done);
+}
+
+// Without a GPU falling behind, the slots go round in order, each holds the fence of its last
+// frame, and the first lap never waits
+TEST(FrameSyncSlots)
+{
+	for (unsigned int framesInFlight : FrameCounts)
+	{
+		FrameSync sync(makeFence(false), framesInFlight);
+		CpuFrameFence& fence = getFence(sync);
+		CHECK(sync.getFramesInFlight() == framesInFlight);
+
+		for (unsigned int frame = 0; frame < framesInFlight; ++frame)
+		{
+			CHECK(sync.beginFrame() == frame);
+			CHECK(sync.getSlotFence(frame) == 0);
+			CHECK(sync.endFrame() == frame + 1);
+			CHECK(sync.getSlotFence(frame) == frame + 1);
+		}
+		CHECK(fence.getPendingCount() == framesInFlight);
+
+		const FrameSync::WaitStats& stats = sync.getWaitStats();
+		CHECK(stats.Frames == framesInFlight);
+		CHECK(stats.StalledFrames == 0);
+		CHECK(stats.TotalMs == 0.0);
+
+		// The GPU catches up before the second lap, which then does not wait either
+		fence.retire(framesInFlight);
+		CHECK(sync.beginFrame() == 0);
+		CHECK(sync.getWaitStats().StalledFrames == 0);
+	}
+
+	// At least one frame is always in flight
+	FrameSync sync(makeFence(true), 0);
+	CHECK(sync.getFramesInFlight() == 1);
+}
+
+// Against a slow GPU the CPU never gets more than framesInFlight frames ahead, and the frames
+// that had to wait for their slot show up in the wait stats
+TEST(FrameSyncWaitsForSlowGpu)
+{
+	const unsigned int frames = 40;
+	for (unsigned int framesInFlight : FrameCounts)
+	{
+		FrameSync sync(makeFence(false), framesInFlight);
+		CpuFrameFence& fence = getFence(sync);
+		GpuThread gpu(fence);
+
+		for (unsigned int frame = 1; frame <= frames; ++frame)
+		{
+			const unsigned int slot = sync.beginFrame();
+			CHECK(slot == (frame - 1) % framesInFlight);
+
+			// The frame that used this slot last has finished
+			CHECK(sync.getCompletedValue() >= sync.getSlotFence(slot));
+			CHECK(sync.getCompletedValue() + framesInFlight >= frame);
+			CHECK(fence.getPendingCount() < framesInFlight);
+			sync.endFrame();
+		}
+
+		const FrameSync::WaitStats& stats = sync.getWaitStats();
+		CHECK(stats.Frames == frames);
+		CHECK(stats.StalledFrames > 0);
+		CHECK(stats.StalledFrames <= frames - framesInFlight);
+		CHECK(stats.MaxMs > 0.0f);
+		CHECK(stats.TotalMs >= stats.MaxMs);
+		CHECK(stats.LastMs <= stats.MaxMs);
+
+		sync.resetWaitStats();
+		CHECK(sync.getWaitStats().Frames == 0);
+		CHECK(sync.getWaitStats().StalledFrames == 0);
+		CHECK(sync.getWaitStats().MaxMs == 0.0f);
+
+		sync.flush();
+	}
+}
+
+// A GPU that keeps up with an immediate fence never makes a frame wait
+TEST(FrameSyncImmediateFenceNeverStalls)
+{
+	for (unsigned int framesInFlight : FrameCounts)
+	{
+		FrameSync sync(makeFence(true), framesInFlight);
+		for (int frame = 0; frame < 20; ++frame)
+		{
+			sync.beginFrame();
+			sync.endFrame();
+		}
+
+		const FrameSync::WaitStats& stats = sync.getWaitStats();
+		CHECK(stats.Frames == 20);
+		CHECK(stats.StalledFrames == 0);
+		CHECK(stats.MaxMs == 0.0f);
+		CHECK(stats.TotalMs == 0.0);
+	}
+}
+
+// flush() returns at once with nothing submitted, and otherwise only once every submitted frame
+// has completed; it does not count as a frame in the wait stats
+TEST(FrameSyncFlush)
+{
+	for (unsigned int framesInFlight : FrameCounts)
+	{
+		FrameSync sync(makeFence(false), framesInFlight);
+		CpuFrameFence& fence = getFence(sync);
+		sync.flush();
+
+		for (unsigned int frame = 0; frame < framesInFlight; ++frame)
+		{
+			sync.beginFrame();
+			sync.endFrame();
+		}
+		CHECK(sync.getCompletedValue() == 0);
+
+		{
+			GpuThread gpu(fence);
+			sync.flush();
+			CHECK(sync.getCompletedValue() == framesInFlight);
+			CHECK(fence.getPendingCount() == 0);
+		}
+		CHECK(sync.getWaitStats().Frames == framesInFlight);
+
+		// Everything has completed, so the next lap starts without waiting
+		sync.beginFrame();
+		CHECK(sync.getWaitStats().StalledFrames == 0);
+	}
+}
@@ -0,0 +1,203 @@
+//***************************************************************************************
+// HeadlessFrameTests.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+#include "../Project1/HeadlessFrame.hpp"
+#include "../Project1/RecordingRenderDevice.hpp"
+#include "../Project1/TransformStore.hpp"
+
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+// Frame resources the scene cycles through, as many as Game uses by default
+static const unsigned int FramesInFlight = 3;
+
+// The batcher and the recorder only compare geometry addresses, so any unique address stands in for a mesh
+static char GeometryTag;
+
+// Two materials, three items in front of the camera and one far off to the side, drawn
+// for four frames; the nearest item moves once, in the second frame
+static void recordScene(RecordingRenderDevice& device)
+{
+	HeadlessFrame frame(device, FramesInFlight);
+	FrameConstants& constants = frame.getFrameConstants();
+
+	Material materials[2];
+	for (int i = 0; i < 2; ++i)
+	{
+		materials[i].MatCBIndex = i;
+		materials[i].DiffuseSrvHeapIndex = i;
+		constants.addMaterial(&materials[i]);
+	}
+
+	const float positions[4][3] = { { 0.0f, 0.0f, 10.0f }, { 0.0f, 0.0f, 20.0f }, { 0.0f, 0.0f, 30.0f }, { 1000.0f, 0.0f, 10.0f } };
+	const int itemMaterials[4] = { 0, 0, 1, 0 };
+
+	TransformStore transforms;
+	RenderItem items[4];
+	TransformStore::Handle handles[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		items[i].Mat = &materials[itemMaterials[i]];
+		items[i].Geo = reinterpret_cast<MeshGeometry*>(&GeometryTag);
+		items[i].IndexCount = 36;
+		items[i].Bounds = BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+		constants.allocateObject(&items[i]);
+		constants.publishObjects(&items[i], 1);
+
+		handles[i] = transforms.create();
+		transforms.setPosition(handles[i], positions[i][0], positions[i][1], positions[i][2]);
+		transforms.setRenderItem(handles[i], &items[i], nullptr);
+	}
+
+	XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * MathHelper::Pi, 1.0f, 1.0f, 1000.0f);
+	frame.setCamera(view, proj, XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), 1000.0f);
+
+	for (int f = 0; f < 4; ++f)
+	{
+		frame.run(
+			[&](std::vector<RenderItem*>& changed)
+			{
+				if (f == 1)
+					transforms.move(handles[0], 0.0f, 1.0f, 0.0f);
+				transforms.update();
+				transforms.interpolate(1.0f, changed);
+			},
+			[&](RenderBatcher& batcher)
+			{
+				for (RenderItem& item : items)
+					batcher.submit(&item);
+			});
+
+		CHECK(frame.getFrameIndex() == f % FramesInFlight);
+		CHECK(frame.getCullStats().Visible == 3);
+		CHECK(frame.getCullStats().Culled == 1);
+	}
+}
+
+// Returns the commands of one frame; a frame opens with its constant uploads, so each run of uploads after a draw starts the next
+static std::vector<RenderCommand> getFrame(const RecordingRenderDevice& device, int frame)
+{
+	std::vector<RenderCommand> commands;
+	int current = -1;
+	bool inDraws = true;
+	for (const RenderCommand& command : device.getCommands())
+	{
+		const bool isUpload = command.type == RenderCommand::UploadObject || command.type == RenderCommand::UploadMaterial
+			|| command.type == RenderCommand::UploadPass;
+		if (isUpload && inDraws)
+			++current;
+		inDraws = !isUpload;
+		if (current == frame)
+			commands.push_back(command);
+	}
+	return commands;
+}
+
+// The first frame uploads every object and material, binds the geometry once and draws the two
+// visible batches; the off-screen item never reaches the draws
+TEST(HeadlessFrameFirstFrame)
+{
+	RecordingRenderDevice device;
+	recordScene(device);
+
+	const RenderCommand::Type expected[] =
+	{
+		RenderCommand::UploadObject,
+		RenderCommand::UploadMaterial,
+		RenderCommand::UploadMaterial,
+		RenderCommand::UploadPass,
+		RenderCommand::BeginPass,
+		RenderCommand::UploadInstances,
+		RenderCommand::SetGeometry,
+		RenderCommand::SetMaterial,
+		RenderCommand::SetInstanceBase,
+		RenderCommand::Draw,
+		RenderCommand::SetMaterial,
+		RenderCommand::SetInstanceBase,
+		RenderCommand::Draw,
+	};
+	const std::vector<RenderCommand> commands = getFrame(device, 0);
+	CHECK(commands.size() == sizeof(expected) / sizeof(expected[0]));
+	for (size_t i = 0; i < commands.size() && i < sizeof(expected) / sizeof(expected[0]); ++i)
+		CHECK(commands[i].type == expected[i]);
+
+	// All four objects go up as one run of consecutive slots
+	CHECK(commands[0].args[0] == 0);
+	CHECK(commands[0].args[1] == 4);
+
+	// Nearest first within the first material; the culled item's slot 3 is not instanced
+	const RenderCommand& instances = commands[5];
+	CHECK(instances.args[0] == 3);
+	const unsigned int* objects = reinterpret_cast<const unsigned int*>(&device.getUploadData()[instances.dataOffset]);
+	CHECK(objects[0] == 0 && objects[1] == 1 && objects[2] == 2);
+
+	CHECK(commands[9].args[0] == 36);
+	CHECK(commands[9].args[1] == 2);
+	CHECK(commands[12].args[1] == 1);
+}
+
+// Each frame resource gets the objects once; after that only the moved item is uploaded, and
+// materials stop once every frame resource has them
+TEST(HeadlessFrameUploadsPerFrameResource)
+{
+	RecordingRenderDevice device;
+	recordScene(device);
+
+	for (int f = 0; f < 4; ++f)
+	{
+		size_t objects = 0;
+		size_t materials = 0;
+		for (const RenderCommand& command : getFrame(device, f))
+		{
+			if (command.type == RenderCommand::UploadObject)
+				objects += command.args[1];
+			else if (command.type == RenderCommand::UploadMaterial)
+				++materials;
+		}
+		CHECK(objects == (f < 3 ? 4u : 1u));
+		CHECK(materials == (f < 3 ? 2u : 0u));
+	}
+
+	// The fourth frame reuses the first frame resource, which only misses the move of item 0
+	const std::vector<RenderCommand> last = getFrame(device, 3);
+	CHECK(last[0].type == RenderCommand::UploadObject);
+	CHECK(last[0].args[0] == 0);
+	CHECK(last[0].dataSize == sizeof(ObjectConstants));
+
+	ObjectConstants uploaded;
+	std::memcpy(&uploaded, &device.getUploadData()[last[0].dataOffset], sizeof(uploaded));
+
+	XMFLOAT4X4 expected;
+	XMStoreFloat4x4(&expected, XMMatrixTranspose(XMMatrixTranslation(0.0f, 1.0f, 10.0f)));
+	for (int r = 0; r < 4; ++r)
+	{
+		for (int c = 0; c < 4; ++c)
+			CHECK(uploaded.World.m[r][c] == expected.m[r][c]);
+	}
+}
+
+// Two runs of the same scene record the same stream, byte for byte
+TEST(HeadlessFrameDeterministic)
+{
+	RecordingRenderDevice first;
+	RecordingRenderDevice second;
+	recordScene(first);
+	recordScene(second);
+
+	const std::vector<RenderCommand>& a = first.getCommands();
+	const std::vector<RenderCommand>& b = second.getCommands();
+	CHECK(a.size() == b.size());
+	for (size_t i = 0; i < a.size() && i < b.size(); ++i)
+	{
+		CHECK(a[i].type == b[i].type);
+		CHECK(std::memcmp(a[i].args, b[i].args, sizeof(a[i].args)) == 0);
+		CHECK(a[i].baseVertexLocation == b[i].baseVertexLocation);
+		CHECK(a[i].dataSize == b[i].dataSize);
+	}
+	CHECK(first.getUploadData() == second.getUploadData());
+}
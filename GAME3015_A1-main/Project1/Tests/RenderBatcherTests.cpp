@@ -0,0 +1,205 @@
+//***************************************************************************************
+// RenderBatcherTests.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+#include "../Project1/RenderBatcher.hpp"
+#include "../Project1/RecordingRenderDevice.hpp"
+#include "../Project1/TaskScheduler.hpp"
+#include "../../Common/Material.h"
+
+#include <memory>
+#include <vector>
+
+// Materials of the test scene, one batch each, about as many as the game draws
+static const int BatchCount = 6;
+
+// The batcher and the recorder only compare geometry addresses, so any unique address stands in for a mesh
+static char GeometryTag;
+
+// Draw calls of a recording with the material each one used, ignoring how often state was bound
+struct RecordedDraw
+{
+	unsigned int	material;
+	unsigned int	instanceBase;
+	unsigned int	instanceCount;
+
+	bool operator==(const RecordedDraw& other) const
+	{
+		return material == other.material && instanceBase == other.instanceBase && instanceCount == other.instanceCount;
+	}
+};
+
+// Appends the draws of a recording, in order
+static void collectDraws(const RecordingRenderDevice& device, std::vector<RecordedDraw>& draws)
+{
+	RecordedDraw draw = {};
+	for (const RenderCommand& command : device.getCommands())
+	{
+		if (command.type == RenderCommand::SetMaterial)
+			draw.material = command.args[0];
+		else if (command.type == RenderCommand::SetInstanceBase)
+			draw.instanceBase = command.args[0];
+		else if (command.type == RenderCommand::Draw)
+		{
+			draw.instanceCount = command.args[1];
+			draws.push_back(draw);
+		}
+	}
+}
+
+// A scene of a few batches splits into several chunks, and recording them in parallel
+// draws exactly what the sequential recording draws
+TEST(RenderBatcherChunksMatchSequential)
+{
+	Material materials[BatchCount];
+	std::vector<std::unique_ptr<RenderItem>> items;
+	for (int m = 0; m < BatchCount; ++m)
+	{
+		materials[m].MatCBIndex = m;
+		for (int i = 0; i <= m; ++i)
+		{
+			items.push_back(std::unique_ptr<RenderItem>(new RenderItem()));
+			items.back()->Mat = &materials[m];
+			items.back()->Geo = reinterpret_cast<MeshGeometry*>(&GeometryTag);
+			items.back()->IndexCount = 36;
+			items.back()->ObjCBIndex = (UINT)items.size() - 1;
+		}
+	}
+
+	RenderBatcher batcher;
+	for (const auto& item : items)
+		batcher.submit(item.get());
+	batcher.build();
+	CHECK(batcher.getBatches().size() == BatchCount);
+
+	const std::vector<RenderChunk> chunks = batcher.partition(8, RenderBatcher::MinBatchesPerChunk);
+	CHECK(chunks.size() == BatchCount / RenderBatcher::MinBatchesPerChunk);
+
+	UINT next = 0;
+	for (const RenderChunk& chunk : chunks)
+	{
+		CHECK(chunk.firstBatch == next);
+		CHECK(chunk.batchCount >= RenderBatcher::MinBatchesPerChunk);
+		next += chunk.batchCount;
+	}
+	CHECK(next == BatchCount);
+
+	RecordingRenderDevice sequential;
+	batcher.execute(sequential);
+
+	TaskScheduler scheduler(2);
+	std::vector<std::unique_ptr<RecordingRenderDevice>> chunkDevices;
+	std::vector<RenderDevice*> devices;
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		chunkDevices.push_back(std::unique_ptr<RecordingRenderDevice>(new RecordingRenderDevice()));
+		devices.push_back(chunkDevices.back().get());
+	}
+	RenderStateStats stats = batcher.executeChunks(chunks, devices, scheduler);
+
+	// Each list binds its own geometry once, the materials change with every batch either way
+	CHECK(stats.GeometryBinds == chunks.size());
+	CHECK(stats.MaterialBinds == BatchCount);
+
+	std::vector<RecordedDraw> expected;
+	std::vector<RecordedDraw> recorded;
+	collectDraws(sequential, expected);
+	for (const auto& device : chunkDevices)
+		collectDraws(*device, recorded);
+	CHECK(expected.size() == BatchCount);
+	CHECK(recorded == expected);
+}
+
+// Too few batches for two chunks stay on one list
+TEST(RenderBatcherSmallSceneStaysWhole)
+{
+	Material material;
+	RenderItem item;
+	item.Mat = &material;
+	item.Geo = reinterpret_cast<MeshGeometry*>(&GeometryTag);
+
+	RenderBatcher batcher;
+	batcher.submit(&item);
+	batcher.build();
+
+	const std::vector<RenderChunk> chunks = batcher.partition(8, RenderBatcher::MinBatchesPerChunk);
+	CHECK(chunks.size() == 1);
+	CHECK(chunks[0].firstBatch == 0);
+	CHECK(chunks[0].batchCount == 1);
+}
+
+// A position stream is culled per position and drawn as one position draw reading the constants of its
+// item; an item with the same state is not merged into it
+TEST(RenderBatcherPositionStream)
+{
+	Material material;
+	RenderItem single;
+	single.Mat = &material;
+	single.Geo = reinterpret_cast<MeshGeometry*>(&GeometryTag);
+	single.IndexCount = 36;
+	single.ObjCBIndex = 0;
+	single.Bounds = DirectX::BoundingBox(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.5f, 0.5f, 0.5f));
+
+	RenderItem projectile = single;
+	projectile.ObjCBIndex = 1;
+	DirectX::XMStoreFloat4x4(&projectile.World, DirectX::XMMatrixScaling(0.5f, 0.5f, 0.5f));
+
+	// Three positions in front of the camera, one behind it and one far to the side
+	const DirectX::XMFLOAT3 positions[] =
+	{
+		DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f),
+		DirectX::XMFLOAT3(0.0f, 0.0f, -20.0f),
+		DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f),
+		DirectX::XMFLOAT3(500.0f, 0.0f, 0.0f),
+		DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f),
+	};
+
+	FrustumCuller culler;
+	culler.setViewProj(DirectX::XMMatrixLookAtLH(DirectX::XMVectorSet(0.0f, 0.0f, -10.0f, 1.0f),
+		DirectX::XMVectorZero(), DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) *
+		DirectX::XMMatrixPerspectiveFovLH(0.25f * DirectX::XM_PI, 1.0f, 1.0f, 1000.0f));
+
+	RenderBatcher batcher;
+	batcher.submit(&single);
+	batcher.submitInstances(&projectile, positions, 5);
+	const FrustumCuller::Stats stats = batcher.cull(culler);
+	batcher.build();
+	CHECK(stats.Visible == 4);
+	CHECK(stats.Culled == 2);
+
+	const std::vector<RenderBatch>& batches = batcher.getBatches();
+	CHECK(batches.size() == 2);
+	CHECK(batcher.getInstanceObjects().size() == 2);
+	if (batches.size() != 2)
+		return;
+
+	const RenderBatch& stream = batches[0].item == &projectile ? batches[0] : batches[1];
+	const RenderBatch& items = batches[0].item == &projectile ? batches[1] : batches[0];
+	CHECK(stream.item == &projectile);
+	CHECK(stream.instanceCount == 3);
+	CHECK(batcher.getInstanceObjects()[stream.instanceOffset] == 1);
+	CHECK(items.instanceCount == 1);
+	CHECK(items.positionOffset == RenderDevice::NoInstancePositions);
+
+	const std::vector<DirectX::XMFLOAT3>& kept = batcher.getInstancePositions();
+	CHECK(kept[stream.positionOffset].x == 0.0f && kept[stream.positionOffset].z == 0.0f);
+	CHECK(kept[stream.positionOffset + 1].x == 1.0f);
+	CHECK(kept[stream.positionOffset + 2].y == 1.0f);
+
+	RecordingRenderDevice device;
+	batcher.execute(device);
+	CHECK(device.getCallCount(RenderCommand::UploadPositions) == 1);
+	CHECK(device.getCallCount(RenderCommand::Draw) == 2);
+
+	bool drewStream = false;
+	unsigned int positionBase = RenderDevice::NoInstancePositions;
+	for (const RenderCommand& command : device.getCommands())
+	{
+		if (command.type == RenderCommand::SetInstanceBase)
+			positionBase = command.args[1];
+		else if (command.type == RenderCommand::Draw && positionBase != RenderDevice::NoInstancePositions)
+			drewStream = positionBase == stream.positionOffset && command.args[1] == 3;
+	}
+	CHECK(drewStream);
+}
@@ -0,0 +1,142 @@
+//***************************************************************************************
+// TaskSchedulerTests.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+#include "../Project1/TaskScheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+// Workers the tests start, enough to steal from each other on any machine
+static const unsigned int WorkerCount = 4;
+
+// Without workers every task runs on the thread that calls wait()
+TEST(TaskSchedulerNoWorkers)
+{
+	TaskScheduler scheduler(0);
+	CHECK(scheduler.getWorkerCount() == 0);
+
+	const std::thread::id caller = std::this_thread::get_id();
+	int count = 0;
+	bool onCaller = true;
+	for (int i = 0; i < 10; ++i)
+	{
+		scheduler.schedule([&]()
+		{
+			++count;
+			onCaller = onCaller && std::this_thread::get_id() == caller;
+		});
+	}
+	scheduler.wait();
+	CHECK(count == 10);
+	CHECK(onCaller);
+}
+
+// Tasks scheduling tasks from the workers, over many rounds of wait() from the main thread.
+// Every task runs exactly once and wait() only returns once all of them, nested ones included, have.
+TEST(TaskSchedulerNestedStress)
+{
+	const int rounds = 200;
+	const int parents = 32;
+	const int children = 32;
+
+	TaskScheduler scheduler(WorkerCount);
+	std::atomic<int> ran(0);
+	for (int round = 0; round < rounds; ++round)
+	{
+		ran = 0;
+		for (int parent = 0; parent < parents; ++parent)
+		{
+			scheduler.schedule([&scheduler, &ran, children]()
+			{
+				for (int child = 0; child < children; ++child)
+					scheduler.schedule([&ran]() { ran++; });
+				ran++;
+			});
+		}
+		scheduler.wait();
+		CHECK(ran == parents * (children + 1));
+	}
+}
+
+// Tasks one worker schedules land in its own deque, so the others only get them by stealing
+TEST(TaskSchedulerStealing)
+{
+	TaskScheduler scheduler(WorkerCount);
+	std::mutex mutex;
+	std::set<std::thread::id> threads;
+	std::atomic<int> ran(0);
+
+	scheduler.schedule([&]()
+	{
+		for (int i = 0; i < 200; ++i)
+		{
+			scheduler.schedule([&]()
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+				std::lock_guard<std::mutex> lock(mutex);
+				threads.insert(std::this_thread::get_id());
+				ran++;
+			});
+		}
+	});
+	scheduler.wait();
+
+	CHECK(ran == 200);
+	CHECK(threads.size() > 1);
+}
+
+// A throwing task still counts as done: wait() returns, rethrows the first exception once,
+// and every other task has run by then
+TEST(TaskSchedulerTaskThrows)
+{
+	TaskScheduler scheduler(WorkerCount);
+	for (int round = 0; round < 20; ++round)
+	{
+		std::atomic<int> ran(0);
+		for (int i = 0; i < 100; ++i)
+		{
+			scheduler.schedule([&ran, i]()
+			{
+				if (i % 25 == 7)
+					throw std::runtime_error("task failed");
+				ran++;
+			});
+		}
+
+		bool threw = false;
+		try
+		{
+			scheduler.wait();
+		}
+		catch (const std::runtime_error&)
+		{
+			threw = true;
+		}
+		CHECK(threw);
+		CHECK(ran == 96);
+
+		// The exception was handed over; the next wait() has nothing to report
+		threw = false;
+		try
+		{
+			scheduler.wait();
+		}
+		catch (...)
+		{
+			threw = true;
+		}
+		CHECK(!threw);
+	}
+
+	// Destroying a scheduler with a throwing task never waited for neither hangs nor throws
+	{
+		TaskScheduler unwaited(WorkerCount);
+		unwaited.schedule([]() { throw std::runtime_error("task failed"); });
+	}
+}
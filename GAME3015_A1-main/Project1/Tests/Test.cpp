@@ -0,0 +1,61 @@
+//***************************************************************************************
+// Test.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Registered tests; a function so it is constructed before the first registration uses it
+static std::vector<std::pair<std::string, TestFunction>>& getTests()
+{
+	static std::vector<std::pair<std::string, TestFunction>> tests;
+	return tests;
+}
+
+// Failed checks of the running test
+static int gFailures = 0;
+
+// Registers a test
+TestRegistration::TestRegistration(const char* name, TestFunction function)
+{
+	getTests().push_back(std::make_pair(std::string(name), function));
+}
+
+// Records a failed check of the running test
+void reportFailure(const char* expression, const char* file, int line)
+{
+	std::printf("    %s(%d): CHECK(%s) failed\n", file, line, expression);
+	gFailures++;
+}
+
+// Runs every registered test whose name contains filter, in name order; returns how many failed
+int runTests(const char* filter)
+{
+	std::vector<std::pair<std::string, TestFunction>> tests = getTests();
+	std::sort(tests.begin(), tests.end());
+
+	int run = 0;
+	int failed = 0;
+	for (const auto& test : tests)
+	{
+		if (filter != nullptr && std::strstr(test.first.c_str(), filter) == nullptr)
+			continue;
+
+		gFailures = 0;
+		test.second();
+		run++;
+
+		std::printf("[%s] %s\n", gFailures == 0 ? "  OK  " : " FAIL ", test.first.c_str());
+		if (gFailures != 0)
+			failed++;
+	}
+
+	std::printf("%d of %d tests passed\n", run - failed, run);
+	return failed;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+typedef void(*TestFunction)();
+
+// Adds a test to the list runTests() goes through; used by TEST
+struct TestRegistration
+{
+	TestRegistration(const char* name, TestFunction function);
+};
+
+// Records a failed check of the running test; used by CHECK
+void reportFailure(const char* expression, const char* file, int line);
+
+// Runs every registered test whose name contains filter, in name order; returns how many failed
+int runTests(const char* filter);
+
+// Defines a test function and registers it under its name
+#define TEST(name) \
+	static void name(); \
+	static TestRegistration name##Registration(#name, &name); \
+	static void name()
+
+// Fails the running test, without stopping it, if expression is false
+#define CHECK(expression) \
+	((expression) ? (void)0 : reportFailure(#expression, __FILE__, __LINE__))
@@ -0,0 +1,104 @@
+//***************************************************************************************
+// TransformStoreTests.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+#include "../Project1/TransformStore.hpp"
+#include "../Project1/RenderItem.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+// Moving a slot back after update(), as collision response does, amends the committed step
+// and keeps the step before it as the start of the interpolation
+TEST(TransformStoreAmendStep)
+{
+	TransformStore transforms;
+	RenderItem item;
+	const TransformStore::Handle handle = transforms.create();
+	transforms.setRenderItem(handle, &item, nullptr);
+	transforms.update();
+
+	transforms.move(handle, 10.0f, 0.0f, 0.0f);
+	transforms.update();
+	transforms.move(handle, -6.0f, 0.0f, 0.0f);
+	transforms.amendStep();
+
+	std::vector<RenderItem*> changed;
+	transforms.interpolate(0.5f, changed);
+	CHECK(changed.size() == 1);
+	CHECK(std::fabs(item.World._41 - 2.0f) < 0.001f);
+
+	changed.clear();
+	transforms.interpolate(1.0f, changed);
+	CHECK(std::fabs(item.World._41 - 4.0f) < 0.001f);
+	CHECK(transforms.getWorldTransform(handle)._41 == 4.0f);
+}
+
+// Returns true if every element of the kernel's transform is within the tolerance of the
+// Scaling * RotationX * RotationY * RotationZ * Translation chain built from the same values
+static bool matchesChain(TransformStore& transforms, TransformStore::Handle handle)
+{
+	const XMFLOAT3 position = transforms.getPosition(handle);
+	const XMFLOAT3 rotation = transforms.getRotation(handle);
+	const XMFLOAT3 scale = transforms.getScale(handle);
+
+	XMFLOAT4X4 reference;
+	XMStoreFloat4x4(&reference, XMMatrixScaling(scale.x, scale.y, scale.z) *
+		XMMatrixRotationX(rotation.x) *
+		XMMatrixRotationY(rotation.y) *
+		XMMatrixRotationZ(rotation.z) *
+		XMMatrixTranslation(position.x, position.y, position.z));
+
+	const XMFLOAT4X4& transform = transforms.getTransform(handle);
+	for (int r = 0; r < 4; ++r)
+		for (int c = 0; c < 4; ++c)
+			if (!(std::fabs(reference.m[r][c] - transform.m[r][c]) <= 1e-3f * (1.0f + std::fabs(reference.m[r][c]))))
+				return false;
+	return true;
+}
+
+// The four-slot kernel matches the DirectXMath chain over random transforms, including negative
+// scales and angles of several turns, a slot count that leaves a partial last block, and blocks
+// where only some of the slots changed
+TEST(TransformStoreKernelMatchesChain)
+{
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> rotation(-4.0f * XM_PI, 4.0f * XM_PI);
+	std::uniform_real_distribution<float> scale(-4.0f, 4.0f);
+
+	TransformStore transforms;
+	std::vector<TransformStore::Handle> handles;
+	for (int i = 0; i < 1001; ++i)
+	{
+		const TransformStore::Handle handle = transforms.create();
+		transforms.setPosition(handle, position(random), position(random), position(random));
+		transforms.setRotation(handle, rotation(random), rotation(random), rotation(random));
+		transforms.setScale(handle, scale(random), scale(random), scale(random));
+		handles.push_back(handle);
+	}
+	transforms.update();
+
+	bool matched = true;
+	for (TransformStore::Handle handle : handles)
+		matched = matched && matchesChain(transforms, handle);
+	CHECK(matched);
+
+	// Every third slot changes, so most blocks mix changed and unchanged slots
+	for (size_t i = 0; i < handles.size(); i += 3)
+		transforms.setRotation(handles[i], rotation(random), rotation(random), rotation(random));
+	transforms.update();
+
+	matched = true;
+	for (TransformStore::Handle handle : handles)
+		matched = matched && matchesChain(transforms, handle);
+	CHECK(matched);
+
+	// A single slot read before update() goes through the same kernel
+	transforms.setScale(handles[6], 0.5f, -2.0f, 1.0f);
+	CHECK(matchesChain(transforms, handles[6]));
+}
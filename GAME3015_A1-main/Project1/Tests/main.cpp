@@ -0,0 +1,12 @@
+//***************************************************************************************
+// main.cpp
+// by Zijie Wang and Wanhao Sun
+//***************************************************************************************
+#include "Test.hpp"
+
+// Runs the tests; the optional argument only runs those whose name contains it.
+// Exits with 1 if any test failed.
+int main(int argc, char** argv)
+{
+	return runTests(argc > 1 ? argv[1] : nullptr) == 0 ? 0 : 1;
+}